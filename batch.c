@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "batch.h"
+#include "input_utils.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "tetromino.h"
+#include "grid.h"
+
+// Read the next line of 'input' into '*line', a buffer '*capacity' bytes long allocated with malloc (or NULL), growing it until the whole line fits. Return TRUE if a line was read, FALSE at the end of 'input' or if the buffer couldn't be grown
+int readBatchLine(FILE *input, char **line, size_t *capacity)
+{
+    size_t length = 0;
+    char *grownLine;
+
+    if (*line == NULL)
+    {
+        *capacity = BATCH_LINE_CAPACITY;
+        *line = malloc(*capacity);
+        if (*line == NULL) return FALSE;
+    }
+
+    while (fgets(*line + length, (int) (*capacity - length), input) != NULL)
+    {
+        length += strlen(*line + length);
+
+        // The line ends at a newline, or at the end of the file before the buffer filled up
+        if ((length > 0 && (*line)[length - 1] == '\n') || length + 1 < *capacity) return TRUE;
+
+        grownLine = realloc(*line, *capacity * 2);
+        if (grownLine == NULL) return FALSE;
+
+        *line = grownLine;
+        *capacity *= 2;
+    }
+
+    return length > 0 ? TRUE : FALSE;
+}
+
+// Parse the line 'line' of a batch file, a sequence of at most 'maxSize' pieces followed by 'Y' or 'N' to allow rotations or not, into 'sequence', 'size' and 'allowRotation'. Return the kind of line it is, and a description of the error in 'error' if it is invalid
+int parseBatchLine(const char *line, char sequence[], int maxSize, int *size, int *allowRotation, char error[MAX_BATCH_ERROR_LENGTH])
+{
+    const char *separators = " \t,";
+    const char *whitespace = " \t\r\n";
+
+    line += strspn(line, whitespace);
+    if (*line == '\0' || *line == '#') return BATCH_LINE_BLANK;
+
+    *size = 0;
+
+    for (; *line != '\0' && strchr(separators, *line) == NULL && strchr(whitespace, *line) == NULL; line++)
+    {
+        if (getTetromino(*line, ROTATION_0) == FALSE)
+        {
+            snprintf(error, MAX_BATCH_ERROR_LENGTH, "'%c' is not a valid piece", *line);
+            return BATCH_LINE_INVALID;
+        }
+
+        if (*size == maxSize)
+        {
+            snprintf(error, MAX_BATCH_ERROR_LENGTH, "Sequence is longer than MAX_SEQUENCE_SIZE (%d), use --beam to solve it approximately", maxSize);
+            return BATCH_LINE_INVALID;
+        }
+
+        sequence[(*size)++] = *line;
+    }
+
+    if (*size == 0)
+    {
+        snprintf(error, MAX_BATCH_ERROR_LENGTH, "Sequence is empty");
+        return BATCH_LINE_INVALID;
+    }
+
+    line += strspn(line, separators);
+
+    switch (*line)
+    {
+        case 'Y':
+        case 'y':
+            *allowRotation = TRUE;
+            break;
+        case 'N':
+        case 'n':
+            *allowRotation = FALSE;
+            break;
+        default:
+            snprintf(error, MAX_BATCH_ERROR_LENGTH, "Sequence must be followed by 'Y' or 'N' to allow rotations or not");
+            return BATCH_LINE_INVALID;
+    }
+
+    line++;
+    line += strspn(line, whitespace);
+
+    if (*line != '\0' && *line != '#')
+    {
+        snprintf(error, MAX_BATCH_ERROR_LENGTH, "Unexpected text after the rotation flag");
+        return BATCH_LINE_INVALID;
+    }
+
+    return BATCH_LINE_SEQUENCE;
+}
+
+// Print the 'length' characters of 'text' to 'output' as a JSON string, escaping the characters JSON doesn't allow inside strings
+void printJsonString(FILE *output, const char *text, int length)
+{
+    fputc('"', output);
+
+    for (int character = 0; character < length; character++)
+    {
+        if (text[character] == '"' || text[character] == '\\') fprintf(output, "\\%c", text[character]);
+        else if ((unsigned char) text[character] < 0x20) fprintf(output, "\\u%04x", (unsigned char) text[character]);
+        else fputc(text[character], output);
+    }
+
+    fputc('"', output);
+}
+
+// Print the solution in 'result' for the sequence in 'sequenceParams', read from line 'lineNumber' of a batch file, to 'output' as one JSON line. Include the grid of the solution if 'printGrid' is TRUE
+void printBatchResult(FILE *output, int lineNumber, sequence_params *sequenceParams, solve_result *result, int printGrid)
+{
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    skyline gridSkyline = EMPTY_SKYLINE;
+    char permutations[MAX_PERMUTATION_COUNT_LENGTH];
+
+    fprintf(output, "{\"line\":%d,\"sequence\":", lineNumber);
+    printJsonString(output, sequenceParams->Sequence, sequenceParams->Size);
+    fprintf(output, ",\"rotation\":%s,\"height\":%d,\"columns\":[", sequenceParams->AllowRotation == TRUE ? "true" : "false", result->StackHeight);
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+        fprintf(output, piece == 0 ? "%d" : ",%d", result->PieceColumns[piece]);
+    fprintf(output, "],\"rotations\":[");
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+        fprintf(output, piece == 0 ? "%d" : ",%d", result->PieceRotations[piece] * 90);
+    fprintf(output, "],\"permutations\":%s,\"seconds\":%.6f", formatPermutationCount(result->Permutations, permutations), result->ElapsedTime);
+    if (result->Cached == TRUE) fprintf(output, ",\"cached\":true");
+    if (result->Optimal == FALSE) fprintf(output, ",\"optimal\":false,\"lowerBound\":%d", result->LowerBound);
+
+    // The grid is printed from the top of the stack down, one string per row
+    if (printGrid == TRUE)
+    {
+        memset(grid, '_', sizeof(grid));
+
+        for (int piece = 0; piece < sequenceParams->Size; piece++)
+            dropTetrominoToGrid(getTetromino(sequenceParams->Sequence[piece], result->PieceRotations[piece]), \
+                                result->PieceColumns[piece], grid, &gridSkyline);
+
+        fprintf(output, ",\"grid\":[");
+        for (int row = GRID_HEIGHT - getStackHeight(gridSkyline); row < GRID_HEIGHT; row++)
+        {
+            if (row > GRID_HEIGHT - getStackHeight(gridSkyline)) fputc(',', output);
+            printJsonString(output, grid[row], sequenceParams->GridWidth);
+        }
+        fputc(']', output);
+    }
+
+    fprintf(output, "}\n");
+}
+
+// Print the solution in 'result' found by a beam search keeping 'beamWidth' states for the 'size' pieces in 'sequence', read from line 'lineNumber' of a batch file and dropped into a grid 'gridWidth' columns wide with rotations if 'allowRotation' is TRUE, to 'output' as one JSON line
+void printBeamBatchResult(FILE *output, int lineNumber, const char *sequence, int size, int allowRotation, int gridWidth, int beamWidth, beam_result *result)
+{
+    // Every tetromino holds 4 cells, which at best fill the grid up level
+    int lowerBound = (4 * size + gridWidth - 1) / gridWidth;
+
+    fprintf(output, "{\"line\":%d,\"sequence\":", lineNumber);
+    printJsonString(output, sequence, size);
+    fprintf(output, ",\"rotation\":%s,\"height\":%d,\"columns\":[", allowRotation == TRUE ? "true" : "false", result->StackHeight);
+
+    for (int piece = 0; piece < size; piece++)
+        fprintf(output, piece == 0 ? "%d" : ",%d", result->PieceColumns[piece]);
+    fprintf(output, "],\"rotations\":[");
+
+    for (int piece = 0; piece < size; piece++)
+        fprintf(output, piece == 0 ? "%d" : ",%d", result->PieceRotations[piece] * 90);
+    fprintf(output, "],\"beamWidth\":%d,\"states\":%llu,\"seconds\":%.6f", beamWidth, (unsigned long long) result->States, result->ElapsedTime);
+
+    // A beam search proves nothing, unless its stack fills the grid up level
+    if (result->StackHeight > lowerBound) fprintf(output, ",\"optimal\":false,\"lowerBound\":%d", lowerBound);
+
+    fprintf(output, "}\n");
+}
+
+// Print 'error', the reason line 'lineNumber' of a batch file couldn't be solved, to 'output' as one JSON line
+void printBatchError(FILE *output, int lineNumber, const char *error)
+{
+    fprintf(output, "{\"line\":%d,\"error\":", lineNumber);
+    printJsonString(output, error, (int) strlen(error));
+    fprintf(output, "}\n");
+}
+
+// Solve each sequence in the batch file set in 'solverSettings' using the solvers set in it, its beam search if it sets a beam width, or the workers connecting to it if it sets a coordinator port, printing one JSON line per sequence to stdout as soon as it is solved, or once the whole file is solved as a trie of its prefixes if the settings ask for it. Return TRUE if the whole file was read, FALSE if it couldn't be read, or the solvers couldn't be allocated or the port listened on
+int runBatch(solver_settings *solverSettings)
+{
+    FILE *input = strcmp(solverSettings->BatchFile, "-") == 0 ? stdin : fopen(solverSettings->BatchFile, "r");
+    solve_context *solveContext = NULL; // Keeps the solver threads and transposition table between sequences
+    beam_search *beamSearch = NULL; // Keeps the beam and its threads between sequences, if sequences are solved by beam search
+    prefix_trie *prefixTrie = NULL; // Holds every sequence of the batch until the whole file is read, if sequences are solved as a trie of their prefixes
+    distributed_coordinator *coordinator = NULL; // Keeps the workers connected between sequences, if sequences are solved by worker processes
+    solve_request request = {0};
+    solve_result result;
+    beam_result beamResult;
+    sequence_params sequenceParams;
+
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    // Stores the sequence on the line and the placement of each of its pieces found by beam search, as long as the longest line read so far
+    char *sequence = NULL;
+    int *pieceColumns = NULL;
+    int *pieceRotations = NULL;
+    size_t sequenceCapacity = 0;
+    int size;
+    int allowRotation;
+
+    char error[MAX_BATCH_ERROR_LENGTH];
+    int lineNumber = 0;
+    int allocated = TRUE;
+    int readWholeFile;
+
+    // Errors which stop the batch go to stderr, so that stdout only holds results
+    if (input == NULL)
+    {
+        fprintf(stderr, "Could not open batch file '%s'!\n", solverSettings->BatchFile);
+        return FALSE;
+    }
+
+    if (solverSettings->CoordinatorPort != 0)
+    {
+        coordinator = startCoordinator(solverSettings);
+
+        if (coordinator == NULL)
+        {
+            fprintf(stderr, "Could not listen for workers on port %d!\n", solverSettings->CoordinatorPort);
+            if (input != stdin) fclose(input);
+            return FALSE;
+        }
+    }
+
+    else if (solverSettings->BeamWidth != 0)
+    {
+        beamSearch = malloc(sizeof(beam_search));
+
+        if (beamSearch == NULL || createBeamSearch(beamSearch, solverSettings->BeamWidth, solverSettings) == FALSE)
+        {
+            fprintf(stderr, "Could not allocate the beam search!\n");
+            free(beamSearch);
+            if (input != stdin) fclose(input);
+            return FALSE;
+        }
+    }
+
+    else
+    {
+        solveContext = createSolveContext(solverSettings);
+
+        if (solveContext == NULL)
+        {
+            fprintf(stderr, "Could not allocate the solvers and transposition table, or open the solution cache!\n");
+            if (input != stdin) fclose(input);
+            return FALSE;
+        }
+
+        if (solverSettings->BatchTrie == TRUE)
+        {
+            prefixTrie = malloc(sizeof(prefix_trie));
+
+            if (prefixTrie == NULL || createPrefixTrie(prefixTrie, solverSettings->GridWidth, solveContext) == FALSE)
+            {
+                fprintf(stderr, "Could not allocate the prefix trie!\n");
+                free(prefixTrie);
+                destroySolveContext(solveContext);
+                if (input != stdin) fclose(input);
+                return FALSE;
+            }
+        }
+    }
+
+    // Every sequence in the batch is searched within the same limits
+    request.TimeLimit = solverSettings->TimeLimit / 1000.0;
+    request.NodeBudget = solverSettings->NodeBudget;
+
+    while (readBatchLine(input, &line, &lineCapacity) == TRUE)
+    {
+        lineNumber++;
+
+        // A sequence is never longer than the line holding it
+        if (sequenceCapacity < lineCapacity)
+        {
+            free(sequence);
+            free(pieceColumns);
+            free(pieceRotations);
+
+            sequenceCapacity = lineCapacity;
+            sequence = malloc(sequenceCapacity);
+            pieceColumns = malloc(sizeof(int) * sequenceCapacity);
+            pieceRotations = malloc(sizeof(int) * sequenceCapacity);
+
+            if (sequence == NULL || pieceColumns == NULL || pieceRotations == NULL)
+            {
+                fprintf(stderr, "Could not allocate line %d of batch file '%s'!\n", lineNumber, solverSettings->BatchFile);
+                allocated = FALSE;
+                break;
+            }
+        }
+
+        switch (parseBatchLine(line, sequence, beamSearch != NULL ? (int) sequenceCapacity : MAX_SEQUENCE_SIZE, &size, &allowRotation, error))
+        {
+            case BATCH_LINE_BLANK:
+                continue;
+
+            case BATCH_LINE_INVALID:
+                printBatchError(stdout, lineNumber, error);
+                break;
+
+            default:
+                if (beamSearch != NULL)
+                {
+                    beamResult.PieceColumns = pieceColumns;
+                    beamResult.PieceRotations = pieceRotations;
+
+                    if (beamSearchSequence(beamSearch, sequence, size, allowRotation, solverSettings->GridWidth, &beamResult) == TRUE)
+                        printBeamBatchResult(stdout, lineNumber, sequence, size, allowRotation, solverSettings->GridWidth, solverSettings->BeamWidth, &beamResult);
+                    else
+                    {
+                        snprintf(error, sizeof(error), "Stack rose more than %d rows above its lowest column", MAX_SKYLINE_HEIGHT - MAX_TETROMINO_WIDTH);
+                        printBatchError(stdout, lineNumber, error);
+                    }
+
+                    break;
+                }
+
+                if (prefixTrie != NULL)
+                {
+                    if (addTrieSequence(prefixTrie, sequence, size, allowRotation, lineNumber) == TRUE) break;
+
+                    fprintf(stderr, "Could not allocate line %d of batch file '%s'!\n", lineNumber, solverSettings->BatchFile);
+                    allocated = FALSE;
+                    break;
+                }
+
+                memcpy(sequenceParams.Sequence, sequence, size);
+                sequenceParams.Size = size;
+                sequenceParams.AllowRotation = allowRotation;
+
+                request.Sequence = sequenceParams.Sequence;
+                request.Size = sequenceParams.Size;
+                request.AllowRotation = sequenceParams.AllowRotation;
+                request.GridWidth = sequenceParams.GridWidth = solverSettings->GridWidth;
+
+                if (coordinator != NULL) solveCoordinatedSequence(coordinator, &sequenceParams, &request, &result);
+                else solveSequenceRequest(solveContext, &request, &result);
+
+                printBatchResult(stdout, lineNumber, &sequenceParams, &result, solverSettings->BatchGrids);
+                break;
+        }
+
+        if (allocated == FALSE) break;
+
+        // Results are streamed as each sequence is solved, rather than when the output buffer fills
+        fflush(stdout);
+    }
+
+    readWholeFile = allocated == TRUE && ferror(input) == 0 && feof(input) != 0 ? TRUE : FALSE;
+    if (readWholeFile == FALSE && allocated == TRUE) fprintf(stderr, "Could not read batch file '%s'!\n", solverSettings->BatchFile);
+
+    // A trie's sequences are only solved once every line is read, as any later line may share their prefixes
+    if (prefixTrie != NULL && readWholeFile == TRUE)
+    {
+        solvePrefixTrie(prefixTrie);
+        sequenceParams.GridWidth = solverSettings->GridWidth;
+
+        for (int trieSequence = 0; trieSequence < prefixTrie->SequenceCount; trieSequence++)
+        {
+            memcpy(sequenceParams.Sequence, prefixTrie->Sequences[trieSequence].Sequence, prefixTrie->Sequences[trieSequence].Size);
+            sequenceParams.Size = prefixTrie->Sequences[trieSequence].Size;
+            sequenceParams.AllowRotation = prefixTrie->Sequences[trieSequence].AllowRotation;
+
+            printBatchResult(stdout, prefixTrie->Sequences[trieSequence].LineNumber, &sequenceParams, &prefixTrie->Sequences[trieSequence].Result, solverSettings->BatchGrids);
+        }
+
+        fflush(stdout);
+    }
+
+    if (input != stdin) fclose(input);
+    free(line);
+    free(sequence);
+    free(pieceColumns);
+    free(pieceRotations);
+
+    if (coordinator != NULL) stopCoordinator(coordinator);
+
+    else if (beamSearch != NULL)
+    {
+        destroyBeamSearch(beamSearch);
+        free(beamSearch);
+    }
+
+    else
+    {
+        if (prefixTrie != NULL)
+        {
+            destroyPrefixTrie(prefixTrie);
+            free(prefixTrie);
+        }
+
+        destroySolveContext(solveContext);
+    }
+
+    return readWholeFile;
+}
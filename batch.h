@@ -0,0 +1,42 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+#include "input_utils.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "beam_search.h"
+#include "prefix_trie.h"
+#include "distributed.h"
+
+#define BATCH_LINE_CAPACITY (MAX_SEQUENCE_SIZE + 64) // Initial size of the buffer lines of a batch file are read into, leaving room for the rotation flag, whitespace and a comment. Doubled for longer lines
+#define MAX_BATCH_ERROR_LENGTH 128
+
+// Kinds of line in a batch file
+#define BATCH_LINE_SEQUENCE 0
+#define BATCH_LINE_BLANK 1 // Empty, whitespace only, or a comment starting with '#'
+#define BATCH_LINE_INVALID 2
+
+// Read the next line of 'input' into '*line', a buffer '*capacity' bytes long allocated with malloc (or NULL), growing it until the whole line fits. Return TRUE if a line was read, FALSE at the end of 'input' or if the buffer couldn't be grown
+int readBatchLine(FILE *input, char **line, size_t *capacity);
+
+// Parse the line 'line' of a batch file, a sequence of at most 'maxSize' pieces followed by 'Y' or 'N' to allow rotations or not, into 'sequence', 'size' and 'allowRotation'. Return the kind of line it is, and a description of the error in 'error' if it is invalid
+int parseBatchLine(const char *line, char sequence[], int maxSize, int *size, int *allowRotation, char error[MAX_BATCH_ERROR_LENGTH]);
+
+// Print the 'length' characters of 'text' to 'output' as a JSON string, escaping the characters JSON doesn't allow inside strings
+void printJsonString(FILE *output, const char *text, int length);
+
+// Print the solution in 'result' for the sequence in 'sequenceParams', read from line 'lineNumber' of a batch file, to 'output' as one JSON line. Include the grid of the solution if 'printGrid' is TRUE
+void printBatchResult(FILE *output, int lineNumber, sequence_params *sequenceParams, solve_result *result, int printGrid);
+
+// Print the solution in 'result' found by a beam search keeping 'beamWidth' states for the 'size' pieces in 'sequence', read from line 'lineNumber' of a batch file and dropped into a grid 'gridWidth' columns wide with rotations if 'allowRotation' is TRUE, to 'output' as one JSON line
+void printBeamBatchResult(FILE *output, int lineNumber, const char *sequence, int size, int allowRotation, int gridWidth, int beamWidth, beam_result *result);
+
+// Print 'error', the reason line 'lineNumber' of a batch file couldn't be solved, to 'output' as one JSON line
+void printBatchError(FILE *output, int lineNumber, const char *error);
+
+// Solve each sequence in the batch file set in 'solverSettings' using the solvers set in it, its beam search if it sets a beam width, or the workers connecting to it if it sets a coordinator port, printing one JSON line per sequence to stdout as soon as it is solved, or once the whole file is solved as a trie of its prefixes if the settings ask for it. Return TRUE if the whole file was read, FALSE if it couldn't be read, or the solvers couldn't be allocated or the port listened on
+int runBatch(solver_settings *solverSettings);
+
+#endif
@@ -0,0 +1,498 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "beam_search.h"
+#include "input_utils.h"
+#include "placement.h"
+#include "skyline.h"
+#include "thread_utils.h"
+
+#ifdef _WIN32 // Windows implementation (multi-threaded)
+
+#include <windows.h>
+
+// Runs the beam thread in its own thread of execution, using the parameters inside 'threadParams' (must point to a beam_thread_params)
+DWORD WINAPI runBeamThread(LPVOID threadParams)
+{
+    runBeamSlice((beam_thread_params *) threadParams);
+    return 0;
+}
+
+// Create a beam thread expanding the slice of the beam in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createBeamThread(beam_thread *thread, beam_thread_params *threadParams)
+{
+    *thread = CreateThread(NULL, 0, runBeamThread, threadParams, 0, NULL);
+    return *thread != NULL ? TRUE : FALSE;
+}
+
+// Block until the beam thread 'thread' has exited, then free its handle
+void joinBeamThread(beam_thread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+
+#elif defined __linux__ // Linux implementation (multi-threaded)
+
+#include <pthread.h>
+
+// Runs the beam thread in its own thread of execution, using the parameters inside 'threadParams' (must point to a beam_thread_params)
+void* runBeamThread(void *threadParams)
+{
+    runBeamSlice((beam_thread_params *) threadParams);
+    return 0;
+}
+
+// Create a beam thread expanding the slice of the beam in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createBeamThread(beam_thread *thread, beam_thread_params *threadParams)
+{
+    return pthread_create(thread, NULL, runBeamThread, threadParams) == 0 ? TRUE : FALSE;
+}
+
+// Block until the beam thread 'thread' has exited, then free its handle
+void joinBeamThread(beam_thread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+
+#else // Standard implementation (single-threaded)
+
+// Create a beam thread expanding the slice of the beam in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createBeamThread(beam_thread *thread, beam_thread_params *threadParams)
+{
+    // Without threads, every slice is expanded by the thread solving the sequence
+    (void) thread;
+    (void) threadParams;
+    return FALSE;
+}
+
+// Block until the beam thread 'thread' has exited, then free its handle
+void joinBeamThread(beam_thread thread)
+{
+    (void) thread;
+}
+
+#endif
+
+// Return the score of the grid state 'gridSkyline', lowered by 'baseHeight', in a grid 'gridWidth' columns wide. Lower scores are better: a low stack with few holes and a flat surface
+int64_t getBeamStateScore(skyline gridSkyline, int baseHeight, int gridWidth)
+{
+    int64_t stackHeight = baseHeight + getSkylineHeight(gridSkyline);
+    int64_t area = (int64_t) baseHeight * gridWidth + getSkylineArea(gridSkyline);
+    int64_t bumpiness = 0;
+    int heightDifference;
+
+    for (int column = 1; column < gridWidth; column++)
+    {
+        heightDifference = getColumnHeight(gridSkyline, column) - getColumnHeight(gridSkyline, column - 1);
+        bumpiness += heightDifference < 0 ? -heightDifference : heightDifference;
+    }
+
+    return BEAM_HEIGHT_WEIGHT * stackHeight + BEAM_AREA_WEIGHT * area + BEAM_BUMPINESS_WEIGHT * bumpiness;
+}
+
+// Expand the states in slice 'slice' of the 'slices' slices of the beam of 'beamSearch' into its candidates, by dropping the next piece onto them at each of its placements
+void expandBeamSlice(beam_search *beamSearch, int slice, int slices)
+{
+    placement_table *placementTable = &beamSearch->PlacementTable;
+    int piece = (int) (strchr(BEAM_PIECES, beamSearch->Sequence[beamSearch->Depth]) - BEAM_PIECES);
+    int firstState = (int) ((int64_t) beamSearch->StateCount * slice / slices);
+    int endState = (int) ((int64_t) beamSearch->StateCount * (slice + 1) / slices);
+    beam_state *state;
+    beam_state *candidate;
+    skyline droppedSkyline;
+    int loweredHeight;
+
+    for (int stateIndex = firstState; stateIndex < endState; stateIndex++)
+    {
+        state = &beamSearch->States[stateIndex];
+        candidate = &beamSearch->Candidates[(size_t) stateIndex * MAX_PIECE_PLACEMENTS];
+        beamSearch->CandidateCounts[stateIndex] = 0;
+
+        // A piece dropped onto the highest column of the skyline must not rise past the top of it
+        if (getSkylineHeight(state->Skyline) > MAX_SKYLINE_HEIGHT - MAX_TETROMINO_WIDTH) continue;
+
+        for (int placementIndex = placementTable->PieceFirstPlacements[piece]; placementIndex < placementTable->PieceFirstPlacements[piece + 1]; placementIndex++)
+        {
+            droppedSkyline = dropPlacement(&placementTable->Placements[placementIndex], state->Skyline);
+
+            candidate->Skyline = normaliseSkyline(droppedSkyline, beamSearch->GridWidth, &loweredHeight);
+            candidate->BaseHeight = state->BaseHeight + loweredHeight;
+            candidate->Parent = stateIndex;
+            candidate->Placement = placementIndex;
+            candidate->Score = getBeamStateScore(candidate->Skyline, candidate->BaseHeight, beamSearch->GridWidth);
+            candidate->Hash = getSkylineHash(candidate->Skyline, (uint64_t) candidate->BaseHeight);
+
+            candidate++;
+            beamSearch->CandidateCounts[stateIndex]++;
+        }
+    }
+}
+
+// Expand each state in the beam of 'beamSearch' into its candidates, with each slice of the beam expanded by its own thread. Return once every slice is expanded
+void expandBeam(beam_search *beamSearch)
+{
+    if (beamSearch->StateCount < beamSearch->NumberOfThreads * BEAM_MIN_SLICE_STATES)
+    {
+        expandBeamSlice(beamSearch, 0, 1);
+        return;
+    }
+
+    acquireLock(&beamSearch->Lock);
+
+    beamSearch->RunningThreads = 0;
+    for (int slice = 1; slice < beamSearch->NumberOfThreads; slice++) beamSearch->RunningThreads += beamSearch->ThreadCreated[slice];
+
+    beamSearch->Expansion++;
+    signalCondition(&beamSearch->ExpansionStarted);
+    releaseLock(&beamSearch->Lock);
+
+    for (int slice = 0; slice < beamSearch->NumberOfThreads; slice++)
+        if (slice == 0 || beamSearch->ThreadCreated[slice] == FALSE) expandBeamSlice(beamSearch, slice, beamSearch->NumberOfThreads);
+
+    acquireLock(&beamSearch->Lock);
+    while (beamSearch->RunningThreads > 0) waitCondition(&beamSearch->ExpansionFinished, &beamSearch->Lock);
+    releaseLock(&beamSearch->Lock);
+}
+
+// Expand the slice of the beam in 'threadParams' each time the beam is expanded, until the beam search is destroyed
+void runBeamSlice(beam_thread_params *threadParams)
+{
+    beam_search *beamSearch = threadParams->BeamSearch;
+    unsigned int lastExpansion = 0;
+
+    acquireLock(&beamSearch->Lock);
+
+    while (TRUE)
+    {
+        while (beamSearch->Expansion == lastExpansion && beamSearch->Stopping == FALSE) waitCondition(&beamSearch->ExpansionStarted, &beamSearch->Lock);
+        if (beamSearch->Stopping == TRUE) break;
+
+        lastExpansion = beamSearch->Expansion;
+        releaseLock(&beamSearch->Lock);
+
+        expandBeamSlice(beamSearch, threadParams->Slice, beamSearch->NumberOfThreads);
+
+        acquireLock(&beamSearch->Lock);
+        if (--beamSearch->RunningThreads == 0) signalCondition(&beamSearch->ExpansionFinished);
+    }
+
+    releaseLock(&beamSearch->Lock);
+}
+
+// Reorder the first 'count' indices in the selected candidates of 'beamSearch' so that the 'best' candidates with the best scores come first, breaking ties by index
+void partitionBeamCandidates(beam_search *beamSearch, int count, int best)
+{
+    int *selected = beamSearch->SelectedCandidates;
+    int first = 0;
+    int end = count;
+    int pivot;
+    int64_t pivotScore;
+    int left;
+    int right;
+    int swapped;
+
+    // Quickselect: partition around the middle candidate, then only carry on in the part holding the boundary of the best candidates
+    while (end - first > 1)
+    {
+        pivot = selected[first + (end - first) / 2];
+        pivotScore = beamSearch->Candidates[pivot].Score;
+        left = first;
+        right = end - 1;
+
+        while (left <= right)
+        {
+            while (beamSearch->Candidates[selected[left]].Score < pivotScore || (beamSearch->Candidates[selected[left]].Score == pivotScore && selected[left] < pivot)) left++;
+            while (beamSearch->Candidates[selected[right]].Score > pivotScore || (beamSearch->Candidates[selected[right]].Score == pivotScore && selected[right] > pivot)) right--;
+
+            if (left <= right)
+            {
+                swapped = selected[left];
+                selected[left++] = selected[right];
+                selected[right--] = swapped;
+            }
+        }
+
+        // Candidates in [first, right] come before the pivot, those in [left, end) after it, and any between them is the pivot
+        if (best <= right) end = right + 1;
+        else if (best >= left) first = left;
+        else return;
+    }
+}
+
+// Remove the duplicate grid states from the candidates of 'beamSearch', and keep the BeamWidth candidates with the best scores as the new beam, recording the parent and placement of each. Add the number of candidates to 'result', and return the number of states in the new beam
+int selectBeamStates(beam_search *beamSearch, beam_result *result)
+{
+    int historySlot = (beamSearch->Depth + 1) % BEAM_HISTORY_DEPTH;
+    int count = 0;
+    int candidateIndex;
+    beam_state *candidate;
+    beam_state *seenCandidate;
+    int hashIndex;
+    int duplicate;
+
+    // Entries of the previous generations are empty, so the table is only cleared once the generations wrap around
+    if (++beamSearch->HashGeneration == 0)
+    {
+        memset(beamSearch->HashGenerations, 0, sizeof(unsigned int) * beamSearch->HashTableSize);
+        beamSearch->HashGeneration = 1;
+    }
+
+    for (int state = 0; state < beamSearch->StateCount; state++)
+    {
+        result->States += beamSearch->CandidateCounts[state];
+
+        for (int stateCandidate = 0; stateCandidate < beamSearch->CandidateCounts[state]; stateCandidate++)
+        {
+            candidateIndex = state * MAX_PIECE_PLACEMENTS + stateCandidate;
+            candidate = &beamSearch->Candidates[candidateIndex];
+            duplicate = FALSE;
+
+            // Identical grid states have identical subtrees, so only the first one found is kept
+            for (hashIndex = (int) (candidate->Hash & (beamSearch->HashTableSize - 1)); beamSearch->HashGenerations[hashIndex] == beamSearch->HashGeneration; hashIndex = (hashIndex + 1) & (beamSearch->HashTableSize - 1))
+            {
+                seenCandidate = &beamSearch->Candidates[beamSearch->HashCandidates[hashIndex]];
+
+                if (seenCandidate->Hash == candidate->Hash && areSkylinesEqual(seenCandidate->Skyline, candidate->Skyline) == TRUE && seenCandidate->BaseHeight == candidate->BaseHeight)
+                {
+                    duplicate = TRUE;
+                    break;
+                }
+            }
+
+            if (duplicate == TRUE) continue;
+
+            beamSearch->HashGenerations[hashIndex] = beamSearch->HashGeneration;
+            beamSearch->HashCandidates[hashIndex] = candidateIndex;
+            beamSearch->SelectedCandidates[count++] = candidateIndex;
+        }
+    }
+
+    if (count > beamSearch->BeamWidth)
+    {
+        partitionBeamCandidates(beamSearch, count, beamSearch->BeamWidth);
+        count = beamSearch->BeamWidth;
+    }
+
+    for (int state = 0; state < count; state++)
+    {
+        candidate = &beamSearch->Candidates[beamSearch->SelectedCandidates[state]];
+
+        beamSearch->States[state] = *candidate;
+        beamSearch->HistoryParents[historySlot * beamSearch->BeamWidth + state] = candidate->Parent;
+        beamSearch->HistoryPlacements[historySlot * beamSearch->BeamWidth + state] = (unsigned short) candidate->Placement;
+    }
+
+    beamSearch->StateCount = count;
+    beamSearch->Depth++;
+
+    return count;
+}
+
+// Return the index of the ancestor 'depth' pieces deep of the state 'state' in the beam of 'beamSearch'
+int getBeamAncestor(beam_search *beamSearch, int state, int depth)
+{
+    for (int stateDepth = beamSearch->Depth; stateDepth > depth; stateDepth--)
+        state = beamSearch->HistoryParents[(stateDepth % BEAM_HISTORY_DEPTH) * beamSearch->BeamWidth + state];
+
+    return state;
+}
+
+// Store in 'result' the column and rotation of each piece from the committed depth of 'beamSearch' up to 'depth', which stack to the state 'state', 'depth' pieces deep
+void commitBeamPlacements(beam_search *beamSearch, int state, int depth, beam_result *result)
+{
+    placement *statePlacement;
+    int historyIndex;
+
+    for (int stateDepth = depth; stateDepth > beamSearch->CommittedDepth; stateDepth--)
+    {
+        historyIndex = (stateDepth % BEAM_HISTORY_DEPTH) * beamSearch->BeamWidth + state;
+        statePlacement = &beamSearch->PlacementTable.Placements[beamSearch->HistoryPlacements[historyIndex]];
+
+        result->PieceColumns[stateDepth - 1] = statePlacement->Column;
+        result->PieceRotations[stateDepth - 1] = statePlacement->Rotation;
+        state = beamSearch->HistoryParents[historyIndex];
+    }
+
+    beamSearch->CommittedDepth = depth;
+}
+
+// Commit the older half of the history of 'beamSearch' to 'result' once it is full, keeping only the states in the beam which descend from the same ancestor as its best state
+void commitBeamHistory(beam_search *beamSearch, beam_result *result)
+{
+    int historySlot = (beamSearch->Depth % BEAM_HISTORY_DEPTH) * beamSearch->BeamWidth;
+    int commitDepth = beamSearch->CommittedDepth + BEAM_HISTORY_DEPTH / 2;
+    int bestState = 0;
+    int ancestor;
+    int keptStates = 0;
+
+    if (beamSearch->Depth - beamSearch->CommittedDepth < BEAM_HISTORY_DEPTH) return;
+
+    for (int state = 1; state < beamSearch->StateCount; state++)
+        if (beamSearch->States[state].Score < beamSearch->States[bestState].Score) bestState = state;
+
+    ancestor = getBeamAncestor(beamSearch, bestState, commitDepth);
+
+    // The states of a beam almost always share their ancestors this far back, so this rarely drops any
+    for (int state = 0; state < beamSearch->StateCount; state++)
+    {
+        if (getBeamAncestor(beamSearch, state, commitDepth) != ancestor) continue;
+
+        beamSearch->States[keptStates] = beamSearch->States[state];
+        beamSearch->HistoryParents[historySlot + keptStates] = beamSearch->HistoryParents[historySlot + state];
+        beamSearch->HistoryPlacements[historySlot + keptStates] = beamSearch->HistoryPlacements[historySlot + state];
+        keptStates++;
+    }
+
+    beamSearch->StateCount = keptStates;
+    commitBeamPlacements(beamSearch, ancestor, commitDepth, result);
+}
+
+// Create a beam search keeping 'beamWidth' grid states after each piece, expanding them with the number of solver threads set in 'solverSettings'. Return TRUE if it was created, FALSE if it couldn't be allocated
+int createBeamSearch(beam_search *beamSearch, int beamWidth, solver_settings *solverSettings)
+{
+    size_t candidates = (size_t) beamWidth * MAX_PIECE_PLACEMENTS;
+
+    memset(beamSearch, 0, sizeof(beam_search));
+
+    beamSearch->BeamWidth = beamWidth;
+    beamSearch->NumberOfThreads = solverSettings->NumberOfSolvers;
+
+    // The hash table is kept at most half full, so that probes stay short
+    beamSearch->HashTableSize = 1;
+    while ((size_t) beamSearch->HashTableSize < 2 * candidates) beamSearch->HashTableSize *= 2;
+
+    beamSearch->States = malloc(sizeof(beam_state) * beamWidth);
+    beamSearch->Candidates = malloc(sizeof(beam_state) * candidates);
+    beamSearch->CandidateCounts = malloc(sizeof(int) * beamWidth);
+    beamSearch->SelectedCandidates = malloc(sizeof(int) * candidates);
+    beamSearch->HashCandidates = malloc(sizeof(int) * beamSearch->HashTableSize);
+    beamSearch->HashGenerations = calloc(beamSearch->HashTableSize, sizeof(unsigned int));
+    beamSearch->HistoryParents = malloc(sizeof(int) * BEAM_HISTORY_DEPTH * beamWidth);
+    beamSearch->HistoryPlacements = malloc(sizeof(unsigned short) * BEAM_HISTORY_DEPTH * beamWidth);
+    beamSearch->Threads = malloc(sizeof(beam_thread) * beamSearch->NumberOfThreads);
+    beamSearch->ThreadCreated = malloc(sizeof(int) * beamSearch->NumberOfThreads);
+    beamSearch->ThreadParams = malloc(sizeof(beam_thread_params) * beamSearch->NumberOfThreads);
+
+    if (beamSearch->States == NULL || beamSearch->Candidates == NULL || beamSearch->CandidateCounts == NULL || beamSearch->SelectedCandidates == NULL || \
+        beamSearch->HashCandidates == NULL || beamSearch->HashGenerations == NULL || beamSearch->HistoryParents == NULL || beamSearch->HistoryPlacements == NULL || \
+        beamSearch->Threads == NULL || beamSearch->ThreadCreated == NULL || beamSearch->ThreadParams == NULL)
+    {
+        free(beamSearch->States);
+        free(beamSearch->Candidates);
+        free(beamSearch->CandidateCounts);
+        free(beamSearch->SelectedCandidates);
+        free(beamSearch->HashCandidates);
+        free(beamSearch->HashGenerations);
+        free(beamSearch->HistoryParents);
+        free(beamSearch->HistoryPlacements);
+        free(beamSearch->Threads);
+        free(beamSearch->ThreadCreated);
+        free(beamSearch->ThreadParams);
+        return FALSE;
+    }
+
+    initialiseLock(&beamSearch->Lock);
+    initialiseCondition(&beamSearch->ExpansionStarted);
+    initialiseCondition(&beamSearch->ExpansionFinished);
+
+    // The first slice is always expanded by the thread solving the sequence
+    beamSearch->ThreadCreated[0] = FALSE;
+
+    for (int slice = 1; slice < beamSearch->NumberOfThreads; slice++)
+    {
+        beamSearch->ThreadParams[slice].BeamSearch = beamSearch;
+        beamSearch->ThreadParams[slice].Slice = slice;
+        beamSearch->ThreadCreated[slice] = createBeamThread(&beamSearch->Threads[slice], &beamSearch->ThreadParams[slice]);
+    }
+
+    return TRUE;
+}
+
+// Stop the threads of 'beamSearch' and free it. No sequence may be being solved with it
+void destroyBeamSearch(beam_search *beamSearch)
+{
+    acquireLock(&beamSearch->Lock);
+    beamSearch->Stopping = TRUE;
+    signalCondition(&beamSearch->ExpansionStarted);
+    releaseLock(&beamSearch->Lock);
+
+    for (int slice = 1; slice < beamSearch->NumberOfThreads; slice++)
+        if (beamSearch->ThreadCreated[slice] == TRUE) joinBeamThread(beamSearch->Threads[slice]);
+
+    destroyCondition(&beamSearch->ExpansionStarted);
+    destroyCondition(&beamSearch->ExpansionFinished);
+    destroyLock(&beamSearch->Lock);
+
+    free(beamSearch->States);
+    free(beamSearch->Candidates);
+    free(beamSearch->CandidateCounts);
+    free(beamSearch->SelectedCandidates);
+    free(beamSearch->HashCandidates);
+    free(beamSearch->HashGenerations);
+    free(beamSearch->HistoryParents);
+    free(beamSearch->HistoryPlacements);
+    free(beamSearch->Threads);
+    free(beamSearch->ThreadCreated);
+    free(beamSearch->ThreadParams);
+}
+
+// Drop the 'size' pieces in 'sequence' into a grid 'gridWidth' columns wide with 'beamSearch', keeping its beam width of the best grid states after each piece. Only the default rotation is used unless 'allowRotation' is TRUE.
+// Return TRUE and the lowest stack in the final beam in 'result', whose piece arrays must hold 'size' entries. Return FALSE if the sequence is empty or holds a character which is not a tetromino, the grid width is out of range, or no state in the beam can take the next piece as its stack is MAX_SKYLINE_HEIGHT rows above its lowest column
+int beamSearchSequence(beam_search *beamSearch, const char *sequence, int size, int allowRotation, int gridWidth, beam_result *result)
+{
+    char pieces[] = BEAM_PIECES;
+    double startTime = getWallClockTime();
+    int bestState = 0;
+    int bestStackHeight;
+    int stackHeight;
+
+    if (size < 1 || gridWidth < MIN_GRID_WIDTH || gridWidth > MAX_GRID_WIDTH) return FALSE;
+
+    for (int piece = 0; piece < size; piece++)
+        if (sequence[piece] == '\0' || strchr(BEAM_PIECES, sequence[piece]) == NULL) return FALSE;
+
+    // Each piece of the sequence is dropped at the placements of the same piece in BEAM_PIECES. If they are built in its mirror image, so is every stack, and the placements hold the columns and rotations of 'sequence' anyway
+    buildPlacementTable(&beamSearch->PlacementTable, pieces, (int) strlen(pieces), allowRotation, gridWidth, TRUE, NULL, NULL);
+
+    beamSearch->Sequence = sequence;
+    beamSearch->GridWidth = gridWidth;
+    beamSearch->Depth = 0;
+    beamSearch->CommittedDepth = 0;
+    beamSearch->StateCount = 1;
+    beamSearch->States[0].Skyline = EMPTY_SKYLINE;
+    beamSearch->States[0].BaseHeight = 0;
+    beamSearch->States[0].Score = 0;
+    result->States = 0;
+
+    while (beamSearch->Depth < size)
+    {
+        expandBeam(beamSearch);
+        if (selectBeamStates(beamSearch, result) == 0) return FALSE;
+
+        commitBeamHistory(beamSearch, result);
+    }
+
+    // The beam is scored by how well its states take the next pieces, but the last one is judged by its stack height alone
+    bestStackHeight = beamSearch->States[0].BaseHeight + getSkylineHeight(beamSearch->States[0].Skyline);
+
+    for (int state = 1; state < beamSearch->StateCount; state++)
+    {
+        stackHeight = beamSearch->States[state].BaseHeight + getSkylineHeight(beamSearch->States[state].Skyline);
+
+        if (stackHeight < bestStackHeight || (stackHeight == bestStackHeight && beamSearch->States[state].Score < beamSearch->States[bestState].Score))
+        {
+            bestState = state;
+            bestStackHeight = stackHeight;
+        }
+    }
+
+    commitBeamPlacements(beamSearch, bestState, size, result);
+    result->StackHeight = bestStackHeight;
+    result->ElapsedTime = getWallClockTime() - startTime;
+
+    return TRUE;
+}
@@ -0,0 +1,156 @@
+#ifndef BEAM_SEARCH_H
+#define BEAM_SEARCH_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "placement.h"
+#include "skyline.h"
+#include "thread_utils.h"
+
+#define BEAM_PIECES "IJLOSTZ" // Pieces whose placements are built once per sequence, as beam sequences are too long for a placement table holding every piece
+#define MAX_BEAM_WIDTH 100000
+#define BEAM_HISTORY_DEPTH 256 // Pieces whose placements are kept for each state in the beam. Once they fill up, the older half is committed to the solution
+#define BEAM_MIN_SLICE_STATES 16 // Fewest states per thread worth waking the beam threads for. Smaller beams are expanded by the thread solving the sequence alone
+
+// Weights of the features of a grid state in its beam score. Lower scores are better
+#define BEAM_HEIGHT_WEIGHT 2 // Per row of the stack height
+#define BEAM_AREA_WEIGHT 3 // Per cell under the skyline. All states at the same depth hold the same cells, so this only weighs the holes
+#define BEAM_BUMPINESS_WEIGHT 1 // Per row of height difference between neighbouring columns
+
+typedef struct // Stores a grid state in the beam, or a candidate for the beam reached by dropping a piece onto one
+{
+    skyline Skyline; // Lowered so that its lowest column is at height 0, so that its columns never outgrow a skyline however many pieces are dropped
+    int BaseHeight; // Height the skyline was lowered by
+    int Parent; // Index of the state in the beam it was reached from
+    int Placement; // Index of the placement dropped onto the parent state to reach it, in the placement table
+    int64_t Score;
+    uint64_t Hash; // Hash of the skyline and base height, so that identical grid states are only kept once
+} beam_state;
+
+typedef struct // Stores the solution of a sequence found by beam search
+{
+    int StackHeight;
+    // Stores the column and rotation index of each piece which stack to the stack height. Allocated by the caller, one entry per piece
+    int *PieceColumns;
+    int *PieceRotations;
+    uint64_t States; // Candidate grid states scored
+    double ElapsedTime; // Seconds
+} beam_result;
+
+typedef struct beam_search beam_search;
+
+
+#ifdef _WIN32 // Windows implementation (multi-threaded)
+
+#include <windows.h>
+
+typedef HANDLE beam_thread;
+
+
+#elif defined __linux__ // Linux implementation (multi-threaded)
+
+#include <pthread.h>
+
+typedef pthread_t beam_thread;
+
+
+#else // Standard implementation (single-threaded)
+
+typedef int beam_thread;
+
+#endif
+
+typedef struct // Stores the data required by a beam thread
+{
+    beam_search *BeamSearch;
+    int Slice; // Index of the slice of the beam the thread expands
+} beam_thread_params;
+
+struct beam_search // Stores the beam, the candidates it expands to and the threads expanding it, sized by the beam width and kept between sequences
+{
+    int BeamWidth; // Most grid states kept after each piece
+    int NumberOfThreads; // Number of slices the beam is split into when expanding it, each expanded by its own thread
+
+    // Stores the sequence being solved, the placements of each piece in BEAM_PIECES, and the number of pieces dropped onto the states in the beam
+    const char *Sequence;
+    int GridWidth;
+    placement_table PlacementTable;
+    int Depth;
+
+    // Stores the states in the beam and the candidates they expand to. Each state's candidates start at its index times MAX_PIECE_PLACEMENTS
+    beam_state *States;
+    int StateCount;
+    beam_state *Candidates;
+    int *CandidateCounts;
+    int *SelectedCandidates; // Indices of the candidates which are not duplicates, then of those kept in the beam
+
+    // Stores the candidates seen while removing duplicates, in an open addressing hash table. Entries stamped with an older generation are empty
+    int *HashCandidates;
+    unsigned int *HashGenerations;
+    int HashTableSize; // A power of 2
+    unsigned int HashGeneration;
+
+    // Stores the parent and placement of each state in the beam after each of the last BEAM_HISTORY_DEPTH pieces, in a ring indexed by the depth. Every state in the beam descends from one state at the committed depth, whose placements are in the result
+    int *HistoryParents;
+    unsigned short *HistoryPlacements;
+    int CommittedDepth;
+
+    // Stores the expansion the threads run. 'Expansion' is incremented each time one is started
+    unsigned int Expansion;
+    int RunningThreads; // Number of beam threads which haven't finished the current expansion
+    int Stopping; // TRUE once the threads are told to exit
+    solver_lock Lock;
+    solver_condition ExpansionStarted;
+    solver_condition ExpansionFinished;
+
+    // Slices whose thread couldn't be created are expanded by the thread solving the sequence, which also expands the first slice
+    beam_thread *Threads;
+    int *ThreadCreated;
+    beam_thread_params *ThreadParams;
+};
+
+// Create a beam thread expanding the slice of the beam in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createBeamThread(beam_thread *thread, beam_thread_params *threadParams);
+
+// Block until the beam thread 'thread' has exited, then free its handle
+void joinBeamThread(beam_thread thread);
+
+// Return the score of the grid state 'gridSkyline', lowered by 'baseHeight', in a grid 'gridWidth' columns wide. Lower scores are better: a low stack with few holes and a flat surface
+int64_t getBeamStateScore(skyline gridSkyline, int baseHeight, int gridWidth);
+
+// Expand the states in slice 'slice' of the 'slices' slices of the beam of 'beamSearch' into its candidates, by dropping the next piece onto them at each of its placements
+void expandBeamSlice(beam_search *beamSearch, int slice, int slices);
+
+// Expand each state in the beam of 'beamSearch' into its candidates, with each slice of the beam expanded by its own thread. Return once every slice is expanded
+void expandBeam(beam_search *beamSearch);
+
+// Expand the slice of the beam in 'threadParams' each time the beam is expanded, until the beam search is destroyed
+void runBeamSlice(beam_thread_params *threadParams);
+
+// Reorder the first 'count' indices in the selected candidates of 'beamSearch' so that the 'best' candidates with the best scores come first, breaking ties by index
+void partitionBeamCandidates(beam_search *beamSearch, int count, int best);
+
+// Remove the duplicate grid states from the candidates of 'beamSearch', and keep the BeamWidth candidates with the best scores as the new beam, recording the parent and placement of each. Add the number of candidates to 'result', and return the number of states in the new beam
+int selectBeamStates(beam_search *beamSearch, beam_result *result);
+
+// Return the index of the ancestor 'depth' pieces deep of the state 'state' in the beam of 'beamSearch'
+int getBeamAncestor(beam_search *beamSearch, int state, int depth);
+
+// Store in 'result' the column and rotation of each piece from the committed depth of 'beamSearch' up to 'depth', which stack to the state 'state', 'depth' pieces deep
+void commitBeamPlacements(beam_search *beamSearch, int state, int depth, beam_result *result);
+
+// Commit the older half of the history of 'beamSearch' to 'result' once it is full, keeping only the states in the beam which descend from the same ancestor as its best state
+void commitBeamHistory(beam_search *beamSearch, beam_result *result);
+
+// Create a beam search keeping 'beamWidth' grid states after each piece, expanding them with the number of solver threads set in 'solverSettings'. Return TRUE if it was created, FALSE if it couldn't be allocated
+int createBeamSearch(beam_search *beamSearch, int beamWidth, solver_settings *solverSettings);
+
+// Stop the threads of 'beamSearch' and free it. No sequence may be being solved with it
+void destroyBeamSearch(beam_search *beamSearch);
+
+// Drop the 'size' pieces in 'sequence' into a grid 'gridWidth' columns wide with 'beamSearch', keeping its beam width of the best grid states after each piece. Only the default rotation is used unless 'allowRotation' is TRUE.
+// Return TRUE and the lowest stack in the final beam in 'result', whose piece arrays must hold 'size' entries. Return FALSE if the sequence is empty or holds a character which is not a tetromino, the grid width is out of range, or no state in the beam can take the next piece as its stack is MAX_SKYLINE_HEIGHT rows above its lowest column
+int beamSearchSequence(beam_search *beamSearch, const char *sequence, int size, int allowRotation, int gridWidth, beam_result *result);
+
+#endif
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "benchmark.h"
+#include "input_utils.h"
+#include "solver_library.h"
+#include "tetromino.h"
+#include "permutation_count.h"
+
+const int benchmarkLengths[NUMBER_OF_BENCHMARK_LENGTHS] = {8, 11, 14, 17, 20}; // Lengths of the benchmark sequences, each solved with and without rotation
+
+// Advance the generator state 'state' and return its next pseudo-random number (xorshift64*). Used instead of rand() so that the corpus is the same with every C library
+uint64_t getNextBenchmarkRandom(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Fill 'sequence' with 'size' pieces dealt from shuffled bags of the pieces in BENCHMARK_BAG, using and advancing the generator state 'state'
+void generateBenchmarkSequence(uint64_t *state, char sequence[], int size)
+{
+    char bag[] = BENCHMARK_BAG;
+    int bagSize = (int) strlen(bag);
+    int swapPiece;
+    char piece;
+
+    for (int dealt = 0; dealt < size; dealt++)
+    {
+        // Shuffle a new bag once the previous one is used up
+        if (dealt % bagSize == 0)
+        {
+            for (int bagPiece = bagSize - 1; bagPiece > 0; bagPiece--)
+            {
+                swapPiece = (int) (getNextBenchmarkRandom(state) % (uint64_t) (bagPiece + 1));
+                piece = bag[bagPiece];
+                bag[bagPiece] = bag[swapPiece];
+                bag[swapPiece] = piece;
+            }
+        }
+
+        sequence[dealt] = bag[dealt % bagSize];
+    }
+}
+
+// Return the search tree nodes entered per second in 'result'
+double getBenchmarkNodesPerSecond(benchmark_result *result)
+{
+    return result->Seconds > 0 ? (double) result->Nodes / result->Seconds : 0;
+}
+
+// Return the pruning ratio of 'result': the number of permutations of its sequences accounted for by each search tree node entered. Higher means more of the search tree was pruned
+double getBenchmarkPruningRatio(benchmark_result *result)
+{
+    return result->Nodes > 0 ? (double) result->Permutations / (double) result->Nodes : 0;
+}
+
+// Print the header of the benchmark results file to 'output'
+void printBenchmarkHeader(FILE *output)
+{
+    fprintf(output, "threads,group,width,sequences,height,nodes,permutations,seconds,nodes_per_second,pruning_ratio,speedup,efficiency\n");
+}
+
+// Print 'result' to 'output' as one CSV line, with the speedup and parallel efficiency over 'singleThreadResult', the same group solved with one thread
+void printBenchmarkResult(FILE *output, benchmark_result *result, benchmark_result *singleThreadResult)
+{
+    char permutations[MAX_PERMUTATION_COUNT_LENGTH];
+    double speedup = result->Seconds > 0 ? singleThreadResult->Seconds / result->Seconds : 0;
+
+    fprintf(output, "%d,%s,%d,%d,%d,%llu,%s,%.6f,%.0f,%.6g,%.3f,%.3f\n", result->Threads, result->Group, result->GridWidth, result->Sequences, result->HeightSum, \
+        (unsigned long long) result->Nodes, formatPermutationCount(result->Permutations, permutations), result->Seconds, getBenchmarkNodesPerSecond(result), \
+        getBenchmarkPruningRatio(result), speedup, speedup / result->Threads);
+}
+
+// Parse the CSV line 'line' of a benchmark results file into 'result'. Return TRUE if it holds a result, FALSE otherwise
+int parseBenchmarkResult(const char *line, benchmark_result *result)
+{
+    unsigned long long nodes;
+
+    // The permutations are only written for plotting, results are compared on the other columns
+    if (sscanf(line, "%d,%15[^,],%d,%d,%d,%llu,%*[^,],%lf", &result->Threads, result->Group, &result->GridWidth, &result->Sequences, &result->HeightSum, &nodes, &result->Seconds) != 7) return FALSE;
+
+    result->Nodes = (uint64_t) nodes;
+    result->Permutations = 0;
+    return TRUE;
+}
+
+// Solve the benchmark corpus in a grid BENCHMARK_GRID_WIDTH columns wide, in a solve context with the settings in 'solverSettings' and 'threads' solver threads, storing the results of each group in 'results'. Return the number of groups, or 0 if the context couldn't be created
+int runBenchmarkThreads(solver_settings *solverSettings, int threads, benchmark_result results[MAX_BENCHMARK_GROUPS])
+{
+    solver_settings benchmarkSettings = *solverSettings;
+    solve_context *solveContext;
+    solve_request request = {0};
+    solve_result result;
+    benchmark_result *group;
+    benchmark_result *total = &results[MAX_BENCHMARK_GROUPS - 1];
+
+    uint64_t state = BENCHMARK_SEED;
+    char sequence[MAX_SEQUENCE_SIZE];
+
+    // Cached solutions would skip the searches being measured
+    benchmarkSettings.NumberOfSolvers = threads;
+    benchmarkSettings.CacheFile = NULL;
+    benchmarkSettings.ShowProgress = FALSE;
+
+    solveContext = createSolveContext(&benchmarkSettings);
+    if (solveContext == NULL) return 0;
+
+    memset(results, 0, sizeof(benchmark_result) * MAX_BENCHMARK_GROUPS);
+
+    for (int groupIndex = 0; groupIndex < MAX_BENCHMARK_GROUPS; groupIndex++)
+    {
+        results[groupIndex].Threads = threads;
+        results[groupIndex].GridWidth = BENCHMARK_GRID_WIDTH;
+
+        if (groupIndex == MAX_BENCHMARK_GROUPS - 1) snprintf(results[groupIndex].Group, MAX_BENCHMARK_GROUP_LENGTH, "all");
+        else snprintf(results[groupIndex].Group, MAX_BENCHMARK_GROUP_LENGTH, "%d%c", benchmarkLengths[groupIndex / 2], groupIndex % 2 == 1 ? 'Y' : 'N');
+    }
+
+    request.Sequence = sequence;
+    request.GridWidth = BENCHMARK_GRID_WIDTH;
+
+    for (int length = 0; length < NUMBER_OF_BENCHMARK_LENGTHS; length++)
+    {
+        for (int sequenceIndex = 0; sequenceIndex < BENCHMARK_SEQUENCES_PER_LENGTH; sequenceIndex++)
+        {
+            generateBenchmarkSequence(&state, sequence, benchmarkLengths[length]);
+            request.Size = benchmarkLengths[length];
+
+            for (int allowRotation = FALSE; allowRotation <= TRUE; allowRotation++)
+            {
+                request.AllowRotation = allowRotation;
+                solveSequenceRequest(solveContext, &request, &result);
+
+                group = &results[length * 2 + (allowRotation == TRUE ? 1 : 0)];
+
+                group->Sequences++;
+                group->HeightSum += result.StackHeight;
+                group->Nodes += result.Nodes;
+                group->Permutations += result.Permutations;
+                group->Seconds += result.ElapsedTime;
+
+                total->Sequences++;
+                total->HeightSum += result.StackHeight;
+                total->Nodes += result.Nodes;
+                total->Permutations += result.Permutations;
+                total->Seconds += result.ElapsedTime;
+            }
+        }
+    }
+
+    destroySolveContext(solveContext);
+    return MAX_BENCHMARK_GROUPS;
+}
+
+// Compare 'result' with the result of the same group and thread count in 'baseline', 'baselineSize' results long, printing any differences larger than 'tolerance' percent. Return the number of regressions found
+int compareBenchmarkResult(benchmark_result *result, benchmark_result baseline[], int baselineSize, int tolerance)
+{
+    benchmark_result *baselineResult = NULL;
+    double limit = (double) tolerance / 100;
+    int regressions = 0;
+
+    for (int baselineIndex = 0; baselineIndex < baselineSize && baselineResult == NULL; baselineIndex++)
+    {
+        if (baseline[baselineIndex].Threads == result->Threads && baseline[baselineIndex].GridWidth == result->GridWidth && strcmp(baseline[baselineIndex].Group, result->Group) == 0)
+            baselineResult = &baseline[baselineIndex];
+    }
+
+    if (baselineResult == NULL) return 0;
+
+    // The lowest stacks are exact, so any change is a bug rather than noise
+    if (result->HeightSum != baselineResult->HeightSum)
+    {
+        fprintf(stderr, "REGRESSION %d thread(s), group %s: stack heights sum to %d, baseline %d\n", result->Threads, result->Group, result->HeightSum, baselineResult->HeightSum);
+        regressions++;
+    }
+
+    // One solver searches the same tree on every run and machine, so its node count only changes with the search itself
+    if (result->Threads == 1 && (double) result->Nodes > (double) baselineResult->Nodes * (1 + limit))
+    {
+        fprintf(stderr, "REGRESSION %d thread(s), group %s: %llu nodes, baseline %llu\n", result->Threads, result->Group, \
+            (unsigned long long) result->Nodes, (unsigned long long) baselineResult->Nodes);
+        regressions++;
+    }
+
+    // Times are only compared for the whole corpus, as single groups solve too quickly to time reliably
+    if (strcmp(result->Group, "all") == 0)
+    {
+        if (result->Seconds > baselineResult->Seconds * (1 + limit))
+        {
+            fprintf(stderr, "REGRESSION %d thread(s): %.3f seconds, baseline %.3f\n", result->Threads, result->Seconds, baselineResult->Seconds);
+            regressions++;
+        }
+
+        if (getBenchmarkNodesPerSecond(result) < getBenchmarkNodesPerSecond(baselineResult) * (1 - limit))
+        {
+            fprintf(stderr, "REGRESSION %d thread(s): %.0f nodes per second, baseline %.0f\n", result->Threads, getBenchmarkNodesPerSecond(result), getBenchmarkNodesPerSecond(baselineResult));
+            regressions++;
+        }
+    }
+
+    return regressions;
+}
+
+// Read the benchmark results file 'file' into a newly allocated array stored in 'baseline', and return the number of results read. Return -1 if it couldn't be read
+int readBenchmarkBaseline(const char *file, benchmark_result **baseline)
+{
+    FILE *input = fopen(file, "r");
+    char line[MAX_BENCHMARK_LINE_LENGTH];
+    benchmark_result *results = NULL;
+    benchmark_result *grownResults;
+    int size = 0;
+    int capacity = 0;
+
+    if (input == NULL) return -1;
+
+    while (fgets(line, sizeof(line), input) != NULL)
+    {
+        if (size == capacity)
+        {
+            capacity = capacity == 0 ? MAX_BENCHMARK_GROUPS * 8 : capacity * 2;
+            grownResults = realloc(results, sizeof(benchmark_result) * capacity);
+
+            if (grownResults == NULL)
+            {
+                free(results);
+                fclose(input);
+                return -1;
+            }
+
+            results = grownResults;
+        }
+
+        // The header and any other line which isn't a result is skipped
+        if (parseBenchmarkResult(line, &results[size]) == TRUE) size++;
+    }
+
+    fclose(input);
+    *baseline = results;
+    return size;
+}
+
+// Solve the benchmark corpus in a grid BENCHMARK_GRID_WIDTH columns wide with 1 solver thread, doubling up to the number set in 'solverSettings', writing the results to its benchmark file and comparing them with its baseline file, if set. Return TRUE if the benchmark ran without regressions, FALSE otherwise
+int runBenchmark(solver_settings *solverSettings)
+{
+    FILE *output;
+    benchmark_result singleThreadResults[MAX_BENCHMARK_GROUPS];
+    benchmark_result results[MAX_BENCHMARK_GROUPS];
+    benchmark_result *baseline = NULL;
+    benchmark_result *total = &results[MAX_BENCHMARK_GROUPS - 1];
+    int baselineSize = 0;
+    int regressions = 0;
+    int groups;
+    int threads = 1;
+
+    // Errors and the summary go to stderr, so that the results can be written to stdout
+    if (solverSettings->BaselineFile != NULL && (baselineSize = readBenchmarkBaseline(solverSettings->BaselineFile, &baseline)) < 0)
+    {
+        fprintf(stderr, "Could not read benchmark baseline '%s'!\n", solverSettings->BaselineFile);
+        return FALSE;
+    }
+
+    output = strcmp(solverSettings->BenchmarkFile, "-") == 0 ? stdout : fopen(solverSettings->BenchmarkFile, "w");
+
+    if (output == NULL)
+    {
+        fprintf(stderr, "Could not open benchmark file '%s'!\n", solverSettings->BenchmarkFile);
+        free(baseline);
+        return FALSE;
+    }
+
+    printBenchmarkHeader(output);
+    fprintf(stderr, "Benchmarking %d sequences of %d to %d pieces in a grid %d columns wide, with 1 to %d solver thread(s)\n\n", \
+        NUMBER_OF_BENCHMARK_LENGTHS * BENCHMARK_SEQUENCES_PER_LENGTH * 2, benchmarkLengths[0], benchmarkLengths[NUMBER_OF_BENCHMARK_LENGTHS - 1], \
+        BENCHMARK_GRID_WIDTH, solverSettings->NumberOfSolvers);
+    fprintf(stderr, "Threads  Seconds       Nodes/s  Pruning ratio  Speedup  Efficiency\n");
+
+    while (TRUE)
+    {
+        groups = runBenchmarkThreads(solverSettings, threads, results);
+
+        if (groups == 0)
+        {
+            fprintf(stderr, "Could not allocate the solvers and transposition table!\n");
+            regressions++;
+            break;
+        }
+
+        if (threads == 1) memcpy(singleThreadResults, results, sizeof(results));
+
+        for (int group = 0; group < groups; group++)
+        {
+            printBenchmarkResult(output, &results[group], &singleThreadResults[group]);
+            regressions += compareBenchmarkResult(&results[group], baseline, baselineSize, solverSettings->BenchmarkTolerance);
+        }
+
+        fflush(output);
+        fprintf(stderr, "%7d  %7.3f  %12.0f  %13.4g  %7.2f  %10.2f\n", threads, total->Seconds, getBenchmarkNodesPerSecond(total), getBenchmarkPruningRatio(total), \
+            singleThreadResults[MAX_BENCHMARK_GROUPS - 1].Seconds / total->Seconds, singleThreadResults[MAX_BENCHMARK_GROUPS - 1].Seconds / total->Seconds / threads);
+
+        // Thread counts double to draw the scaling curve, ending with every thread set
+        if (threads == solverSettings->NumberOfSolvers) break;
+        threads = threads * 2 < solverSettings->NumberOfSolvers ? threads * 2 : solverSettings->NumberOfSolvers;
+    }
+
+    if (output != stdout && fclose(output) != 0)
+    {
+        fprintf(stderr, "Could not write benchmark file '%s'!\n", solverSettings->BenchmarkFile);
+        regressions++;
+    }
+
+    if (solverSettings->BaselineFile != NULL) fprintf(stderr, "\n%d regression(s) against baseline '%s'\n", regressions, solverSettings->BaselineFile);
+
+    free(baseline);
+    return regressions == 0 ? TRUE : FALSE;
+}
@@ -0,0 +1,69 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "tetromino.h"
+#include "permutation_count.h"
+#include "grid.h"
+
+#define BENCHMARK_BAG "IJLOSTZ" // Pieces dealt in a random order in each bag of a benchmark sequence, as in modern Tetris games
+#define BENCHMARK_SEED 0x7E7215C0FFEEULL // Seed of the generator of the benchmark sequences, fixed so that every run solves the same corpus
+#define BENCHMARK_GRID_WIDTH 8 // Wide enough that the longer sequences take seconds to solve, rather than milliseconds
+#define BENCHMARK_SEQUENCES_PER_LENGTH 10 // Sequences of each length in the corpus, each solved with and without rotation
+#define NUMBER_OF_BENCHMARK_LENGTHS 5
+#define MAX_BENCHMARK_GROUPS (NUMBER_OF_BENCHMARK_LENGTHS * 2 + 1) // Groups of results per thread count: each length with and without rotation, and the totals
+#define MAX_BENCHMARK_GROUP_LENGTH 16
+#define MAX_BENCHMARK_LINE_LENGTH 256
+#define DEFAULT_BENCHMARK_TOLERANCE 10 // Percent
+
+extern const int benchmarkLengths[NUMBER_OF_BENCHMARK_LENGTHS];
+
+typedef struct // Stores the results of solving a group of the benchmark corpus with a number of solver threads
+{
+    int Threads;
+    char Group[MAX_BENCHMARK_GROUP_LENGTH]; // The length of the sequences followed by 'Y' or 'N' for whether rotation was allowed, or "all" for the whole corpus
+    int GridWidth;
+    int Sequences;
+    int HeightSum; // Sum of the lowest stack heights of the sequences, which must not change between runs
+    uint64_t Nodes;
+    permutation_count Permutations;
+    double Seconds;
+} benchmark_result;
+
+// Advance the generator state 'state' and return its next pseudo-random number (xorshift64*). Used instead of rand() so that the corpus is the same with every C library
+uint64_t getNextBenchmarkRandom(uint64_t *state);
+
+// Fill 'sequence' with 'size' pieces dealt from shuffled bags of the pieces in BENCHMARK_BAG, using and advancing the generator state 'state'
+void generateBenchmarkSequence(uint64_t *state, char sequence[], int size);
+
+// Return the search tree nodes entered per second in 'result'
+double getBenchmarkNodesPerSecond(benchmark_result *result);
+
+// Return the pruning ratio of 'result': the number of permutations of its sequences accounted for by each search tree node entered. Higher means more of the search tree was pruned
+double getBenchmarkPruningRatio(benchmark_result *result);
+
+// Print the header of the benchmark results file to 'output'
+void printBenchmarkHeader(FILE *output);
+
+// Print 'result' to 'output' as one CSV line, with the speedup and parallel efficiency over 'singleThreadResult', the same group solved with one thread
+void printBenchmarkResult(FILE *output, benchmark_result *result, benchmark_result *singleThreadResult);
+
+// Parse the CSV line 'line' of a benchmark results file into 'result'. Return TRUE if it holds a result, FALSE otherwise
+int parseBenchmarkResult(const char *line, benchmark_result *result);
+
+// Solve the benchmark corpus in a grid BENCHMARK_GRID_WIDTH columns wide, in a solve context with the settings in 'solverSettings' and 'threads' solver threads, storing the results of each group in 'results'. Return the number of groups, or 0 if the context couldn't be created
+int runBenchmarkThreads(solver_settings *solverSettings, int threads, benchmark_result results[MAX_BENCHMARK_GROUPS]);
+
+// Compare 'result' with the result of the same group and thread count in 'baseline', 'baselineSize' results long, printing any differences larger than 'tolerance' percent. Return the number of regressions found
+int compareBenchmarkResult(benchmark_result *result, benchmark_result baseline[], int baselineSize, int tolerance);
+
+// Read the benchmark results file 'file' into a newly allocated array stored in 'baseline', and return the number of results read. Return -1 if it couldn't be read
+int readBenchmarkBaseline(const char *file, benchmark_result **baseline);
+
+// Solve the benchmark corpus in a grid BENCHMARK_GRID_WIDTH columns wide with 1 solver thread, doubling up to the number set in 'solverSettings', writing the results to its benchmark file and comparing them with its baseline file, if set. Return TRUE if the benchmark ran without regressions, FALSE otherwise
+int runBenchmark(solver_settings *solverSettings);
+
+#endif
@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "checkpoint.h"
+#include "input_utils.h"
+#include "scheduler.h"
+#include "solution_cache.h"
+#include "grid.h"
+
+// Return a hash of the column and rotation of every placement in the placement table of 'sequenceParams', in the order they are tried
+uint64_t getPlacementTableHash(sequence_params *sequenceParams)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    uint64_t hash = 0xCBF29CE484222325; // FNV-1a offset basis
+
+    for (int piece = 0; piece <= sequenceParams->Size; piece++)
+        hash = (hash ^ (uint64_t) placementTable->PieceFirstPlacements[piece]) * 0x100000001B3;
+
+    for (int placementIndex = 0; placementIndex < placementTable->PieceFirstPlacements[sequenceParams->Size]; placementIndex++)
+    {
+        hash = (hash ^ placementTable->Placements[placementIndex].Column) * 0x100000001B3;
+        hash = (hash ^ placementTable->Placements[placementIndex].Rotation) * 0x100000001B3;
+    }
+
+    return hash;
+}
+
+// Prepare 'checkpoint' for checkpointing the search of the sequence in 'sequenceParams' by the solvers set in 'solverSettings', reading the work left in the search from its checkpoint file if it is resumed.
+// Return TRUE if it was prepared, FALSE if it couldn't be allocated or the checkpoint file couldn't be read or is for another sequence
+int createSearchCheckpoint(search_checkpoint *checkpoint, solver_settings *solverSettings, sequence_params *sequenceParams)
+{
+    memset(checkpoint, 0, sizeof(search_checkpoint));
+    checkpoint->File = solverSettings->CheckpointFile;
+    checkpoint->Interval = solverSettings->CheckpointInterval;
+    checkpoint->BestStackHeight = GRID_HEIGHT;
+
+    if (solverSettings->ResumeCheckpoint == TRUE)
+    {
+        if (readCheckpointFile(checkpoint, solverSettings->CheckpointFile) == FALSE) return FALSE;
+
+        if (checkpoint->Size != sequenceParams->Size || checkpoint->AllowRotation != sequenceParams->AllowRotation || checkpoint->GridWidth != sequenceParams->GridWidth || memcmp(checkpoint->Sequence, sequenceParams->Sequence, sequenceParams->Size) != 0)
+        {
+            destroySearchCheckpoint(checkpoint);
+            return FALSE;
+        }
+    }
+
+    memcpy(checkpoint->Sequence, sequenceParams->Sequence, sequenceParams->Size);
+    checkpoint->Size = sequenceParams->Size;
+    checkpoint->AllowRotation = sequenceParams->AllowRotation;
+    checkpoint->GridWidth = sequenceParams->GridWidth;
+
+    // Each busy solver records at most one work item per node on its path, and the queue holds its donated and resumed work items
+    checkpoint->MaxItems = solverSettings->NumberOfSolvers * (MAX_SEQUENCE_SIZE + 1) + MAX_DONATED_ITEMS + checkpoint->ResumedItemCount;
+    checkpoint->Items = malloc(sizeof(work_item) * checkpoint->MaxItems);
+
+    if (checkpoint->Items == NULL)
+    {
+        destroySearchCheckpoint(checkpoint);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+// Free the work items held by 'checkpoint'
+void destroySearchCheckpoint(search_checkpoint *checkpoint)
+{
+    free(checkpoint->Items);
+    free(checkpoint->ResumedItems);
+    checkpoint->Items = NULL;
+    checkpoint->ResumedItems = NULL;
+}
+
+// Start a new checkpoint in 'checkpoint' holding the prefixes and work items left in 'workQueue', which must be locked. Each busy solver of 'workQueue' then records the work items it has left
+void beginCheckpoint(search_checkpoint *checkpoint, work_queue *workQueue)
+{
+    checkpoint->Generation++;
+    checkpoint->PendingSolvers = workQueue->BusySolvers;
+    checkpoint->PrefixLength = workQueue->PrefixLength;
+    checkpoint->NextPrefix = workQueue->NextPrefix;
+    checkpoint->ItemCount = 0;
+
+    for (int item = 0; item < workQueue->ResumedItemCount; item++) recordCheckpointItem(checkpoint, &workQueue->ResumedItems[item]);
+    for (int item = 0; item < workQueue->DonatedItemCount; item++) recordCheckpointItem(checkpoint, &workQueue->DonatedItems[item]);
+}
+
+// Add the work item 'item', left unsearched by a solver, to the current checkpoint in 'checkpoint'
+void recordCheckpointItem(search_checkpoint *checkpoint, work_item *item)
+{
+    if (checkpoint->ItemCount < checkpoint->MaxItems) checkpoint->Items[checkpoint->ItemCount++] = *item;
+}
+
+// Record the stack 'stackHeight', stacked by dropping each of the 'size' pieces into 'pieceColumns' in 'pieceRotations', in 'checkpoint' if it is lower than the one recorded
+void recordCheckpointSolution(search_checkpoint *checkpoint, int size, int stackHeight, int pieceColumns[], int pieceRotations[])
+{
+    if (stackHeight >= checkpoint->BestStackHeight) return;
+
+    checkpoint->BestStackHeight = stackHeight;
+    memcpy(checkpoint->BestPieceColumns, pieceColumns, sizeof(int) * size);
+    memcpy(checkpoint->BestPieceRotations, pieceRotations, sizeof(int) * size);
+}
+
+
+#ifdef _WIN32 // Windows implementation
+
+#include <windows.h>
+
+// Replace the file at 'path' with the file at 'newPath'. Return TRUE if it was replaced, FALSE otherwise
+int replaceFile(const char *newPath, const char *path)
+{
+    return MoveFileExA(newPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0 ? TRUE : FALSE;
+}
+
+
+#elif defined __linux__ // Linux implementation
+
+// Replace the file at 'path' with the file at 'newPath'. Return TRUE if it was replaced, FALSE otherwise
+int replaceFile(const char *newPath, const char *path)
+{
+    // Renaming over an existing file is atomic, so the file at 'path' always holds a whole checkpoint
+    return rename(newPath, path) == 0 ? TRUE : FALSE;
+}
+
+
+#else // Standard implementation
+
+// Replace the file at 'path' with the file at 'newPath'. Return TRUE if it was replaced, FALSE otherwise
+int replaceFile(const char *newPath, const char *path)
+{
+    // Standard C leaves renaming over an existing file undefined
+    remove(path);
+    return rename(newPath, path) == 0 ? TRUE : FALSE;
+}
+
+#endif
+
+// Write the current checkpoint in 'checkpoint' to its checkpoint file, replacing the previous checkpoint only once the whole checkpoint is written. Return TRUE if it was written, FALSE otherwise
+int writeCheckpointFile(search_checkpoint *checkpoint)
+{
+    checkpoint_header header = {0};
+    char *newPath = malloc(strlen(checkpoint->File) + sizeof(".new"));
+    FILE *output;
+    work_item *item;
+    unsigned char depth;
+    unsigned short children[2];
+    int written = TRUE;
+
+    if (newPath == NULL) return FALSE;
+    sprintf(newPath, "%s.new", checkpoint->File);
+
+    output = fopen(newPath, "wb");
+    if (output == NULL)
+    {
+        free(newPath);
+        return FALSE;
+    }
+
+    header.Magic = CHECKPOINT_MAGIC;
+    header.FormatVersion = CHECKPOINT_FORMAT_VERSION;
+    header.MaxSequenceSize = MAX_SEQUENCE_SIZE;
+    header.TetrominoHash = getTetrominoTableHash();
+    header.PlacementTableHash = checkpoint->PlacementTableHash;
+    header.NextPrefix = checkpoint->NextPrefix;
+    header.Size = checkpoint->Size;
+    header.AllowRotation = checkpoint->AllowRotation;
+    header.GridWidth = checkpoint->GridWidth;
+    header.PrefixLength = checkpoint->PrefixLength;
+    header.ItemCount = checkpoint->ItemCount;
+    header.BestStackHeight = checkpoint->BestStackHeight;
+    memcpy(header.Sequence, checkpoint->Sequence, checkpoint->Size);
+
+    for (int piece = 0; piece < checkpoint->Size && checkpoint->BestStackHeight < GRID_HEIGHT; piece++)
+    {
+        header.BestPieceColumns[piece] = (unsigned char) checkpoint->BestPieceColumns[piece];
+        header.BestPieceRotations[piece] = (unsigned char) checkpoint->BestPieceRotations[piece];
+    }
+
+    if (fwrite(&header, sizeof(header), 1, output) != 1) written = FALSE;
+
+    for (int itemIndex = 0; itemIndex < checkpoint->ItemCount && written == TRUE; itemIndex++)
+    {
+        item = &checkpoint->Items[itemIndex];
+        depth = (unsigned char) item->Depth;
+        children[0] = (unsigned short) item->FirstChild;
+        children[1] = (unsigned short) item->EndChild;
+
+        if (fwrite(&depth, 1, 1, output) != 1 || fwrite(children, sizeof(children), 1, output) != 1 || \
+            fwrite(item->Placements, sizeof(unsigned short), item->Depth, output) != (size_t) item->Depth) written = FALSE;
+    }
+
+    if (fclose(output) != 0) written = FALSE;
+    if (written == TRUE) written = replaceFile(newPath, checkpoint->File);
+    if (written == FALSE) remove(newPath);
+
+    free(newPath);
+    return written;
+}
+
+// Read the checkpoint file at 'path' into 'checkpoint', allocating its resumed work items. Return TRUE if it was read, FALSE if it couldn't be read or was written by a program with a different checkpoint layout or tetrominos
+int readCheckpointFile(search_checkpoint *checkpoint, const char *path)
+{
+    checkpoint_header header;
+    FILE *input = fopen(path, "rb");
+    work_item *item;
+    unsigned char depth;
+    unsigned short children[2];
+    int read = TRUE;
+
+    if (input == NULL) return FALSE;
+
+    if (fread(&header, sizeof(header), 1, input) != 1 || header.Magic != CHECKPOINT_MAGIC || header.FormatVersion != CHECKPOINT_FORMAT_VERSION || \
+        header.MaxSequenceSize != MAX_SEQUENCE_SIZE || header.TetrominoHash != getTetrominoTableHash() || header.Size < 1 || header.Size > MAX_SEQUENCE_SIZE || \
+        header.GridWidth < MIN_GRID_WIDTH || header.GridWidth > MAX_GRID_WIDTH || header.ItemCount < 0)
+    {
+        fclose(input);
+        return FALSE;
+    }
+
+    checkpoint->ResumedItems = malloc(sizeof(work_item) * (header.ItemCount > 0 ? header.ItemCount : 1));
+    if (checkpoint->ResumedItems == NULL)
+    {
+        fclose(input);
+        return FALSE;
+    }
+
+    for (int itemIndex = 0; itemIndex < header.ItemCount && read == TRUE; itemIndex++)
+    {
+        item = &checkpoint->ResumedItems[itemIndex];
+
+        if (fread(&depth, 1, 1, input) != 1 || depth >= header.Size || fread(children, sizeof(children), 1, input) != 1 || \
+            fread(item->Placements, sizeof(unsigned short), depth, input) != depth) read = FALSE;
+
+        item->Depth = depth;
+        item->FirstChild = children[0];
+        item->EndChild = children[1];
+    }
+
+    fclose(input);
+
+    if (read == FALSE)
+    {
+        free(checkpoint->ResumedItems);
+        checkpoint->ResumedItems = NULL;
+        return FALSE;
+    }
+
+    memcpy(checkpoint->Sequence, header.Sequence, header.Size);
+    checkpoint->Size = header.Size;
+    checkpoint->AllowRotation = header.AllowRotation;
+    checkpoint->GridWidth = header.GridWidth;
+    checkpoint->PlacementTableHash = header.PlacementTableHash;
+    checkpoint->PrefixLength = header.PrefixLength;
+    checkpoint->NextPrefix = header.NextPrefix;
+    checkpoint->BestStackHeight = header.BestStackHeight;
+    checkpoint->ResumedItemCount = header.ItemCount;
+    checkpoint->Resumed = TRUE;
+
+    for (int piece = 0; piece < header.Size; piece++)
+    {
+        checkpoint->BestPieceColumns[piece] = header.BestPieceColumns[piece];
+        checkpoint->BestPieceRotations[piece] = header.BestPieceRotations[piece];
+    }
+
+    return TRUE;
+}
+
+// Read the sequence the checkpoint file at 'path' is for into 'sequenceParams'. Return TRUE if it was read, FALSE otherwise
+int readCheckpointSequence(const char *path, sequence_params *sequenceParams)
+{
+    search_checkpoint checkpoint = {0};
+
+    if (readCheckpointFile(&checkpoint, path) == FALSE) return FALSE;
+
+    memcpy(sequenceParams->Sequence, checkpoint.Sequence, checkpoint.Size);
+    sequenceParams->Size = checkpoint.Size;
+    sequenceParams->AllowRotation = checkpoint.AllowRotation;
+    sequenceParams->GridWidth = checkpoint.GridWidth;
+    memset(&sequenceParams->Root, 0, sizeof(sequenceParams->Root));
+
+    destroySearchCheckpoint(&checkpoint);
+    return TRUE;
+}
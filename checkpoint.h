@@ -0,0 +1,98 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "scheduler.h"
+#include "tetromino.h"
+
+#define CHECKPOINT_MAGIC 0x54504B4843535354 // "TSSCHKPT" in little-endian byte order
+#define CHECKPOINT_FORMAT_VERSION 2 // Incremented whenever the layout of the checkpoint file, or the order in which placements are tried, changes
+#define DEFAULT_CHECKPOINT_INTERVAL 60 // Seconds
+
+typedef struct // Stores the header of a checkpoint file, followed by its work items. Each work item is stored as its depth (1 byte), first and end child (2 bytes each) and the placement of each piece in its prefix (2 bytes each)
+{
+    uint64_t Magic;
+    uint32_t FormatVersion;
+    uint32_t MaxSequenceSize;
+    uint64_t TetrominoHash;
+    uint64_t PlacementTableHash;
+    uint64_t NextPrefix;
+    int32_t Size;
+    int32_t AllowRotation;
+    int32_t GridWidth;
+    int32_t PrefixLength;
+    int32_t ItemCount;
+    int32_t BestStackHeight;
+    char Sequence[MAX_SEQUENCE_SIZE];
+    unsigned char BestPieceColumns[MAX_SEQUENCE_SIZE];
+    unsigned char BestPieceRotations[MAX_SEQUENCE_SIZE];
+} checkpoint_header;
+
+typedef struct // Stores the work left in a search, written to a checkpoint file periodically so that the search can be resumed once the process is stopped. Shared by all solvers, and written under the lock of their work queue
+{
+    const char *File;
+    double Interval; // Seconds between checkpoints
+    double NextCheckpointTime; // Wall clock time, as returned by getWallClockTime, at which the next checkpoint is started
+
+    // Stores the sequence the checkpoint is for and the width of its grid, and a hash of the order in which its placements are tried, so that placement indices are only resumed with the same placement table
+    char Sequence[MAX_SEQUENCE_SIZE];
+    int Size;
+    int AllowRotation;
+    int GridWidth;
+    uint64_t PlacementTableHash;
+
+    // Stores the prefixes which haven't been handed out and the work items left unsearched by the solvers, i.e. the work left in the search
+    int PrefixLength;
+    uint64_t NextPrefix;
+    work_item *Items;
+    int ItemCount;
+    int MaxItems;
+
+    // Stores the lowest stack recorded by any solver, and the column and rotation of each piece which stack to it. Kept between checkpoints
+    int BestStackHeight;
+    int BestPieceColumns[MAX_SEQUENCE_SIZE];
+    int BestPieceRotations[MAX_SEQUENCE_SIZE];
+
+    volatile int Generation; // Incremented each time a checkpoint is started. Polled by the solvers to check whether they have recorded their work in the current checkpoint
+    int PendingSolvers; // Number of busy solvers which haven't recorded their work in the current checkpoint
+
+    // Stores the work items read from the checkpoint file if the search is resumed. They are handed out by the work queue before any prefix
+    int Resumed;
+    work_item *ResumedItems;
+    int ResumedItemCount;
+} search_checkpoint;
+
+// Return a hash of the column and rotation of every placement in the placement table of 'sequenceParams', in the order they are tried
+uint64_t getPlacementTableHash(sequence_params *sequenceParams);
+
+// Prepare 'checkpoint' for checkpointing the search of the sequence in 'sequenceParams' by the solvers set in 'solverSettings', reading the work left in the search from its checkpoint file if it is resumed.
+// Return TRUE if it was prepared, FALSE if it couldn't be allocated or the checkpoint file couldn't be read or is for another sequence
+int createSearchCheckpoint(search_checkpoint *checkpoint, solver_settings *solverSettings, sequence_params *sequenceParams);
+
+// Free the work items held by 'checkpoint'
+void destroySearchCheckpoint(search_checkpoint *checkpoint);
+
+// Start a new checkpoint in 'checkpoint' holding the prefixes and work items left in 'workQueue', which must be locked. Each busy solver of 'workQueue' then records the work items it has left
+void beginCheckpoint(search_checkpoint *checkpoint, work_queue *workQueue);
+
+// Add the work item 'item', left unsearched by a solver, to the current checkpoint in 'checkpoint'
+void recordCheckpointItem(search_checkpoint *checkpoint, work_item *item);
+
+// Record the stack 'stackHeight', stacked by dropping each of the 'size' pieces into 'pieceColumns' in 'pieceRotations', in 'checkpoint' if it is lower than the one recorded
+void recordCheckpointSolution(search_checkpoint *checkpoint, int size, int stackHeight, int pieceColumns[], int pieceRotations[]);
+
+// Replace the file at 'path' with the file at 'newPath'. Return TRUE if it was replaced, FALSE otherwise
+int replaceFile(const char *newPath, const char *path);
+
+// Write the current checkpoint in 'checkpoint' to its checkpoint file, replacing the previous checkpoint only once the whole checkpoint is written. Return TRUE if it was written, FALSE otherwise
+int writeCheckpointFile(search_checkpoint *checkpoint);
+
+// Read the checkpoint file at 'path' into 'checkpoint', allocating its resumed work items. Return TRUE if it was read, FALSE if it couldn't be read or was written by a program with a different checkpoint layout or tetrominos
+int readCheckpointFile(search_checkpoint *checkpoint, const char *path);
+
+// Read the sequence the checkpoint file at 'path' is for into 'sequenceParams'. Return TRUE if it was read, FALSE otherwise
+int readCheckpointSequence(const char *path, sequence_params *sequenceParams);
+
+#endif
@@ -5,12 +5,13 @@
 #include "input_utils.h"
 #include "grid.h"
 #include "tetromino.h"
+#include "skyline.h"
 
-// Runs debug mode, allowing the user to drop tetrominos onto a grid
-void debugMode()
+// Runs debug mode, allowing the user to drop tetrominos onto a grid 'gridWidth' columns wide
+void debugMode(int gridWidth)
 {
-    char grid[GRID_HEIGHT][GRID_WIDTH];    
-    int gridColumnHeights[GRID_WIDTH];
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];    
+    skyline gridSkyline = EMPTY_SKYLINE;
 
     char tet;
     int droppedColumn;
@@ -18,20 +19,19 @@ void debugMode()
     char input;
 
     memset(grid, '_', sizeof(grid));
-    memset(gridColumnHeights, 0, sizeof(gridColumnHeights));
 
-    printGrid(grid);
+    printGrid(grid, gridWidth);
 
     while (TRUE)
     {
         tet = getTetrominoToDrop();
         rotation = getRotation(tet);
-        droppedColumn = getColumnToDropIn(getTetromino(tet, rotation)->Width);
+        droppedColumn = getColumnToDropIn(getTetromino(tet, rotation)->Width, gridWidth);
 
-        if (dropTetrominoToGrid(getTetromino(tet, rotation), droppedColumn, grid, gridColumnHeights) == FALSE)
+        if (dropTetrominoToGrid(getTetromino(tet, rotation), droppedColumn, grid, &gridSkyline) == FALSE)
             printf("Not enough space! Clear the grid or try another tetromino/column\n\n");            
         
-        else printGrid(grid);        
+        else printGrid(grid, gridWidth);        
         
         input = getDebugMenuInput();
         switch(input)
@@ -40,8 +40,8 @@ void debugMode()
                 break;
             case '2':
                 memset(grid, '_', sizeof(grid));
-                memset(gridColumnHeights, 0, sizeof(gridColumnHeights));
-                printGrid(grid);
+                gridSkyline = EMPTY_SKYLINE;
+                printGrid(grid, gridWidth);
                 break;
             case '3':
                 return;
@@ -1,7 +1,7 @@
 #ifndef DEBUG_H
 #define DEBUG_H
 
-// Runs debug mode, allowing the user to drop tetrominos onto a grid
-void debugMode();
+// Runs debug mode, allowing the user to drop tetrominos onto a grid 'gridWidth' columns wide
+void debugMode(int gridWidth);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,1245 @@
+#ifdef __linux__
+#define _GNU_SOURCE // Required for the socket address routines and nanosleep in strict ISO modes
+#endif
+
+#ifdef _WIN32
+#include <winsock2.h> // Must be included before windows.h, which the headers below include
+#include <ws2tcpip.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "bool.h"
+#include "distributed.h"
+#include "input_utils.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "scheduler.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+#include "tetromino.h"
+#include "grid.h"
+#include "skyline.h"
+#include "thread_utils.h"
+
+
+#ifdef _WIN32 // Windows implementation (Winsock)
+
+#pragma comment(lib, "Ws2_32.lib")
+
+// Prepare the networking routines of the platform before the first socket is opened. Return TRUE if they were prepared, FALSE otherwise
+int startNetworking()
+{
+    WSADATA winsockData;
+
+    return WSAStartup(MAKEWORD(2, 2), &winsockData) == 0 ? TRUE : FALSE;
+}
+
+// Release the networking routines of the platform once every socket is closed
+void stopNetworking()
+{
+    WSACleanup();
+}
+
+// Return a socket listening for connections on TCP port 'port' of every address of the host, or NO_NODE_SOCKET if it couldn't be opened
+node_socket listenOnPort(int port)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo *addresses;
+    char service[16];
+    SOCKET listener = INVALID_SOCKET;
+    BOOL enabled = TRUE;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(NULL, service, &hints, &addresses) != 0) return NO_NODE_SOCKET;
+
+    for (struct addrinfo *address = addresses; address != NULL && listener == INVALID_SOCKET; address = address->ai_next)
+    {
+        listener = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (listener == INVALID_SOCKET) continue;
+
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char *) &enabled, sizeof(enabled));
+
+        if (bind(listener, address->ai_addr, (int) address->ai_addrlen) != 0 || listen(listener, SOMAXCONN) != 0)
+        {
+            closesocket(listener);
+            listener = INVALID_SOCKET;
+        }
+    }
+
+    freeaddrinfo(addresses);
+    return listener == INVALID_SOCKET ? NO_NODE_SOCKET : (node_socket) listener;
+}
+
+// Return a socket connected to TCP port 'port' of 'host', or NO_NODE_SOCKET if it couldn't connect
+node_socket connectToNode(const char *host, int port)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo *addresses;
+    char service[16];
+    SOCKET nodeSocket = INVALID_SOCKET;
+    BOOL enabled = TRUE;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) return NO_NODE_SOCKET;
+
+    for (struct addrinfo *address = addresses; address != NULL && nodeSocket == INVALID_SOCKET; address = address->ai_next)
+    {
+        nodeSocket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (nodeSocket == INVALID_SOCKET) continue;
+
+        if (connect(nodeSocket, address->ai_addr, (int) address->ai_addrlen) != 0)
+        {
+            closesocket(nodeSocket);
+            nodeSocket = INVALID_SOCKET;
+        }
+    }
+
+    freeaddrinfo(addresses);
+    if (nodeSocket == INVALID_SOCKET) return NO_NODE_SOCKET;
+
+    // Messages are short lines, each waited for by the other process
+    setsockopt(nodeSocket, IPPROTO_TCP, TCP_NODELAY, (const char *) &enabled, sizeof(enabled));
+    return (node_socket) nodeSocket;
+}
+
+// Return a socket connected to the next process connecting to 'listener', or NO_NODE_SOCKET if its connection failed
+node_socket acceptNode(node_socket listener)
+{
+    SOCKET nodeSocket = accept((SOCKET) listener, NULL, NULL);
+    BOOL enabled = TRUE;
+
+    if (nodeSocket == INVALID_SOCKET) return NO_NODE_SOCKET;
+
+    setsockopt(nodeSocket, IPPROTO_TCP, TCP_NODELAY, (const char *) &enabled, sizeof(enabled));
+    return (node_socket) nodeSocket;
+}
+
+// Close 'nodeSocket'
+void closeNode(node_socket nodeSocket)
+{
+    closesocket((SOCKET) nodeSocket);
+}
+
+// Send the 'length' bytes in 'data' through 'nodeSocket', blocking until they are all sent. Return TRUE if they were sent, FALSE if the connection is lost
+int sendToNode(node_socket nodeSocket, const char *data, int length)
+{
+    int sent;
+
+    while (length > 0)
+    {
+        sent = send((SOCKET) nodeSocket, data, length, 0);
+        if (sent == SOCKET_ERROR) return FALSE;
+
+        data += sent;
+        length -= sent;
+    }
+
+    return TRUE;
+}
+
+// Receive at most 'capacity' bytes from 'nodeSocket' into 'buffer', blocking until some arrive. Return the number of bytes received, or 0 if the connection is closed or lost
+int receiveFromNode(node_socket nodeSocket, char *buffer, int capacity)
+{
+    int received = recv((SOCKET) nodeSocket, buffer, capacity, 0);
+
+    return received == SOCKET_ERROR ? 0 : received;
+}
+
+// Wait at most 'seconds' seconds for any of the 'count' sockets in 'sockets' to have data to receive or a connection to accept, setting each entry of 'readable' to TRUE if its socket has. Return TRUE if any has, FALSE otherwise
+int waitForNodes(node_socket sockets[], int count, double seconds, int readable[])
+{
+    fd_set readableSockets;
+    struct timeval timeout;
+
+    FD_ZERO(&readableSockets);
+    for (int nodeSocket = 0; nodeSocket < count; nodeSocket++) FD_SET((SOCKET) sockets[nodeSocket], &readableSockets);
+
+    timeout.tv_sec = (long) seconds;
+    timeout.tv_usec = (long) ((seconds - (long) seconds) * 1e6);
+
+    // The first argument is ignored by Winsock
+    if (select(0, &readableSockets, NULL, NULL, &timeout) <= 0) return FALSE;
+
+    for (int nodeSocket = 0; nodeSocket < count; nodeSocket++) readable[nodeSocket] = FD_ISSET((SOCKET) sockets[nodeSocket], &readableSockets) ? TRUE : FALSE;
+    return TRUE;
+}
+
+// Block the calling thread for 'seconds' seconds
+void sleepSeconds(double seconds)
+{
+    Sleep((DWORD) (seconds * 1000));
+}
+
+
+#elif defined __linux__ // Linux implementation (BSD sockets)
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// Prepare the networking routines of the platform before the first socket is opened. Return TRUE if they were prepared, FALSE otherwise
+int startNetworking()
+{
+    return TRUE;
+}
+
+// Release the networking routines of the platform once every socket is closed
+void stopNetworking()
+{
+}
+
+// Return a socket listening for connections on TCP port 'port' of every address of the host, or NO_NODE_SOCKET if it couldn't be opened
+node_socket listenOnPort(int port)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo *addresses;
+    char service[16];
+    int listener = NO_NODE_SOCKET;
+    int enabled = 1;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(NULL, service, &hints, &addresses) != 0) return NO_NODE_SOCKET;
+
+    for (struct addrinfo *address = addresses; address != NULL && listener == NO_NODE_SOCKET; address = address->ai_next)
+    {
+        listener = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (listener == NO_NODE_SOCKET) continue;
+
+        // A coordinator restarted on the same port needn't wait for the connections of the last one to time out
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+        if (bind(listener, address->ai_addr, address->ai_addrlen) != 0 || listen(listener, SOMAXCONN) != 0)
+        {
+            close(listener);
+            listener = NO_NODE_SOCKET;
+        }
+    }
+
+    freeaddrinfo(addresses);
+    return listener;
+}
+
+// Return a socket connected to TCP port 'port' of 'host', or NO_NODE_SOCKET if it couldn't connect
+node_socket connectToNode(const char *host, int port)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo *addresses;
+    char service[16];
+    int nodeSocket = NO_NODE_SOCKET;
+    int enabled = 1;
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) return NO_NODE_SOCKET;
+
+    for (struct addrinfo *address = addresses; address != NULL && nodeSocket == NO_NODE_SOCKET; address = address->ai_next)
+    {
+        nodeSocket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (nodeSocket == NO_NODE_SOCKET) continue;
+
+        if (connect(nodeSocket, address->ai_addr, address->ai_addrlen) != 0)
+        {
+            close(nodeSocket);
+            nodeSocket = NO_NODE_SOCKET;
+        }
+    }
+
+    freeaddrinfo(addresses);
+    if (nodeSocket == NO_NODE_SOCKET) return NO_NODE_SOCKET;
+
+    // Messages are short lines, each waited for by the other process
+    setsockopt(nodeSocket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    return nodeSocket;
+}
+
+// Return a socket connected to the next process connecting to 'listener', or NO_NODE_SOCKET if its connection failed
+node_socket acceptNode(node_socket listener)
+{
+    int nodeSocket = accept(listener, NULL, NULL);
+    int enabled = 1;
+
+    if (nodeSocket == NO_NODE_SOCKET) return NO_NODE_SOCKET;
+
+    setsockopt(nodeSocket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    return nodeSocket;
+}
+
+// Close 'nodeSocket'
+void closeNode(node_socket nodeSocket)
+{
+    close(nodeSocket);
+}
+
+// Send the 'length' bytes in 'data' through 'nodeSocket', blocking until they are all sent. Return TRUE if they were sent, FALSE if the connection is lost
+int sendToNode(node_socket nodeSocket, const char *data, int length)
+{
+    ssize_t sent;
+
+    while (length > 0)
+    {
+        // A lost connection is reported by the return value rather than SIGPIPE, which would end the process
+        sent = send(nodeSocket, data, (size_t) length, MSG_NOSIGNAL);
+
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0) return FALSE;
+
+        data += sent;
+        length -= (int) sent;
+    }
+
+    return TRUE;
+}
+
+// Receive at most 'capacity' bytes from 'nodeSocket' into 'buffer', blocking until some arrive. Return the number of bytes received, or 0 if the connection is closed or lost
+int receiveFromNode(node_socket nodeSocket, char *buffer, int capacity)
+{
+    ssize_t received;
+
+    do received = recv(nodeSocket, buffer, (size_t) capacity, 0);
+    while (received < 0 && errno == EINTR);
+
+    return received < 0 ? 0 : (int) received;
+}
+
+// Wait at most 'seconds' seconds for any of the 'count' sockets in 'sockets' to have data to receive or a connection to accept, setting each entry of 'readable' to TRUE if its socket has. Return TRUE if any has, FALSE otherwise
+int waitForNodes(node_socket sockets[], int count, double seconds, int readable[])
+{
+    fd_set readableSockets;
+    struct timeval timeout;
+    int maxSocket = -1;
+
+    FD_ZERO(&readableSockets);
+
+    for (int nodeSocket = 0; nodeSocket < count; nodeSocket++)
+    {
+        FD_SET(sockets[nodeSocket], &readableSockets);
+        if (sockets[nodeSocket] > maxSocket) maxSocket = sockets[nodeSocket];
+    }
+
+    timeout.tv_sec = (time_t) seconds;
+    timeout.tv_usec = (suseconds_t) ((seconds - (time_t) seconds) * 1e6);
+
+    // Interrupted waits return early, as the caller checks what it is waiting for again
+    if (select(maxSocket + 1, &readableSockets, NULL, NULL, &timeout) <= 0) return FALSE;
+
+    for (int nodeSocket = 0; nodeSocket < count; nodeSocket++) readable[nodeSocket] = FD_ISSET(sockets[nodeSocket], &readableSockets) ? TRUE : FALSE;
+    return TRUE;
+}
+
+// Block the calling thread for 'seconds' seconds
+void sleepSeconds(double seconds)
+{
+    struct timespec duration;
+
+    duration.tv_sec = (time_t) seconds;
+    duration.tv_nsec = (long) ((seconds - (time_t) seconds) * 1e9);
+
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR);
+}
+
+
+#else // Standard implementation (no networking, distributed solving isn't supported)
+
+// Prepare the networking routines of the platform before the first socket is opened. Return TRUE if they were prepared, FALSE otherwise
+int startNetworking()
+{
+    return FALSE;
+}
+
+// Release the networking routines of the platform once every socket is closed
+void stopNetworking()
+{
+}
+
+// Return a socket listening for connections on TCP port 'port' of every address of the host, or NO_NODE_SOCKET if it couldn't be opened
+node_socket listenOnPort(int port)
+{
+    (void) port;
+    return NO_NODE_SOCKET;
+}
+
+// Return a socket connected to TCP port 'port' of 'host', or NO_NODE_SOCKET if it couldn't connect
+node_socket connectToNode(const char *host, int port)
+{
+    (void) host;
+    (void) port;
+    return NO_NODE_SOCKET;
+}
+
+// Return a socket connected to the next process connecting to 'listener', or NO_NODE_SOCKET if its connection failed
+node_socket acceptNode(node_socket listener)
+{
+    (void) listener;
+    return NO_NODE_SOCKET;
+}
+
+// Close 'nodeSocket'
+void closeNode(node_socket nodeSocket)
+{
+    (void) nodeSocket;
+}
+
+// Send the 'length' bytes in 'data' through 'nodeSocket', blocking until they are all sent. Return TRUE if they were sent, FALSE if the connection is lost
+int sendToNode(node_socket nodeSocket, const char *data, int length)
+{
+    (void) nodeSocket;
+    (void) data;
+    (void) length;
+    return FALSE;
+}
+
+// Receive at most 'capacity' bytes from 'nodeSocket' into 'buffer', blocking until some arrive. Return the number of bytes received, or 0 if the connection is closed or lost
+int receiveFromNode(node_socket nodeSocket, char *buffer, int capacity)
+{
+    (void) nodeSocket;
+    (void) buffer;
+    (void) capacity;
+    return 0;
+}
+
+// Wait at most 'seconds' seconds for any of the 'count' sockets in 'sockets' to have data to receive or a connection to accept, setting each entry of 'readable' to TRUE if its socket has. Return TRUE if any has, FALSE otherwise
+int waitForNodes(node_socket sockets[], int count, double seconds, int readable[])
+{
+    (void) sockets;
+    (void) count;
+    (void) seconds;
+    (void) readable;
+    return FALSE;
+}
+
+// Block the calling thread for 'seconds' seconds
+void sleepSeconds(double seconds)
+{
+    double endTime = getWallClockTime() + seconds;
+
+    while (getWallClockTime() < endTime);
+}
+
+#endif
+
+// Start 'connection' on the connected socket 'nodeSocket', with no bytes received yet
+void initialiseNodeConnection(node_connection *connection, node_socket nodeSocket)
+{
+    connection->Socket = nodeSocket;
+    connection->Length = 0;
+}
+
+// Send the line formatted from 'format' and the arguments after it, which must end with a newline, through 'connection'. Return TRUE if it was sent, FALSE if the connection is lost or the line is too long
+int sendNodeLine(node_connection *connection, const char *format, ...)
+{
+    char line[MAX_NODE_LINE_LENGTH];
+    va_list arguments;
+    int length;
+
+    va_start(arguments, format);
+    length = vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+
+    if (length < 0 || length >= MAX_NODE_LINE_LENGTH) return FALSE;
+    return sendToNode(connection->Socket, line, length);
+}
+
+// Receive the bytes waiting in 'connection', blocking until some arrive. Return TRUE if any were received, FALSE if the connection is closed or lost, or its buffer is full without holding a whole line
+int receiveNodeData(node_connection *connection)
+{
+    int received;
+
+    if (connection->Length == NODE_BUFFER_SIZE) return FALSE;
+
+    received = receiveFromNode(connection->Socket, connection->Buffer + connection->Length, NODE_BUFFER_SIZE - connection->Length);
+    if (received == 0) return FALSE;
+
+    connection->Length += received;
+    return TRUE;
+}
+
+// Move the next whole line received from 'connection' into 'line', without its newline. Return NODE_LINE_READ if a line was read, NODE_LINE_NONE if no whole line has been received, or NODE_LINE_INVALID if the line is too long
+int getNodeLine(node_connection *connection, char line[MAX_NODE_LINE_LENGTH])
+{
+    char *newline = memchr(connection->Buffer, '\n', (size_t) connection->Length);
+    int lineLength;
+
+    if (newline == NULL) return connection->Length >= MAX_NODE_LINE_LENGTH ? NODE_LINE_INVALID : NODE_LINE_NONE;
+
+    lineLength = (int) (newline - connection->Buffer);
+    if (lineLength >= MAX_NODE_LINE_LENGTH) return NODE_LINE_INVALID;
+
+    memcpy(line, connection->Buffer, (size_t) lineLength);
+    if (lineLength > 0 && line[lineLength - 1] == '\r') lineLength--;
+    line[lineLength] = '\0';
+
+    // The bytes after the line are kept for the next one
+    connection->Length -= (int) (newline + 1 - connection->Buffer);
+    memmove(connection->Buffer, newline + 1, (size_t) connection->Length);
+
+    return NODE_LINE_READ;
+}
+
+// Return the height of the stack the 'size' pieces in 'sequence', dropped into a grid 'gridWidth' columns wide with rotations if 'allowRotation' is TRUE, reach at the columns and rotation indices in 'pieceColumns' and 'pieceRotations', or -1 if any placement is outside the grid or the stack overflows it
+int getPlacedStackHeight(const char *sequence, int size, int allowRotation, int gridWidth, const int pieceColumns[], const int pieceRotations[])
+{
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    skyline gridSkyline = EMPTY_SKYLINE;
+    tetromino *tet;
+
+    memset(grid, '_', sizeof(grid));
+
+    for (int piece = 0; piece < size; piece++)
+    {
+        if (pieceRotations[piece] < 0 || pieceRotations[piece] >= (allowRotation == TRUE ? getRotations(sequence[piece]) : 1)) return -1;
+        tet = getTetromino(sequence[piece], pieceRotations[piece]);
+
+        if (pieceColumns[piece] < 0 || pieceColumns[piece] > gridWidth - tet->Width) return -1;
+        if (dropTetrominoToGrid(tet, pieceColumns[piece], grid, &gridSkyline) == FALSE) return -1;
+    }
+
+    return getStackHeight(gridSkyline);
+}
+
+// Start a coordinator handing out the sequences of a batch to workers connecting to the port set in 'solverSettings'. Return the coordinator, or NULL if it couldn't be allocated or the port couldn't be listened on
+distributed_coordinator *startCoordinator(solver_settings *solverSettings)
+{
+    distributed_coordinator *coordinator = malloc(sizeof(distributed_coordinator));
+
+    if (coordinator == NULL) return NULL;
+
+    if (startNetworking() == FALSE)
+    {
+        free(coordinator);
+        return NULL;
+    }
+
+    coordinator->Listener = listenOnPort(solverSettings->CoordinatorPort);
+
+    if (coordinator->Listener == NO_NODE_SOCKET)
+    {
+        stopNetworking();
+        free(coordinator);
+        return NULL;
+    }
+
+    coordinator->SolverSettings = *solverSettings;
+    coordinator->WorkerCount = 0;
+    coordinator->ConnectedWorkers = 0;
+    coordinator->WaitedForWorkers = FALSE;
+    coordinator->SequenceID = 0;
+    coordinator->Searching = FALSE;
+
+    return coordinator;
+}
+
+// Tell the workers of 'coordinator' that the batch is finished, then close their connections and free the coordinator
+void stopCoordinator(distributed_coordinator *coordinator)
+{
+    for (int worker = 0; worker < coordinator->WorkerCount; worker++)
+    {
+        sendNodeLine(&coordinator->Workers[worker].Connection, "QUIT\n");
+        closeNode(coordinator->Workers[worker].Connection.Socket);
+    }
+
+    closeNode(coordinator->Listener);
+    stopNetworking();
+    free(coordinator);
+}
+
+// Accept the worker connecting to 'coordinator', turning it away if MAX_WORKERS workers are connected
+void acceptWorker(distributed_coordinator *coordinator)
+{
+    node_socket nodeSocket = acceptNode(coordinator->Listener);
+    coordinator_worker *worker;
+
+    if (nodeSocket == NO_NODE_SOCKET) return;
+
+    if (coordinator->WorkerCount == MAX_WORKERS)
+    {
+        fprintf(stderr, "Turned a worker away, as %d workers are connected\n", MAX_WORKERS);
+        closeNode(nodeSocket);
+        return;
+    }
+
+    // The worker is only sent work once it has introduced itself
+    worker = &coordinator->Workers[coordinator->WorkerCount++];
+    initialiseNodeConnection(&worker->Connection, nodeSocket);
+    worker->Number = ++coordinator->ConnectedWorkers;
+    worker->Threads = 0;
+    worker->SequenceID = -1;
+    worker->HasUnit = FALSE;
+    worker->LeftReason = NULL;
+}
+
+// Mark the workers of 'coordinator' which hold a unit but have sent nothing for WORKER_TIMEOUT seconds as left, as they hung or their connection was lost without being closed
+void markHungWorkers(distributed_coordinator *coordinator)
+{
+    double time = getWallClockTime();
+
+    // A worker searching a unit sends a line every WORKER_KEEPALIVE_INTERVAL seconds, so one which sends nothing for much longer would hold its unit forever
+    for (int worker = 0; worker < coordinator->WorkerCount; worker++)
+    {
+        if (coordinator->Workers[worker].HasUnit == TRUE && coordinator->Workers[worker].LeftReason == NULL && time - coordinator->Workers[worker].LastHeardTime > WORKER_TIMEOUT)
+            coordinator->Workers[worker].LeftReason = "Sent nothing while holding a unit for too long";
+    }
+}
+
+// Close the connections of the workers of 'coordinator' which left, and return the units they held to be handed out again
+void dropLeftWorkers(distributed_coordinator *coordinator)
+{
+    coordinator_worker *worker;
+
+    // The last worker is moved into the place of each worker dropped, so workers are dropped from the last
+    for (int leftWorker = coordinator->WorkerCount - 1; leftWorker >= 0; leftWorker--)
+    {
+        worker = &coordinator->Workers[leftWorker];
+        if (worker->LeftReason == NULL) continue;
+
+        fprintf(stderr, "Worker %d left: %s%s\n", worker->Number, worker->LeftReason, worker->HasUnit == TRUE ? ". Its unit is handed out again" : "");
+
+        if (worker->HasUnit == TRUE)
+        {
+            coordinator->ReturnedFirstPrefixes[coordinator->ReturnedUnitCount] = worker->UnitFirstPrefix;
+            coordinator->ReturnedEndPrefixes[coordinator->ReturnedUnitCount] = worker->UnitEndPrefix;
+            coordinator->ReturnedUnitCount++;
+        }
+
+        closeNode(worker->Connection.Socket);
+        *worker = coordinator->Workers[--coordinator->WorkerCount];
+    }
+}
+
+// Send the sequence being solved by 'coordinator' to worker 'worker' to prepare its solvers for. Return TRUE if it was sent, FALSE if the worker left
+int sendWorkerSequence(distributed_coordinator *coordinator, int worker)
+{
+    sequence_params *sequenceParams = &coordinator->SequenceParams;
+
+    if (sendNodeLine(&coordinator->Workers[worker].Connection, "SEQUENCE %d %.*s %c %d %d\n", coordinator->SequenceID, sequenceParams->Size, sequenceParams->Sequence, \
+                     sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, coordinator->PrefixLength) == TRUE) return TRUE;
+
+    coordinator->Workers[worker].LeftReason = "Connection lost";
+    return FALSE;
+}
+
+// Send the lowest stack height found by any worker of 'coordinator' to every worker searching a unit, so that they prune with it
+void broadcastStackHeight(distributed_coordinator *coordinator)
+{
+    coordinator_worker *worker;
+
+    // Workers without a unit are sent it with their next unit
+    for (int unitWorker = 0; unitWorker < coordinator->WorkerCount; unitWorker++)
+    {
+        worker = &coordinator->Workers[unitWorker];
+
+        if (worker->HasUnit == TRUE && worker->LeftReason == NULL && \
+            sendNodeLine(&worker->Connection, "BOUND %d %d\n", coordinator->SequenceID, coordinator->StackHeight) == FALSE) worker->LeftReason = "Connection lost";
+    }
+}
+
+// Handle the line 'line' received by 'coordinator' from worker 'worker'. Return TRUE if it was handled, FALSE if the worker left as it sent a line it shouldn't have
+int handleWorkerLine(distributed_coordinator *coordinator, int worker, char *line)
+{
+    sequence_params *sequenceParams = &coordinator->SequenceParams;
+    coordinator_worker *sender = &coordinator->Workers[worker];
+    int version, threads, sequenceID, unitID, status, stackHeight, lowerBound, consumed;
+    unsigned long long placementTableHash, nodes;
+    int pieceColumns[MAX_SEQUENCE_SIZE];
+    int pieceRotations[MAX_SEQUENCE_SIZE];
+    char *text;
+
+    // A worker introduces itself once, and is sent the sequence being solved if it joined during its search
+    if (sscanf(line, "HELLO %d %d", &version, &threads) == 2 && sender->Threads == 0)
+    {
+        if (version != DISTRIBUTED_PROTOCOL_VERSION)
+        {
+            sender->LeftReason = "Speaks another protocol version";
+            return FALSE;
+        }
+
+        if (threads < 1 || threads > MAX_SOLVERS)
+        {
+            sender->LeftReason = "Sent an invalid number of solver threads";
+            return FALSE;
+        }
+
+        sender->Threads = threads;
+        fprintf(stderr, "Worker %d joined with %d solver thread(s)\n", sender->Number, threads);
+
+        return coordinator->Searching == TRUE ? sendWorkerSequence(coordinator, worker) : TRUE;
+    }
+
+    if (sender->Threads == 0)
+    {
+        sender->LeftReason = "Sent a message before introducing itself";
+        return FALSE;
+    }
+
+    // Sent while a unit is searched, only to show the worker is still running
+    if (sscanf(line, "ALIVE %d %d", &sequenceID, &unitID) == 2) return TRUE;
+
+    // A worker may finish preparing a sequence whose search finished before it was handed a unit
+    if (sscanf(line, "READY %d %llu", &sequenceID, &placementTableHash) == 2)
+    {
+        if (coordinator->Searching == FALSE || sequenceID != coordinator->SequenceID) return TRUE;
+
+        // Placement indices only stand for the same placements in a placement table built the same way, otherwise its prefixes are different parts of the search tree
+        if (placementTableHash != coordinator->PlacementTableHash)
+        {
+            sender->LeftReason = "Built another placement table for the sequence, it may run another build";
+            return FALSE;
+        }
+
+        sender->SequenceID = sequenceID;
+        return TRUE;
+    }
+
+    // The placements are checked, so that a faulty worker can't lower the stack height every worker prunes with
+    if (sscanf(line, "FOUND %d %d%n", &sequenceID, &stackHeight, &consumed) == 2 && coordinator->Searching == TRUE && sequenceID == coordinator->SequenceID)
+    {
+        text = line + consumed;
+
+        for (int piece = 0; piece < sequenceParams->Size; piece++)
+        {
+            if (sscanf(text, "%d %d%n", &pieceColumns[piece], &pieceRotations[piece], &consumed) != 2)
+            {
+                sender->LeftReason = "Sent a stack without the placement of every piece";
+                return FALSE;
+            }
+
+            text += consumed;
+        }
+
+        if (getPlacedStackHeight(sequenceParams->Sequence, sequenceParams->Size, sequenceParams->AllowRotation, sequenceParams->GridWidth, pieceColumns, pieceRotations) != stackHeight)
+        {
+            sender->LeftReason = "Sent placements which don't stack to the height it found";
+            return FALSE;
+        }
+
+        if (stackHeight < coordinator->StackHeight)
+        {
+            coordinator->StackHeight = stackHeight;
+            memcpy(coordinator->PieceColumns, pieceColumns, sizeof(pieceColumns));
+            memcpy(coordinator->PieceRotations, pieceRotations, sizeof(pieceRotations));
+            broadcastStackHeight(coordinator);
+        }
+
+        return TRUE;
+    }
+
+    // A unit stopped before it was finished leaves the lowest stack height its worker didn't rule out in it
+    if (sscanf(line, "DONE %d %d %d %d %llu", &sequenceID, &unitID, &status, &lowerBound, &nodes) == 5 && coordinator->Searching == TRUE && \
+        sequenceID == coordinator->SequenceID && sender->HasUnit == TRUE && unitID == sender->UnitID)
+    {
+        sender->HasUnit = FALSE;
+        coordinator->Nodes += nodes;
+
+        if (status == SOLVE_OK) coordinator->SearchedPrefixes += sender->UnitEndPrefix - sender->UnitFirstPrefix;
+        else if (lowerBound < coordinator->StoppedBound) coordinator->StoppedBound = lowerBound;
+
+        return TRUE;
+    }
+
+    sender->LeftReason = "Sent a message it shouldn't have";
+    return FALSE;
+}
+
+// Wait at most 'seconds' seconds for messages to 'coordinator', then accept the workers connecting and handle the lines received from each worker, marking those whose connection was lost as left
+void pollWorkers(distributed_coordinator *coordinator, double seconds)
+{
+    node_socket sockets[MAX_WORKERS + 1];
+    int readable[MAX_WORKERS + 1];
+    int workerCount = coordinator->WorkerCount;
+    char line[MAX_NODE_LINE_LENGTH];
+    node_connection *connection;
+    int lineRead;
+
+    // The listener is waited on with the workers, so that workers can join at any time
+    sockets[0] = coordinator->Listener;
+    for (int worker = 0; worker < workerCount; worker++) sockets[worker + 1] = coordinator->Workers[worker].Connection.Socket;
+
+    if (waitForNodes(sockets, workerCount + 1, seconds, readable) == FALSE) return;
+
+    for (int worker = 0; worker < workerCount; worker++)
+    {
+        connection = &coordinator->Workers[worker].Connection;
+        if (readable[worker + 1] == FALSE || coordinator->Workers[worker].LeftReason != NULL) continue;
+
+        if (receiveNodeData(connection) == FALSE)
+        {
+            coordinator->Workers[worker].LeftReason = "Connection lost";
+            continue;
+        }
+
+        coordinator->Workers[worker].LastHeardTime = getWallClockTime();
+        while ((lineRead = getNodeLine(connection, line)) == NODE_LINE_READ && handleWorkerLine(coordinator, worker, line) == TRUE);
+        if (lineRead == NODE_LINE_INVALID) coordinator->Workers[worker].LeftReason = "Sent a line longer than the protocol allows";
+    }
+
+    if (readable[0] == TRUE) acceptWorker(coordinator);
+}
+
+// Hand the next unit of work of the sequence being solved by 'coordinator' to worker 'worker', which must have prepared its solvers for the sequence and hold no unit. Return TRUE if a unit was handed out, FALSE if none are left or the worker left
+int assignWorkUnit(distributed_coordinator *coordinator, int worker)
+{
+    coordinator_worker *receiver = &coordinator->Workers[worker];
+    uint64_t remainingPrefixes = coordinator->Prefixes - coordinator->NextPrefix;
+    uint64_t unitPrefixes;
+    int preparedThreads = 0;
+
+    if (coordinator->Stopped == TRUE) return FALSE;
+
+    if (coordinator->ReturnedUnitCount > 0)
+    {
+        coordinator->ReturnedUnitCount--;
+        receiver->UnitFirstPrefix = coordinator->ReturnedFirstPrefixes[coordinator->ReturnedUnitCount];
+        receiver->UnitEndPrefix = coordinator->ReturnedEndPrefixes[coordinator->ReturnedUnitCount];
+    }
+
+    else if (remainingPrefixes > 0)
+    {
+        for (int preparedWorker = 0; preparedWorker < coordinator->WorkerCount; preparedWorker++)
+            if (coordinator->Workers[preparedWorker].SequenceID == coordinator->SequenceID && coordinator->Workers[preparedWorker].LeftReason == NULL)
+                preparedThreads += coordinator->Workers[preparedWorker].Threads;
+
+        // Each unit is a fraction of the worker's share of the prefixes left by its solver threads, so units shrink as the search nears its end
+        unitPrefixes = remainingPrefixes / ((uint64_t) preparedThreads * UNITS_PER_WORKER_SHARE) * (uint64_t) receiver->Threads;
+        if (unitPrefixes == 0) unitPrefixes = 1;
+        if (unitPrefixes > remainingPrefixes) unitPrefixes = remainingPrefixes;
+
+        receiver->UnitFirstPrefix = coordinator->NextPrefix;
+        receiver->UnitEndPrefix = coordinator->NextPrefix + unitPrefixes;
+        coordinator->NextPrefix += unitPrefixes;
+    }
+
+    else return FALSE;
+
+    // The worker holds the unit even if it can't be sent, so that it is handed out again once the worker is dropped
+    receiver->HasUnit = TRUE;
+    receiver->UnitID = coordinator->NextUnitID++;
+    receiver->LastHeardTime = getWallClockTime();
+
+    if (sendNodeLine(&receiver->Connection, "UNIT %d %d %llu %llu %d\n", coordinator->SequenceID, receiver->UnitID, (unsigned long long) receiver->UnitFirstPrefix, \
+                     (unsigned long long) receiver->UnitEndPrefix, coordinator->StackHeight) == TRUE) return TRUE;
+
+    receiver->LeftReason = "Connection lost";
+    return FALSE;
+}
+
+// Return the lowest stack height the search of the sequence being solved by 'coordinator' didn't rule out, from the units stopped before they were finished and the bound on each prefix not handed out, if the search was stopped
+int getCoordinatedLowerBound(distributed_coordinator *coordinator)
+{
+    sequence_params *sequenceParams = &coordinator->SequenceParams;
+    int lowerBound = coordinator->StackHeight < coordinator->StoppedBound ? coordinator->StackHeight : coordinator->StoppedBound;
+    int rootBound = getStackHeightBound(&sequenceParams->PlacementTable, 0, sequenceParams->Root.Skyline, sequenceParams->GridWidth);
+    work_item item;
+    int itemBound;
+
+    // Every unit which was finished holds no permutation lower than the lowest stack found
+    if (coordinator->Stopped == FALSE) return coordinator->StackHeight;
+
+    for (int returnedUnit = 0; returnedUnit < coordinator->ReturnedUnitCount; returnedUnit++)
+    {
+        for (uint64_t prefix = coordinator->ReturnedFirstPrefixes[returnedUnit]; prefix < coordinator->ReturnedEndPrefixes[returnedUnit] && lowerBound > rootBound; prefix++)
+        {
+            getPrefixWorkItem(sequenceParams, coordinator->PrefixLength, prefix, &item);
+            itemBound = getWorkItemBound(sequenceParams, &item);
+            if (itemBound < lowerBound) lowerBound = itemBound;
+        }
+    }
+
+    for (uint64_t prefix = coordinator->NextPrefix; prefix < coordinator->Prefixes && lowerBound > rootBound; prefix++)
+    {
+        getPrefixWorkItem(sequenceParams, coordinator->PrefixLength, prefix, &item);
+        itemBound = getWorkItemBound(sequenceParams, &item);
+        if (itemBound < lowerBound) lowerBound = itemBound;
+    }
+
+    return lowerBound > rootBound ? lowerBound : rootBound;
+}
+
+// Solve the sequence in 'sequenceParams' with the workers of 'coordinator', within the time limit of 'request', and store the solution in 'result'. Workers can connect and leave during the search. Return the status of the result
+int solveCoordinatedSequence(distributed_coordinator *coordinator, sequence_params *sequenceParams, solve_request *request, solve_result *result)
+{
+    sequence_params *coordinatedParams = &coordinator->SequenceParams;
+    double startTime = getWallClockTime();
+    double deadline = request->TimeLimit > 0 ? startTime + request->TimeLimit : 0;
+    int waitedForWorkers = coordinator->SolverSettings.CoordinatedWorkers > 0 ? coordinator->SolverSettings.CoordinatedWorkers : 1;
+    int totalThreads = 0;
+    int busyWorkers;
+    coordinator_worker *worker;
+
+    // The workers asked for are waited for before the first sequence, so that its search tree is split for all of them
+    if (coordinator->WaitedForWorkers == FALSE) fprintf(stderr, "Waiting for %d worker(s) on port %d\n", waitedForWorkers, coordinator->SolverSettings.CoordinatorPort);
+
+    while (coordinator->WaitedForWorkers == FALSE)
+    {
+        pollWorkers(coordinator, COORDINATOR_POLL_INTERVAL);
+        dropLeftWorkers(coordinator);
+
+        busyWorkers = 0;
+        for (int joinedWorker = 0; joinedWorker < coordinator->WorkerCount; joinedWorker++) if (coordinator->Workers[joinedWorker].Threads > 0) busyWorkers++;
+        if (busyWorkers >= waitedForWorkers) coordinator->WaitedForWorkers = TRUE;
+    }
+
+    memcpy(coordinatedParams->Sequence, sequenceParams->Sequence, sequenceParams->Size);
+    coordinatedParams->Size = sequenceParams->Size;
+    coordinatedParams->AllowRotation = sequenceParams->AllowRotation;
+    coordinatedParams->GridWidth = sequenceParams->GridWidth;
+    memset(&coordinatedParams->Root, 0, sizeof(coordinatedParams->Root));
+
+    // Workers build the same placement table, so the greedy solution they are seeded with is the coordinator's first solution
+    coordinator->SequenceID++;
+    coordinator->StackHeight = buildSeededPlacementTable(coordinatedParams, coordinator->PieceColumns, coordinator->PieceRotations);
+    coordinator->PlacementTableHash = getPlacementTableHash(coordinatedParams);
+    getSubtreePermutations(coordinatedParams);
+
+    // Lengthen the prefix until there are enough prefixes for the solver threads of the workers to share out as units shrink. The last piece is never part of a prefix, as in a work queue
+    for (int joinedWorker = 0; joinedWorker < coordinator->WorkerCount; joinedWorker++) totalThreads += coordinator->Workers[joinedWorker].Threads;
+    if (totalThreads == 0) totalThreads = 1;
+
+    coordinator->PrefixLength = 0;
+    coordinator->Prefixes = 1;
+
+    while (coordinator->PrefixLength < coordinatedParams->Size - 1 && coordinator->Prefixes < (uint64_t) totalThreads * PREFIXES_PER_WORKER_THREAD)
+    {
+        coordinator->Prefixes *= getPiecePlacementCount(&coordinatedParams->PlacementTable, coordinator->PrefixLength);
+        coordinator->PrefixLength++;
+    }
+
+    coordinator->NextPrefix = 0;
+    coordinator->ReturnedUnitCount = 0;
+    coordinator->SearchedPrefixes = 0;
+    coordinator->NextUnitID = 0;
+    coordinator->Stopped = FALSE;
+    coordinator->StoppedBound = NO_NODE_BOUND;
+    coordinator->Nodes = 0;
+    coordinator->Searching = TRUE;
+
+    for (int joinedWorker = 0; joinedWorker < coordinator->WorkerCount; joinedWorker++)
+        if (coordinator->Workers[joinedWorker].Threads > 0) sendWorkerSequence(coordinator, joinedWorker);
+
+    // Each worker which prepared the sequence is kept busy with a unit until none are left. Units of workers which leave are handed out again, and workers joining are sent the sequence
+    while (TRUE)
+    {
+        markHungWorkers(coordinator);
+        dropLeftWorkers(coordinator);
+        busyWorkers = 0;
+
+        for (int idleWorker = 0; idleWorker < coordinator->WorkerCount; idleWorker++)
+        {
+            worker = &coordinator->Workers[idleWorker];
+            if (worker->HasUnit == FALSE && worker->LeftReason == NULL && worker->SequenceID == coordinator->SequenceID) assignWorkUnit(coordinator, idleWorker);
+            if (worker->HasUnit == TRUE) busyWorkers++;
+        }
+
+        if (busyWorkers == 0 && (coordinator->Stopped == TRUE || (coordinator->ReturnedUnitCount == 0 && coordinator->NextPrefix == coordinator->Prefixes))) break;
+
+        // Workers abandon their units once stopped, leaving the lowest stack height they didn't rule out
+        if (deadline != 0 && coordinator->Stopped == FALSE && getWallClockTime() >= deadline)
+        {
+            coordinator->Stopped = TRUE;
+
+            for (int busyWorker = 0; busyWorker < coordinator->WorkerCount; busyWorker++)
+            {
+                worker = &coordinator->Workers[busyWorker];
+
+                if (worker->HasUnit == TRUE && worker->LeftReason == NULL && \
+                    sendNodeLine(&worker->Connection, "STOP %d %d\n", coordinator->SequenceID, worker->UnitID) == FALSE) worker->LeftReason = "Connection lost";
+            }
+
+            continue;
+        }
+
+        pollWorkers(coordinator, COORDINATOR_POLL_INTERVAL);
+    }
+
+    coordinator->Searching = FALSE;
+
+    result->Status = coordinator->Stopped == TRUE ? SOLVE_STOPPED : SOLVE_OK;
+    result->StackHeight = coordinator->StackHeight;
+    result->LowerBound = getCoordinatedLowerBound(coordinator);
+    result->Optimal = result->LowerBound == result->StackHeight ? TRUE : FALSE;
+    result->Permutations = getSequencePermutations(coordinatedParams);
+    result->TriedPermutations = (permutation_count) coordinator->SearchedPrefixes * getPiecePlacementCount(&coordinatedParams->PlacementTable, coordinator->PrefixLength) * \
+                                coordinatedParams->SubtreePermutations[coordinator->PrefixLength];
+    result->Nodes = coordinator->Nodes;
+    result->ElapsedTime = getWallClockTime() - startTime;
+    result->Cached = FALSE;
+
+    for (int piece = 0; piece < coordinatedParams->Size; piece++)
+    {
+        result->PieceColumns[piece] = coordinator->PieceColumns[piece];
+        result->PieceRotations[piece] = coordinator->PieceRotations[piece];
+    }
+
+    return result->Status;
+}
+
+// If 'line' is a message from the coordinator of 'worker' holding the lowest stack height found by any worker, lower the incumbent of its solvers to it. Return TRUE if it was such a message, FALSE otherwise
+int readCoordinatorBound(distributed_worker *worker, const char *line)
+{
+    int sequenceID, stackHeight;
+
+    if (sscanf(line, "BOUND %d %d", &sequenceID, &stackHeight) != 2) return FALSE;
+
+    // Solvers only save a permutation which lowers the incumbent, so a worker only ever finds stacks lower than any found by the others
+    if (sequenceID == worker->SequenceID) atomicLowerInt(&worker->SolveContext->Incumbent.MinStackHeight, stackHeight);
+    return TRUE;
+}
+
+// Read the messages received by the worker in 'userData' (must point to a distributed_worker) while its solvers search a unit, lowering their incumbent to each stack height the coordinator sends. Return TRUE if the unit should be abandoned, FALSE otherwise
+int pollCoordinator(void *userData)
+{
+    distributed_worker *worker = userData;
+    node_connection *connection = &worker->Connection;
+    char line[MAX_NODE_LINE_LENGTH];
+    int sequenceID, unitID;
+    int readable;
+    int lineRead;
+    int stopUnit;
+
+    // Solver threads poll one at a time, each reading every message received so far
+    acquireLock(&worker->Lock);
+
+    while (worker->StopUnit == FALSE && worker->Disconnected == FALSE)
+    {
+        lineRead = getNodeLine(connection, line);
+
+        if (lineRead == NODE_LINE_READ)
+        {
+            if (readCoordinatorBound(worker, line) == TRUE) continue;
+
+            // Only the lowest stack height and the unit being stopped are sent while a unit is searched
+            if (sscanf(line, "STOP %d %d", &sequenceID, &unitID) == 2) worker->StopUnit = sequenceID == worker->SequenceID && unitID == worker->UnitID ? TRUE : FALSE;
+            else worker->Disconnected = TRUE;
+        }
+
+        else if (lineRead == NODE_LINE_INVALID) worker->Disconnected = TRUE;
+        else if (waitForNodes(&connection->Socket, 1, 0, &readable) == FALSE) break;
+        else if (receiveNodeData(connection) == FALSE) worker->Disconnected = TRUE;
+    }
+
+    if (worker->Disconnected == FALSE && getWallClockTime() >= worker->NextKeepaliveTime)
+    {
+        worker->NextKeepaliveTime = getWallClockTime() + WORKER_KEEPALIVE_INTERVAL;
+        if (sendNodeLine(connection, "ALIVE %d %d\n", worker->SequenceID, worker->UnitID) == FALSE) worker->Disconnected = TRUE;
+    }
+
+    stopUnit = worker->StopUnit == TRUE || worker->Disconnected == TRUE ? TRUE : FALSE;
+    releaseLock(&worker->Lock);
+
+    return stopUnit;
+}
+
+// Prepare the solvers of 'worker' for the sequence sent by its coordinator in the line 'line'. Return TRUE if they were prepared, FALSE if the line is invalid or the connection was lost
+int prepareWorkerSequence(distributed_worker *worker, char *line)
+{
+    solve_context *solveContext = worker->SolveContext;
+    sequence_params *sequenceParams = &solveContext->SequenceParams;
+    search_control *searchControl = &solveContext->SearchControl;
+    solve_request request = {0};
+    char sequence[MAX_NODE_LINE_LENGTH];
+    char rotation;
+    int sequenceID, gridWidth, prefixLength;
+
+    if (sscanf(line, "SEQUENCE %d %s %c %d %d", &sequenceID, sequence, &rotation, &gridWidth, &prefixLength) != 5 || (rotation != 'Y' && rotation != 'N')) return FALSE;
+
+    request.Sequence = sequence;
+    request.Size = (int) strlen(sequence);
+    request.GridWidth = gridWidth;
+    if (gridWidth == 0 || isValidSolveRequest(&request) == FALSE) return FALSE;
+
+    memcpy(sequenceParams->Sequence, sequence, request.Size);
+    sequenceParams->Size = request.Size;
+    sequenceParams->AllowRotation = rotation == 'Y' ? TRUE : FALSE;
+    sequenceParams->GridWidth = gridWidth;
+    memset(&sequenceParams->Root, 0, sizeof(sequenceParams->Root));
+
+    // The coordinator sets the limits of each unit, and the stack heights found by the other workers are read whenever the solvers check their limits
+    searchControl->Deadline = 0;
+    searchControl->NodeBudget = 0;
+    searchControl->ShouldCancel = pollCoordinator;
+    searchControl->OnImprovedSolution = NULL;
+    searchControl->UserData = worker;
+    searchControl->Checkpoint = NULL;
+    searchControl->Telemetry = solveContext->SolverSettings.TelemetryFile != NULL ? &solveContext->TelemetryReporter : NULL;
+
+    initialiseSolvers(solveContext->Solvers, &solveContext->SolverSettings, searchControl, &solveContext->Incumbent, &solveContext->WorkQueue, \
+                      &solveContext->TranspositionTable, sequenceParams);
+
+    // The work queue is set up again for the prefixes of each unit
+    destroyWorkQueue(&solveContext->WorkQueue);
+
+    worker->SequenceID = sequenceID;
+    worker->PrefixLength = prefixLength;
+    worker->ReportedHeight = solveContext->Incumbent.MinStackHeight;
+
+    return sendNodeLine(&worker->Connection, "READY %d %llu\n", sequenceID, (unsigned long long) getPlacementTableHash(sequenceParams));
+}
+
+// Search the unit of work sent by the coordinator of 'worker' in the line 'line' with its solvers, then send the coordinator the lowest stack found, if it is lower than any stack sent before, and the outcome of the unit. Return TRUE if it was searched, FALSE if the line is invalid or the connection was lost
+int searchWorkUnit(distributed_worker *worker, char *line)
+{
+    solve_context *solveContext = worker->SolveContext;
+    sequence_params *sequenceParams = &solveContext->SequenceParams;
+    search_control *searchControl = &solveContext->SearchControl;
+    int numberOfSolvers = solveContext->SolverSettings.NumberOfSolvers;
+    solver *bestSolver;
+    char found[MAX_NODE_LINE_LENGTH];
+    int foundLength;
+    int sequenceID, unitID, stackHeight, status, lowerBound;
+    unsigned long long firstPrefix, endPrefix;
+    uint64_t startNodes = 0;
+    uint64_t nodes = 0;
+
+    if (sscanf(line, "UNIT %d %d %llu %llu %d", &sequenceID, &unitID, &firstPrefix, &endPrefix, &stackHeight) != 5 || sequenceID != worker->SequenceID) return FALSE;
+
+    initialiseWorkQueue(&solveContext->WorkQueue, sequenceParams, numberOfSolvers);
+
+    if (restrictWorkQueue(&solveContext->WorkQueue, sequenceParams, worker->PrefixLength, firstPrefix, endPrefix) == FALSE)
+    {
+        destroyWorkQueue(&solveContext->WorkQueue);
+        return FALSE;
+    }
+
+    // The counters and the best permutation of each solver are kept between the units of a sequence
+    atomicLowerInt(&solveContext->Incumbent.MinStackHeight, stackHeight);
+    searchControl->SpentNodes = 0;
+    worker->UnitID = unitID;
+    worker->NextKeepaliveTime = getWallClockTime() + WORKER_KEEPALIVE_INTERVAL;
+    worker->StopUnit = FALSE;
+
+    for (int solver = 0; solver < numberOfSolvers; solver++)
+    {
+        solveContext->Solvers[solver].AbandonedItem = FALSE;
+        startNodes += solveContext->Solvers[solver].Counters.Nodes;
+    }
+
+    if (searchControl->Telemetry != NULL) beginTelemetrySearch(searchControl->Telemetry, sequenceParams);
+    runSolverPool(&solveContext->SolverPool, sequenceParams);
+    if (searchControl->Telemetry != NULL) endTelemetrySearch(searchControl->Telemetry);
+
+    bestSolver = getBestSolver(solveContext->Solvers, numberOfSolvers);
+    status = solveContext->WorkQueue.Stopped == TRUE ? SOLVE_STOPPED : SOLVE_OK;
+    lowerBound = getSearchLowerBound(solveContext->Solvers, numberOfSolvers, &solveContext->WorkQueue, sequenceParams);
+    for (int solver = 0; solver < numberOfSolvers; solver++) nodes += solveContext->Solvers[solver].Counters.Nodes;
+
+    destroyWorkQueue(&solveContext->WorkQueue);
+    if (worker->Disconnected == TRUE) return FALSE;
+
+    // The placements of a lower stack are sent before the unit is reported finished, so that the coordinator holds them even if the worker leaves
+    if (bestSolver->MinStackHeight < worker->ReportedHeight)
+    {
+        foundLength = snprintf(found, sizeof(found), "FOUND %d %d", sequenceID, bestSolver->MinStackHeight);
+
+        for (int piece = 0; piece < sequenceParams->Size; piece++)
+            foundLength += snprintf(found + foundLength, sizeof(found) - foundLength, " %d %d", bestSolver->BestPieceColumns[piece], bestSolver->BestPieceRotations[piece]);
+
+        if (sendNodeLine(&worker->Connection, "%s\n", found) == FALSE) return FALSE;
+        worker->ReportedHeight = bestSolver->MinStackHeight;
+    }
+
+    return sendNodeLine(&worker->Connection, "DONE %d %d %d %d %llu\n", sequenceID, unitID, status, lowerBound, (unsigned long long) (nodes - startNodes));
+}
+
+// Connect to the coordinator set in 'solverSettings' and search the units of work it hands out with the solvers set in it, until it finishes its batch. Return TRUE if the batch was finished, FALSE if the worker couldn't connect or lost its connection
+int runWorker(solver_settings *solverSettings)
+{
+    solver_settings workerSettings = *solverSettings;
+    distributed_worker *worker;
+    node_socket nodeSocket = NO_NODE_SOCKET;
+    char host[MAX_NODE_HOST_LENGTH];
+    char line[MAX_NODE_LINE_LENGTH];
+    int port;
+    int lineRead;
+    int finished = FALSE;
+
+    if (parseNodeAddress(solverSettings->CoordinatorAddress, host, &port) == FALSE) return FALSE;
+
+    if (startNetworking() == FALSE)
+    {
+        printf("Distributed solving isn't supported on this platform\n");
+        return FALSE;
+    }
+
+    // Workers are started by scripts, possibly before the coordinator is listening
+    for (int attempt = 0; attempt < WORKER_CONNECT_ATTEMPTS && nodeSocket == NO_NODE_SOCKET; attempt++)
+    {
+        if (attempt > 0) sleepSeconds(WORKER_CONNECT_INTERVAL);
+        nodeSocket = connectToNode(host, port);
+    }
+
+    if (nodeSocket == NO_NODE_SOCKET)
+    {
+        printf("Could not connect to the coordinator at %s\n", solverSettings->CoordinatorAddress);
+        stopNetworking();
+        return FALSE;
+    }
+
+    // Units are parts of a search, so the solvers never print their progress
+    workerSettings.ShowProgress = FALSE;
+    worker = malloc(sizeof(distributed_worker));
+    if (worker != NULL) worker->SolveContext = createSolveContext(&workerSettings);
+
+    if (worker == NULL || worker->SolveContext == NULL)
+    {
+        printf("Could not allocate the solvers and transposition table!\n");
+        free(worker);
+        closeNode(nodeSocket);
+        stopNetworking();
+        return FALSE;
+    }
+
+    initialiseNodeConnection(&worker->Connection, nodeSocket);
+    initialiseLock(&worker->Lock);
+    worker->SequenceID = -1;
+    worker->PrefixLength = 0;
+    worker->UnitID = -1;
+    worker->NextKeepaliveTime = 0;
+    worker->StopUnit = FALSE;
+    worker->Disconnected = sendNodeLine(&worker->Connection, "HELLO %d %d\n", DISTRIBUTED_PROTOCOL_VERSION, workerSettings.NumberOfSolvers) == TRUE ? FALSE : TRUE;
+
+    printf("Connected to the coordinator at %s with %d solver thread(s)\n", solverSettings->CoordinatorAddress, workerSettings.NumberOfSolvers);
+
+    while (worker->Disconnected == FALSE && finished == FALSE)
+    {
+        lineRead = getNodeLine(&worker->Connection, line);
+
+        if (lineRead == NODE_LINE_NONE)
+        {
+            if (receiveNodeData(&worker->Connection) == FALSE) worker->Disconnected = TRUE;
+            continue;
+        }
+
+        // A unit stopped after it was finished needs nothing more
+        if (lineRead == NODE_LINE_INVALID) worker->Disconnected = TRUE;
+        else if (strncmp(line, "SEQUENCE ", 9) == 0) worker->Disconnected = prepareWorkerSequence(worker, line) == TRUE ? FALSE : TRUE;
+        else if (strncmp(line, "UNIT ", 5) == 0) worker->Disconnected = searchWorkUnit(worker, line) == TRUE ? FALSE : TRUE;
+        else if (strcmp(line, "QUIT") == 0) finished = TRUE;
+        else if (readCoordinatorBound(worker, line) == FALSE && strncmp(line, "STOP ", 5) != 0) worker->Disconnected = TRUE;
+    }
+
+    if (finished == FALSE) printf("Lost the connection to the coordinator\n");
+
+    closeNode(nodeSocket);
+    destroyLock(&worker->Lock);
+    destroySolveContext(worker->SolveContext);
+    free(worker);
+    stopNetworking();
+
+    return finished;
+}
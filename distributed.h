@@ -0,0 +1,216 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "thread_utils.h"
+
+#define DISTRIBUTED_PROTOCOL_VERSION 2 // Sent by each worker when it connects. Workers speaking another version are turned away
+#define MAX_WORKERS 64 // Most workers connected to a coordinator at once
+#define MAX_NODE_LINE_LENGTH 512 // Longest line of the protocol, including the newline. Long enough for the placements of MAX_SEQUENCE_SIZE pieces
+#define NODE_BUFFER_SIZE (4 * MAX_NODE_LINE_LENGTH) // Bytes received from a connection which can wait to be read as lines
+#define PREFIXES_PER_WORKER_THREAD 64 // Fewest prefixes the search tree of a sequence is split into per worker thread, so that units can shrink as the search nears its end
+#define UNITS_PER_WORKER_SHARE 4 // Each unit handed to a worker holds this fraction of its share of the prefixes left, so that units shrink as the search nears its end and no worker is left with a large unit at the end
+#define COORDINATOR_POLL_INTERVAL 0.1 // Most seconds the coordinator waits for a message before checking the time limit
+#define WORKER_CONNECT_ATTEMPTS 40 // Times a worker tries to connect before giving up, so that workers can be started before the coordinator
+#define WORKER_CONNECT_INTERVAL 0.25 // Seconds between attempts to connect
+#define WORKER_KEEPALIVE_INTERVAL 1.0 // Seconds between the messages a worker sends while searching a unit, so that the coordinator can tell a busy worker from a hung one
+#define WORKER_TIMEOUT 10.0 // Seconds a worker holding a unit may send nothing before the coordinator drops it and hands its unit out again
+
+// Results of reading a line from a connection
+#define NODE_LINE_READ 1
+#define NODE_LINE_NONE 0 // No whole line has been received yet
+#define NODE_LINE_INVALID -1 // The line is longer than MAX_NODE_LINE_LENGTH
+
+
+#ifdef _WIN32 // Windows implementation (Winsock)
+
+#include <windows.h>
+
+typedef UINT_PTR node_socket; // A SOCKET. winsock2.h is only included by distributed.c, as it must come before windows.h
+#define NO_NODE_SOCKET ((node_socket) ~0)
+
+
+#elif defined __linux__ // Linux implementation (BSD sockets)
+
+typedef int node_socket;
+#define NO_NODE_SOCKET -1
+
+
+#else // Standard implementation (no networking, distributed solving isn't supported)
+
+typedef int node_socket;
+#define NO_NODE_SOCKET -1
+
+#endif
+
+typedef struct // Stores a TCP connection to another process and the bytes received from it which don't make up a whole line yet
+{
+    node_socket Socket;
+    char Buffer[NODE_BUFFER_SIZE];
+    int Length;
+} node_connection;
+
+typedef struct // Stores a worker connected to the coordinator, and the unit of work it holds
+{
+    node_connection Connection;
+    int Number; // Numbers workers in the order they connect, for the messages the coordinator prints
+    int Threads; // Solver threads of the worker. 0 until it has introduced itself
+    int SequenceID; // ID of the last sequence the worker prepared its solvers for. Units of a sequence are only handed to workers which prepared it
+    int HasUnit;
+    int UnitID;
+    uint64_t UnitFirstPrefix;
+    uint64_t UnitEndPrefix;
+    double LastHeardTime; // Wall clock time at which the worker last sent anything or was handed its unit
+    const char *LeftReason; // Why the worker left, once its connection is lost, it sends a line it shouldn't or it stops responding. NULL while it is connected. Workers which left are dropped once the coordinator has handled every worker's messages
+} coordinator_worker;
+
+typedef struct // Stores the workers connected to a coordinator, and the search of the sequence they are solving between them
+{
+    solver_settings SolverSettings;
+    node_socket Listener;
+    coordinator_worker Workers[MAX_WORKERS];
+    int WorkerCount;
+    int ConnectedWorkers; // Workers which have connected so far, including those which left
+    int WaitedForWorkers; // TRUE once the workers the settings ask for have connected
+
+    // Stores the sequence being solved, which every worker builds the same placement table for as long as it runs the same build, and its ID, which is raised for each sequence
+    sequence_params SequenceParams;
+    int SequenceID;
+    int Searching; // TRUE while a sequence is being solved, so that workers connecting are sent it
+    uint64_t PlacementTableHash;
+
+    // Stores the prefixes the search tree is split into, and the next one which hasn't been handed out. Each unit of work is a range of them
+    int PrefixLength;
+    uint64_t Prefixes;
+    uint64_t NextPrefix;
+    // Stores the units of workers which left before finishing them, which are handed out again before new ones
+    uint64_t ReturnedFirstPrefixes[MAX_WORKERS];
+    uint64_t ReturnedEndPrefixes[MAX_WORKERS];
+    int ReturnedUnitCount;
+    uint64_t SearchedPrefixes; // Prefixes of the units finished so far
+    int NextUnitID;
+
+    // Stores the lowest stack found by any worker, and the column and rotation index of each piece which stack to it
+    int StackHeight;
+    int PieceColumns[MAX_SEQUENCE_SIZE];
+    int PieceRotations[MAX_SEQUENCE_SIZE];
+    int Stopped; // TRUE once the time limit is reached, after which no units are handed out
+    int StoppedBound; // Lowest stack height the units stopped before they were finished didn't rule out
+    uint64_t Nodes; // Search tree nodes entered by the workers
+} distributed_coordinator;
+
+typedef struct // Stores the connection of a worker to its coordinator, and the solve context it searches its units of work in
+{
+    solve_context *SolveContext;
+    node_connection Connection;
+    solver_lock Lock; // Held while a solver thread reads the messages received during a search
+    int SequenceID; // ID of the sequence the solvers are prepared for. -1 if none
+    int PrefixLength;
+    int UnitID; // ID of the unit being searched, or the last one searched
+    double NextKeepaliveTime; // Wall clock time after which the next solver thread to read the messages received tells the coordinator the unit is still being searched
+    int ReportedHeight; // Lowest stack the worker sent the coordinator the placements of, or the greedy stack of the sequence
+    int StopUnit; // TRUE once the coordinator stopped the unit being searched
+    int Disconnected; // TRUE once the connection to the coordinator is lost or it sent a message it shouldn't
+} distributed_worker;
+
+// Prepare the networking routines of the platform before the first socket is opened. Return TRUE if they were prepared, FALSE otherwise
+int startNetworking();
+
+// Release the networking routines of the platform once every socket is closed
+void stopNetworking();
+
+// Return a socket listening for connections on TCP port 'port' of every address of the host, or NO_NODE_SOCKET if it couldn't be opened
+node_socket listenOnPort(int port);
+
+// Return a socket connected to TCP port 'port' of 'host', or NO_NODE_SOCKET if it couldn't connect
+node_socket connectToNode(const char *host, int port);
+
+// Return a socket connected to the next process connecting to 'listener', or NO_NODE_SOCKET if its connection failed
+node_socket acceptNode(node_socket listener);
+
+// Close 'nodeSocket'
+void closeNode(node_socket nodeSocket);
+
+// Send the 'length' bytes in 'data' through 'nodeSocket', blocking until they are all sent. Return TRUE if they were sent, FALSE if the connection is lost
+int sendToNode(node_socket nodeSocket, const char *data, int length);
+
+// Receive at most 'capacity' bytes from 'nodeSocket' into 'buffer', blocking until some arrive. Return the number of bytes received, or 0 if the connection is closed or lost
+int receiveFromNode(node_socket nodeSocket, char *buffer, int capacity);
+
+// Wait at most 'seconds' seconds for any of the 'count' sockets in 'sockets' to have data to receive or a connection to accept, setting each entry of 'readable' to TRUE if its socket has. Return TRUE if any has, FALSE otherwise
+int waitForNodes(node_socket sockets[], int count, double seconds, int readable[]);
+
+// Block the calling thread for 'seconds' seconds
+void sleepSeconds(double seconds);
+
+// Start 'connection' on the connected socket 'nodeSocket', with no bytes received yet
+void initialiseNodeConnection(node_connection *connection, node_socket nodeSocket);
+
+// Send the line formatted from 'format' and the arguments after it, which must end with a newline, through 'connection'. Return TRUE if it was sent, FALSE if the connection is lost or the line is too long
+int sendNodeLine(node_connection *connection, const char *format, ...);
+
+// Receive the bytes waiting in 'connection', blocking until some arrive. Return TRUE if any were received, FALSE if the connection is closed or lost, or its buffer is full without holding a whole line
+int receiveNodeData(node_connection *connection);
+
+// Move the next whole line received from 'connection' into 'line', without its newline. Return NODE_LINE_READ if a line was read, NODE_LINE_NONE if no whole line has been received, or NODE_LINE_INVALID if the line is too long
+int getNodeLine(node_connection *connection, char line[MAX_NODE_LINE_LENGTH]);
+
+// Return the height of the stack the 'size' pieces in 'sequence', dropped into a grid 'gridWidth' columns wide with rotations if 'allowRotation' is TRUE, reach at the columns and rotation indices in 'pieceColumns' and 'pieceRotations', or -1 if any placement is outside the grid or the stack overflows it
+int getPlacedStackHeight(const char *sequence, int size, int allowRotation, int gridWidth, const int pieceColumns[], const int pieceRotations[]);
+
+// Start a coordinator handing out the sequences of a batch to workers connecting to the port set in 'solverSettings'. Return the coordinator, or NULL if it couldn't be allocated or the port couldn't be listened on
+distributed_coordinator *startCoordinator(solver_settings *solverSettings);
+
+// Tell the workers of 'coordinator' that the batch is finished, then close their connections and free the coordinator
+void stopCoordinator(distributed_coordinator *coordinator);
+
+// Accept the worker connecting to 'coordinator', turning it away if MAX_WORKERS workers are connected
+void acceptWorker(distributed_coordinator *coordinator);
+
+// Mark the workers of 'coordinator' which hold a unit but have sent nothing for WORKER_TIMEOUT seconds as left, as they hung or their connection was lost without being closed
+void markHungWorkers(distributed_coordinator *coordinator);
+
+// Close the connections of the workers of 'coordinator' which left, and return the units they held to be handed out again
+void dropLeftWorkers(distributed_coordinator *coordinator);
+
+// Send the sequence being solved by 'coordinator' to worker 'worker' to prepare its solvers for. Return TRUE if it was sent, FALSE if the worker left
+int sendWorkerSequence(distributed_coordinator *coordinator, int worker);
+
+// Send the lowest stack height found by any worker of 'coordinator' to every worker searching a unit, so that they prune with it
+void broadcastStackHeight(distributed_coordinator *coordinator);
+
+// Handle the line 'line' received by 'coordinator' from worker 'worker'. Return TRUE if it was handled, FALSE if the worker left as it sent a line it shouldn't have
+int handleWorkerLine(distributed_coordinator *coordinator, int worker, char *line);
+
+// Wait at most 'seconds' seconds for messages to 'coordinator', then accept the workers connecting and handle the lines received from each worker, marking those whose connection was lost as left
+void pollWorkers(distributed_coordinator *coordinator, double seconds);
+
+// Hand the next unit of work of the sequence being solved by 'coordinator' to worker 'worker', which must have prepared its solvers for the sequence and hold no unit. Return TRUE if a unit was handed out, FALSE if none are left or the worker left
+int assignWorkUnit(distributed_coordinator *coordinator, int worker);
+
+// Return the lowest stack height the search of the sequence being solved by 'coordinator' didn't rule out, from the units stopped before they were finished and the bound on each prefix not handed out, if the search was stopped
+int getCoordinatedLowerBound(distributed_coordinator *coordinator);
+
+// Solve the sequence in 'sequenceParams' with the workers of 'coordinator', within the time limit of 'request', and store the solution in 'result'. Workers can connect and leave during the search. Return the status of the result
+int solveCoordinatedSequence(distributed_coordinator *coordinator, sequence_params *sequenceParams, solve_request *request, solve_result *result);
+
+// If 'line' is a message from the coordinator of 'worker' holding the lowest stack height found by any worker, lower the incumbent of its solvers to it. Return TRUE if it was such a message, FALSE otherwise
+int readCoordinatorBound(distributed_worker *worker, const char *line);
+
+// Read the messages received by the worker in 'userData' (must point to a distributed_worker) while its solvers search a unit, lowering their incumbent to each stack height the coordinator sends, and tell the coordinator every WORKER_KEEPALIVE_INTERVAL seconds that the unit is still being searched. Return TRUE if the unit should be abandoned, FALSE otherwise
+int pollCoordinator(void *userData);
+
+// Prepare the solvers of 'worker' for the sequence sent by its coordinator in the line 'line'. Return TRUE if they were prepared, FALSE if the line is invalid or the connection was lost
+int prepareWorkerSequence(distributed_worker *worker, char *line);
+
+// Search the unit of work sent by the coordinator of 'worker' in the line 'line' with its solvers, then send the coordinator the lowest stack found, if it is lower than any stack sent before, and the outcome of the unit. Return TRUE if it was searched, FALSE if the line is invalid or the connection was lost
+int searchWorkUnit(distributed_worker *worker, char *line);
+
+// Connect to the coordinator set in 'solverSettings' and search the units of work it hands out with the solvers set in it, until it finishes its batch. Return TRUE if the batch was finished, FALSE if the worker couldn't connect or lost its connection
+int runWorker(solver_settings *solverSettings);
+
+#endif
@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include "bool.h"
+#include "fuzz.h"
+#include "input_utils.h"
+#include "solver_library.h"
+#include "tetromino.h"
+#include "grid.h"
+#include "test.h"
+#include "benchmark.h"
+#include "permutation_count.h"
+
+// Fill 'sequenceParams' with a random sequence, grid width and rotation flag, using and advancing the generator state 'state'. The sequence is cut short before it has more than FUZZ_MAX_REFERENCE_PERMUTATIONS permutations
+void generateFuzzSequence(uint64_t *state, sequence_params *sequenceParams)
+{
+    const char *pieces = FUZZ_PIECES;
+    int size = 1 + (int) (getNextBenchmarkRandom(state) % MAX_SEQUENCE_SIZE);
+
+    sequenceParams->GridWidth = MIN_GRID_WIDTH + (int) (getNextBenchmarkRandom(state) % (MAX_GRID_WIDTH - MIN_GRID_WIDTH + 1));
+    sequenceParams->AllowRotation = getNextBenchmarkRandom(state) % 2 == 0 ? TRUE : FALSE;
+    sequenceParams->Size = 0;
+
+    while (sequenceParams->Size < size)
+    {
+        sequenceParams->Sequence[sequenceParams->Size++] = pieces[getNextBenchmarkRandom(state) % strlen(pieces)];
+
+        if (getFuzzPermutations(sequenceParams) > FUZZ_MAX_REFERENCE_PERMUTATIONS)
+        {
+            sequenceParams->Size--;
+            break;
+        }
+    }
+}
+
+// Return the number of permutations of the sequence in 'sequenceParams', counting every rotation of each piece if rotation is allowed
+permutation_count getFuzzPermutations(sequence_params *sequenceParams)
+{
+    permutation_count permutations = 1;
+    int placements;
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        placements = 0;
+
+        for (int rotation = 0; rotation < (sequenceParams->AllowRotation == TRUE ? getRotations(sequenceParams->Sequence[piece]) : 1); rotation++)
+            placements += sequenceParams->GridWidth - getTetromino(sequenceParams->Sequence[piece], rotation)->Width + 1;
+
+        permutations *= placements;
+    }
+
+    return permutations;
+}
+
+// Return the height of the topmost filled cell in column 'column' of 'grid', no higher than 'stackHeight', or 0 if the column is empty
+int getReferenceColumnHeight(char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int column, int stackHeight)
+{
+    int height = stackHeight;
+
+    while (height > 0 && grid[GRID_HEIGHT - height][column] == '_') height--;
+    return height;
+}
+
+// Return the lowest stack height reached by trying every permutation of the pieces from 'piece' onwards of the sequence in 'sequenceParams' on 'grid', whose stack is 'stackHeight' high, without any pruning. Only the cells of 'grid' are used, so that the result doesn't depend on the skylines the solvers search with
+int getReferenceStackHeight(sequence_params *sequenceParams, int piece, char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int stackHeight)
+{
+    tetromino *tet;
+    int rotations;
+    int landingHeight;
+    int bottomRow;
+    int height;
+    int minStackHeight = INT_MAX;
+
+    if (piece == sequenceParams->Size) return stackHeight;
+
+    rotations = sequenceParams->AllowRotation == TRUE ? getRotations(sequenceParams->Sequence[piece]) : 1;
+
+    for (int rotation = 0; rotation < rotations; rotation++)
+    {
+        tet = getTetromino(sequenceParams->Sequence[piece], rotation);
+
+        for (int column = 0; column <= sequenceParams->GridWidth - tet->Width; column++)
+        {
+            // The piece falls until the lowest cell of one of its columns rests on the stack. Patterns are drawn with their bottom row in row 3
+            landingHeight = 0;
+
+            for (int tetCol = 0; tetCol < tet->Width; tetCol++)
+            {
+                for (bottomRow = 3; tet->Pattern[bottomRow][tetCol] == '_'; bottomRow--);
+
+                height = getReferenceColumnHeight(grid, column + tetCol, stackHeight) - (3 - bottomRow);
+                if (height > landingHeight) landingHeight = height;
+            }
+
+            if (landingHeight + tet->Height > GRID_HEIGHT) continue;
+
+            for (int tetRow = 3; tetRow > 3 - tet->Height; tetRow--)
+                for (int tetCol = 0; tetCol < tet->Width; tetCol++)
+                    if (tet->Pattern[tetRow][tetCol] != '_') grid[GRID_HEIGHT - 1 - (landingHeight + 3 - tetRow)][column + tetCol] = tet->Pattern[tetRow][tetCol];
+
+            height = getReferenceStackHeight(sequenceParams, piece + 1, grid, landingHeight + tet->Height > stackHeight ? landingHeight + tet->Height : stackHeight);
+            if (height < minStackHeight) minStackHeight = height;
+
+            // Clear the piece again before trying its next placement
+            for (int tetRow = 3; tetRow > 3 - tet->Height; tetRow--)
+                for (int tetCol = 0; tetCol < tet->Width; tetCol++)
+                    if (tet->Pattern[tetRow][tetCol] != '_') grid[GRID_HEIGHT - 1 - (landingHeight + 3 - tetRow)][column + tetCol] = '_';
+        }
+    }
+
+    return minStackHeight;
+}
+
+// Solve the sequence in 'sequenceParams' with the engine 'engine', and check that its stack height is 'referenceStackHeight', or no lower than it and above its lower bound if its search was stopped, and that its placements drop to that height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzEngine(fuzz_engine *engine, sequence_params *sequenceParams, int referenceStackHeight)
+{
+    solve_request request = {0};
+    solve_result result;
+    int droppedStackHeight;
+    int unrotated = TRUE;
+
+    request.Sequence = sequenceParams->Sequence;
+    request.Size = sequenceParams->Size;
+    request.AllowRotation = sequenceParams->AllowRotation;
+    request.GridWidth = sequenceParams->GridWidth;
+    request.NodeBudget = engine->NodeBudget;
+
+    if (solveSequenceRequest(engine->SolveContext, &request, &result) != SOLVE_OK && engine->NodeBudget == 0)
+    {
+        printf("FAILED %.*s %c, width %d, %d thread(s)%s: the search didn't complete\n", sequenceParams->Size, sequenceParams->Sequence, sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', \
+            sequenceParams->GridWidth, engine->SolveContext->SolverSettings.NumberOfSolvers, engine->TableEnabled == TRUE ? "" : " without a transposition table");
+        return FALSE;
+    }
+
+    // Replay the placements on a grid, which also checks that each one is inside the grid
+    droppedStackHeight = getTestPermutationStackHeight(sequenceParams, result.PieceColumns, result.PieceRotations);
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+        if (result.PieceRotations[piece] != ROTATION_0) unrotated = FALSE;
+
+    // A stopped search may not have found the lowest stack, but must not rule it out, and can only be proven optimal if it found it
+    if (droppedStackHeight == result.StackHeight && (sequenceParams->AllowRotation == TRUE || unrotated == TRUE) && result.LowerBound <= referenceStackHeight && \
+        (result.Optimal == TRUE ? result.StackHeight == referenceStackHeight : result.StackHeight >= referenceStackHeight)) return TRUE;
+
+    printf("FAILED %.*s %c, width %d, %d thread(s)%s: reference height %d, engine height %d, placements drop to %d, lower bound %d%s\nPermutation: ", sequenceParams->Size, sequenceParams->Sequence, \
+        sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, engine->SolveContext->SolverSettings.NumberOfSolvers, \
+        engine->TableEnabled == TRUE ? "" : " without a transposition table", referenceStackHeight, result.StackHeight, droppedStackHeight, result.LowerBound, \
+        engine->NodeBudget != 0 ? ", with a node budget" : "");
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+        printf("%c:%d(%d) ", sequenceParams->Sequence[piece], result.PieceColumns[piece], result.PieceRotations[piece] * 90);
+    printf("\n");
+
+    return FALSE;
+}
+
+// Drop the sequence in 'sequenceParams' with 'beamSearch', and check that its stack height is no lower than 'referenceStackHeight' and that its placements drop to that height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzBeam(beam_search *beamSearch, sequence_params *sequenceParams, int referenceStackHeight)
+{
+    int pieceColumns[MAX_SEQUENCE_SIZE];
+    int pieceRotations[MAX_SEQUENCE_SIZE];
+    beam_result result = {0, pieceColumns, pieceRotations, 0, 0};
+    int droppedStackHeight = -1;
+
+    if (beamSearchSequence(beamSearch, sequenceParams->Sequence, sequenceParams->Size, sequenceParams->AllowRotation, sequenceParams->GridWidth, &result) == TRUE)
+    {
+        droppedStackHeight = getTestPermutationStackHeight(sequenceParams, pieceColumns, pieceRotations);
+        if (droppedStackHeight == result.StackHeight && result.StackHeight >= referenceStackHeight) return TRUE;
+    }
+
+    printf("FAILED %.*s %c, width %d, beam width %d: reference height %d, beam height %d, placements drop to %d\nPermutation: ", sequenceParams->Size, sequenceParams->Sequence, \
+        sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, beamSearch->BeamWidth, referenceStackHeight, result.StackHeight, droppedStackHeight);
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+        printf("%c:%d(%d) ", sequenceParams->Sequence[piece], pieceColumns[piece], pieceRotations[piece] * 90);
+    printf("\n");
+
+    return FALSE;
+}
+
+// Solve the sequence in 'sequenceParams' online in 'solveContext', one piece at a time, each dropped at its placement in the solution of a window of the next FUZZ_STREAM_WINDOW pieces. Check that the stack height of each window is the reference stack height of the window on the grid the stream has stacked so far,
+// and that the placements dropped stack to the height of the stream. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzStream(solve_context *solveContext, sequence_params *sequenceParams)
+{
+    solve_stream stream;
+    solve_request request = {0};
+    solve_result result;
+    sequence_params windowParams;
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    skyline gridSkyline = EMPTY_SKYLINE;
+    tetromino *tet;
+    int referenceStackHeight;
+
+    memset(grid, '_', sizeof(grid));
+    windowParams.AllowRotation = sequenceParams->AllowRotation;
+    windowParams.GridWidth = sequenceParams->GridWidth;
+
+    startSolveStream(&stream, solveContext, sequenceParams->GridWidth, sequenceParams->AllowRotation, NULL);
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        windowParams.Size = sequenceParams->Size - piece < FUZZ_STREAM_WINDOW ? sequenceParams->Size - piece : FUZZ_STREAM_WINDOW;
+        memcpy(windowParams.Sequence, &sequenceParams->Sequence[piece], windowParams.Size);
+        referenceStackHeight = getReferenceStackHeight(&windowParams, 0, grid, getStackHeight(gridSkyline));
+
+        request.Sequence = windowParams.Sequence;
+        request.Size = windowParams.Size;
+
+        // The grid the reference enumerator uses is only stacked with placements inside it
+        if (solveStreamPiece(&stream, &request, &result) != SOLVE_OK || result.StackHeight != referenceStackHeight || result.PieceRotations[0] < 0 || \
+            result.PieceRotations[0] >= (sequenceParams->AllowRotation == TRUE ? getRotations(sequenceParams->Sequence[piece]) : 1) || result.PieceColumns[0] < 0 || \
+            result.PieceColumns[0] > sequenceParams->GridWidth - getTetromino(sequenceParams->Sequence[piece], result.PieceRotations[0])->Width)
+        {
+            printf("FAILED %.*s %c, width %d, solved online: window %.*s at piece %d, reference height %d, stream height %d, placement %d(%d)\n", sequenceParams->Size, sequenceParams->Sequence, \
+                sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, windowParams.Size, windowParams.Sequence, piece, referenceStackHeight, result.StackHeight, \
+                result.PieceColumns[0], result.PieceRotations[0] * 90);
+            return FALSE;
+        }
+
+        tet = getTetromino(sequenceParams->Sequence[piece], result.PieceRotations[0]);
+        dropTetrominoToGrid(tet, result.PieceColumns[0], grid, &gridSkyline);
+    }
+
+    if (getStackHeight(gridSkyline) == getStreamStackHeight(&stream)) return TRUE;
+
+    printf("FAILED %.*s %c, width %d, solved online: placements drop to %d, stream height %d\n", sequenceParams->Size, sequenceParams->Sequence, \
+        sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, getStackHeight(gridSkyline), getStreamStackHeight(&stream));
+    return FALSE;
+}
+
+// Solve the sequence in 'sequenceParams' and each of its prefixes, with the whole sequence added twice, as one prefix trie searched with the limits and solution cache of 'solveContext', and check that the stack height of the sequence is 'referenceStackHeight',
+// that of each prefix is its reference stack height, and that the placements of each drop to its stack height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzTrie(solve_context *solveContext, sequence_params *sequenceParams, int referenceStackHeight)
+{
+    prefix_trie *trie = malloc(sizeof(prefix_trie));
+    int referenceStackHeights[MAX_SEQUENCE_SIZE + 1];
+    sequence_params prefixParams;
+    trie_sequence *entry;
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    int droppedStackHeight;
+    int allocated;
+    int passed = TRUE;
+
+    if (trie == NULL || createPrefixTrie(trie, sequenceParams->GridWidth, solveContext) == FALSE)
+    {
+        printf("FAILED %.*s %c, width %d, solved as a prefix trie: the trie couldn't be allocated\n", sequenceParams->Size, sequenceParams->Sequence, \
+            sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth);
+        free(trie);
+        return FALSE;
+    }
+
+    memset(grid, '_', sizeof(grid));
+    prefixParams = *sequenceParams;
+
+    // Each prefix ends at a node on the path of the whole sequence, so the search of the path serves all of them
+    for (int size = 1; size <= sequenceParams->Size; size++)
+    {
+        prefixParams.Size = size;
+        referenceStackHeights[size] = size == sequenceParams->Size ? referenceStackHeight : getReferenceStackHeight(&prefixParams, 0, grid, 0);
+    }
+
+    allocated = addTrieSequence(trie, sequenceParams->Sequence, sequenceParams->Size, sequenceParams->AllowRotation, 0);
+    for (int size = 1; size <= sequenceParams->Size && allocated == TRUE; size++)
+        allocated = addTrieSequence(trie, sequenceParams->Sequence, size, sequenceParams->AllowRotation, size);
+
+    if (allocated == TRUE) solvePrefixTrie(trie);
+
+    for (int sequence = 0; sequence < trie->SequenceCount && allocated == TRUE; sequence++)
+    {
+        entry = &trie->Sequences[sequence];
+        prefixParams.Size = entry->Size;
+
+        // Replay the placements on a grid, which also checks that each one is inside the grid
+        droppedStackHeight = getTestPermutationStackHeight(&prefixParams, entry->Result.PieceColumns, entry->Result.PieceRotations);
+        if (entry->Result.Status == SOLVE_OK && entry->Result.Optimal == TRUE && entry->Result.StackHeight == referenceStackHeights[entry->Size] && droppedStackHeight == entry->Result.StackHeight) continue;
+
+        printf("FAILED %.*s %c, width %d, solved as a prefix trie: prefix of %d piece(s), reference height %d, trie height %d, placements drop to %d%s\n", sequenceParams->Size, sequenceParams->Sequence, \
+            sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth, entry->Size, referenceStackHeights[entry->Size], entry->Result.StackHeight, droppedStackHeight, \
+            entry->Result.Optimal == TRUE ? "" : ", not proven optimal");
+        passed = FALSE;
+    }
+
+    if (allocated == FALSE)
+    {
+        printf("FAILED %.*s %c, width %d, solved as a prefix trie: a sequence couldn't be added\n", sequenceParams->Size, sequenceParams->Sequence, \
+            sequenceParams->AllowRotation == TRUE ? 'Y' : 'N', sequenceParams->GridWidth);
+        passed = FALSE;
+    }
+
+    destroyPrefixTrie(trie);
+    free(trie);
+    return passed;
+}
+
+// Solve the number of random sequences set in 'solverSettings', generated from its fuzz seed, with the reference enumerator, each engine configuration, beam search, online solving and a prefix trie, and compare their stack heights. Return TRUE if every engine matched the reference on every sequence, FALSE otherwise
+int runFuzz(solver_settings *solverSettings)
+{
+    // One solver, two solvers sharing work, every solver with and without the transposition table, and every solver stopping at its first limit check
+    fuzz_engine engines[NUMBER_OF_FUZZ_ENGINES] = {{1, TRUE, 0, NULL}, {2, TRUE, 0, NULL}, {0, TRUE, 0, NULL}, {0, FALSE, 0, NULL}, {0, TRUE, LIMIT_CHECK_INTERVAL, NULL}};
+    solver_settings engineSettings;
+    beam_search beamSearch;
+    sequence_params sequenceParams;
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    uint64_t seed = solverSettings->FuzzSeed != 0 ? solverSettings->FuzzSeed : (uint64_t) time(NULL);
+    uint64_t state = seed;
+    int referenceStackHeight;
+    int passed;
+    int passedCases = 0;
+    int failedCases = 0;
+    int allocated = TRUE;
+    int beamCreated;
+
+    for (int engine = 0; engine < NUMBER_OF_FUZZ_ENGINES; engine++)
+    {
+        // Solutions are never cached, as each engine has to find its own
+        engineSettings = *solverSettings;
+        engineSettings.NumberOfSolvers = engines[engine].Threads != 0 && engines[engine].Threads < solverSettings->NumberOfSolvers ? engines[engine].Threads : solverSettings->NumberOfSolvers;
+        engineSettings.TranspositionTableMegabytes = engines[engine].TableEnabled == TRUE ? solverSettings->TranspositionTableMegabytes : 0;
+        engineSettings.CacheFile = NULL;
+        engineSettings.ShowProgress = FALSE;
+
+        engines[engine].SolveContext = createSolveContext(&engineSettings);
+        if (engines[engine].SolveContext == NULL) allocated = FALSE;
+    }
+
+    beamCreated = createBeamSearch(&beamSearch, FUZZ_BEAM_WIDTH, solverSettings);
+    if (beamCreated == FALSE) allocated = FALSE;
+
+    if (allocated == FALSE) printf("Could not allocate the solvers, transposition table and beam search, can't fuzz!\n");
+
+    else
+    {
+        // The seed is printed first, so that a failing run can be repeated with --fuzz-seed
+        printf("Fuzzing %d random sequence(s) with seed %llu, up to %d permutations each...\n", solverSettings->FuzzCases, (unsigned long long) seed, FUZZ_MAX_REFERENCE_PERMUTATIONS);
+        fflush(stdout);
+
+        memset(grid, '_', sizeof(grid));
+
+        for (int fuzzCase = 0; fuzzCase < solverSettings->FuzzCases; fuzzCase++)
+        {
+            generateFuzzSequence(&state, &sequenceParams);
+            referenceStackHeight = getReferenceStackHeight(&sequenceParams, 0, grid, 0);
+            passed = TRUE;
+
+            for (int engine = 0; engine < NUMBER_OF_FUZZ_ENGINES; engine++)
+                if (checkFuzzEngine(&engines[engine], &sequenceParams, referenceStackHeight) == FALSE) passed = FALSE;
+
+            if (checkFuzzBeam(&beamSearch, &sequenceParams, referenceStackHeight) == FALSE) passed = FALSE;
+
+            // Windows are solved by the engine using every solver and the transposition table, which keeps the bounds of each window for the next
+            if (checkFuzzStream(engines[2].SolveContext, &sequenceParams) == FALSE) passed = FALSE;
+            if (checkFuzzTrie(engines[0].SolveContext, &sequenceParams, referenceStackHeight) == FALSE) passed = FALSE;
+
+            if (passed == TRUE) passedCases++;
+            else failedCases++;
+        }
+
+        printf("PASSED %d sequence(s), FAILED %d sequence(s)\n", passedCases, failedCases);
+    }
+
+    for (int engine = 0; engine < NUMBER_OF_FUZZ_ENGINES; engine++)
+        if (engines[engine].SolveContext != NULL) destroySolveContext(engines[engine].SolveContext);
+    if (beamCreated == TRUE) destroyBeamSearch(&beamSearch);
+
+    return allocated == TRUE && failedCases == 0 ? TRUE : FALSE;
+}
@@ -0,0 +1,57 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "beam_search.h"
+#include "prefix_trie.h"
+#include "grid.h"
+#include "permutation_count.h"
+
+#define FUZZ_PIECES "IJLOSTZ" // Pieces the random sequences are drawn from, with repeats
+#define FUZZ_MAX_REFERENCE_PERMUTATIONS 2000000 // Most permutations a random sequence may have, as the reference enumerator tries every one of them
+#define NUMBER_OF_FUZZ_ENGINES 5
+#define FUZZ_BEAM_WIDTH 16 // Narrow enough that the beam search often misses the lowest stack, so that its placements are checked on stacks of every height
+#define FUZZ_STREAM_WINDOW 3 // Pieces in each window of a random sequence solved online, short enough for the reference enumerator to check every window
+
+typedef struct // Stores a configuration of the optimised engine which random sequences are solved with
+{
+    int Threads; // Capped at the number of solvers in the settings. 0 uses all of them
+    int TableEnabled; // If FALSE, the engine runs without a transposition table
+    uint64_t NodeBudget; // Nodes after which the engine's searches stop, in which case its stack need only be no lower than the reference and its lower bound no higher, unless it proved its stack the lowest. 0 if its searches run to completion
+    solve_context *SolveContext;
+} fuzz_engine;
+
+// Fill 'sequenceParams' with a random sequence, grid width and rotation flag, using and advancing the generator state 'state'. The sequence is cut short before it has more than FUZZ_MAX_REFERENCE_PERMUTATIONS permutations
+void generateFuzzSequence(uint64_t *state, sequence_params *sequenceParams);
+
+// Return the number of permutations of the sequence in 'sequenceParams', counting every rotation of each piece if rotation is allowed
+permutation_count getFuzzPermutations(sequence_params *sequenceParams);
+
+// Return the height of the topmost filled cell in column 'column' of 'grid', no higher than 'stackHeight', or 0 if the column is empty
+int getReferenceColumnHeight(char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int column, int stackHeight);
+
+// Return the lowest stack height reached by trying every permutation of the pieces from 'piece' onwards of the sequence in 'sequenceParams' on 'grid', whose stack is 'stackHeight' high, without any pruning. Only the cells of 'grid' are used, so that the result doesn't depend on the skylines the solvers search with
+int getReferenceStackHeight(sequence_params *sequenceParams, int piece, char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int stackHeight);
+
+// Solve the sequence in 'sequenceParams' with the engine 'engine', and check that its stack height is 'referenceStackHeight', or no lower than it and above its lower bound if its search was stopped, and that its placements drop to that height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzEngine(fuzz_engine *engine, sequence_params *sequenceParams, int referenceStackHeight);
+
+// Drop the sequence in 'sequenceParams' with 'beamSearch', and check that its stack height is no lower than 'referenceStackHeight' and that its placements drop to that height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzBeam(beam_search *beamSearch, sequence_params *sequenceParams, int referenceStackHeight);
+
+// Solve the sequence in 'sequenceParams' online in 'solveContext', one piece at a time, each dropped at its placement in the solution of a window of the next FUZZ_STREAM_WINDOW pieces. Check that the stack height of each window is the reference stack height of the window on the grid the stream has stacked so far,
+// and that the placements dropped stack to the height of the stream. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzStream(solve_context *solveContext, sequence_params *sequenceParams);
+
+// Solve the sequence in 'sequenceParams' and each of its prefixes, with the whole sequence added twice, as one prefix trie searched with the limits and solution cache of 'solveContext', and check that the stack height of the sequence is 'referenceStackHeight',
+// that of each prefix is its reference stack height, and that the placements of each drop to its stack height. Print the case and return FALSE if not, return TRUE otherwise
+int checkFuzzTrie(solve_context *solveContext, sequence_params *sequenceParams, int referenceStackHeight);
+
+// Solve the number of random sequences set in 'solverSettings', generated from its fuzz seed, with the reference enumerator, each engine configuration, beam search, online solving and a prefix trie, and compare their stack heights. Return TRUE if every engine matched the reference on every sequence, FALSE otherwise
+int runFuzz(solver_settings *solverSettings);
+
+#endif
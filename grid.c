@@ -4,15 +4,16 @@
 #include "grid.h"
 #include "tetromino.h"
 #include "solver.h"
+#include "skyline.h"
 
-// Print the state of 'grid'.
-void printGrid(char grid[GRID_HEIGHT][GRID_WIDTH])
+// Print the state of the first 'gridWidth' columns of 'grid'
+void printGrid(char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int gridWidth)
 {
     printf("\n");
     
     for (int row = 0; row < GRID_HEIGHT; row++)
     {
-        for (int col = 0; col < GRID_WIDTH; col++) 
+        for (int col = 0; col < gridWidth; col++) 
             printf("%c ", grid[row][col]);            
         printf("\n");
     }    
@@ -20,10 +21,10 @@ void printGrid(char grid[GRID_HEIGHT][GRID_WIDTH])
     printf("\n");
 }
 
-// Drop tetromino 'tet' into column 'droppedColumn' and update the state of the grid through 'grid' and 'gridColumnHeights'. If the tetromino lands above the top of the grid, return FALSE and abort the dropping. Return TRUE otherwise
-int dropTetrominoToGrid(tetromino *tet, int droppedColumn, char grid[GRID_HEIGHT][GRID_WIDTH], int gridColumnHeights[GRID_WIDTH])
+// Drop tetromino 'tet' into column 'droppedColumn' and update the state of the grid through 'grid' and 'gridSkyline'. If the tetromino lands above the top of the grid, return FALSE and abort the dropping. Return TRUE otherwise
+int dropTetrominoToGrid(tetromino *tet, int droppedColumn, char grid[GRID_HEIGHT][MAX_GRID_WIDTH], skyline *gridSkyline)
 {
-    int landingHeight = getLandingHeight(tet, droppedColumn, gridColumnHeights);
+    int landingHeight = getLandingHeight(tet, droppedColumn, *gridSkyline);
 
     if ((landingHeight - 1) + tet->Height >= GRID_HEIGHT) return FALSE;
     
@@ -38,7 +39,7 @@ int dropTetrominoToGrid(tetromino *tet, int droppedColumn, char grid[GRID_HEIGHT
             {
                 drawingRow = landingRow + (tetRow - 3);
                 grid[drawingRow][droppedColumn + tetCol] = tet->Pattern[tetRow][tetCol];
-                gridColumnHeights[droppedColumn + tetCol] = GRID_HEIGHT - drawingRow;
+                *gridSkyline = raiseColumnHeight(*gridSkyline, droppedColumn + tetCol, GRID_HEIGHT - drawingRow);
             }
         }
     }
@@ -2,14 +2,27 @@
 #define GRID_H
 
 #include "tetromino.h"
+#include "skyline.h"
 
 #define GRID_HEIGHT (MAX_SEQUENCE_SIZE * 4)
-#define GRID_WIDTH 6
+#define MIN_GRID_WIDTH 4 // The widest tetromino must fit
+#define DEFAULT_GRID_WIDTH 6
 
-// Print the state of 'grid', and the height of each column from 'columnHeight'
-void printGrid(char grid[GRID_HEIGHT][GRID_WIDTH]);
+// The solver stores the grid state as a skyline, which holds a byte per column. Each width up to MAX_GRID_WIDTH has a search kernel specialised for it
+#define MAX_GRID_WIDTH 12
 
-// Drop tetromino 'tet' into column 'droppedColumn' and update the state of the grid through 'grid' and 'gridColumnHeights'. If the tetromino lands above the top of the grid, return FALSE and abort the dropping. Return TRUE otherwise
-int dropTetrominoToGrid(tetromino *tet, int droppedColumn, char grid[GRID_HEIGHT][GRID_WIDTH], int gridColumnHeights[GRID_WIDTH]);
+#if MAX_GRID_WIDTH > MAX_SKYLINE_COLUMNS
+#error MAX_GRID_WIDTH is too wide for a skyline
+#endif
 
-#endif
\ No newline at end of file
+#if GRID_HEIGHT + 4 > MAX_SKYLINE_HEIGHT
+#error GRID_HEIGHT is too high for a skyline. Reduce MAX_SEQUENCE_SIZE
+#endif
+
+// Print the state of the first 'gridWidth' columns of 'grid'
+void printGrid(char grid[GRID_HEIGHT][MAX_GRID_WIDTH], int gridWidth);
+
+// Drop tetromino 'tet' into column 'droppedColumn' and update the state of the grid through 'grid' and 'gridSkyline'. If the tetromino lands above the top of the grid, return FALSE and abort the dropping. Return TRUE otherwise
+int dropTetrominoToGrid(tetromino *tet, int droppedColumn, char grid[GRID_HEIGHT][MAX_GRID_WIDTH], skyline *gridSkyline);
+
+#endif
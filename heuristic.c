@@ -0,0 +1,79 @@
+#include <stdlib.h>
+#include <limits.h>
+
+#include "heuristic.h"
+#include "placement.h"
+#include "skyline.h"
+
+// Return a score for the grid state in 'gridSkyline' before the pieces from 'nextPiece' onwards in 'placementTable' are dropped. Lower scores are better: the lower bound on the final stack height comes first, then the stack height, then the area under the skyline, i.e. the cells covered including holes
+int getGridStateScore(placement_table *placementTable, int nextPiece, skyline gridSkyline)
+{
+    // The area of a skyline at most MAX_SKYLINE_COLUMNS wide and GRID_HEIGHT + 4 high fits in 11 bits, and each height in 8 bits above it
+    return (getStackHeightBound(placementTable, nextPiece, gridSkyline, placementTable->GridWidth) << 19) | (getSkylineHeight(gridSkyline) << 11) | getSkylineArea(gridSkyline);
+}
+
+// Return the best score of the grid states reached by dropping the next 'lookahead' pieces from 'piece' onwards in 'placementTable' onto 'gridSkyline', out of the 'size' pieces in the sequence
+int getLookaheadScore(placement_table *placementTable, int size, int piece, int lookahead, skyline gridSkyline)
+{
+    int bestScore = INT_MAX;
+    int score;
+    placement *piecePlacement;
+
+    if (lookahead == 0 || piece == size) return getGridStateScore(placementTable, piece, gridSkyline);
+
+    for (int rotation = 0; rotation < placementTable->RotationCounts[piece]; rotation++)
+    {
+        for (int column = 0; column < placementTable->ColumnCounts[piece][rotation]; column++)
+        {
+            piecePlacement = &placementTable->Placements[placementTable->FirstPlacements[piece][rotation] + column];
+            score = getLookaheadScore(placementTable, size, piece + 1, lookahead - 1, dropPlacement(piecePlacement, gridSkyline));
+
+            if (score < bestScore) bestScore = score;
+        }
+    }
+
+    return bestScore;
+}
+
+// Drop the 'size' pieces in 'placementTable' onto the grid state 'rootSkyline' one by one. The first 'plannedPieces' pieces are dropped at the columns and rotations already in 'pieceColumns' and 'pieceRotations', the others each at the placement with the best score after looking ahead GREEDY_LOOKAHEAD_PIECES pieces.
+// Return the column and rotation of each piece in 'pieceColumns' and 'pieceRotations', and return the resulting stack height
+int getGreedyPermutation(placement_table *placementTable, int size, skyline rootSkyline, int plannedPieces, int pieceColumns[], int pieceRotations[])
+{
+    skyline gridSkyline = rootSkyline;
+    placement *piecePlacement;
+    placement *bestPlacement;
+    int bestScore;
+    int score;
+
+    for (int piece = 0; piece < size; piece++)
+    {
+        bestPlacement = NULL;
+        bestScore = INT_MAX;
+
+        for (int rotation = 0; rotation < placementTable->RotationCounts[piece]; rotation++)
+        {
+            for (int column = 0; column < placementTable->ColumnCounts[piece][rotation]; column++)
+            {
+                piecePlacement = &placementTable->Placements[placementTable->FirstPlacements[piece][rotation] + column];
+
+                // A planned piece only has one placement to choose from
+                if (piece < plannedPieces)
+                    score = piecePlacement->Column == pieceColumns[piece] && piecePlacement->Rotation == pieceRotations[piece] ? 0 : INT_MAX;
+                else
+                    score = getLookaheadScore(placementTable, size, piece + 1, GREEDY_LOOKAHEAD_PIECES - 1, dropPlacement(piecePlacement, gridSkyline));
+
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    bestPlacement = piecePlacement;
+                }
+            }
+        }
+
+        gridSkyline = dropPlacement(bestPlacement, gridSkyline);
+        pieceColumns[piece] = bestPlacement->Column;
+        pieceRotations[piece] = bestPlacement->Rotation;
+    }
+
+    return getSkylineHeight(gridSkyline);
+}
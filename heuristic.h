@@ -0,0 +1,19 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "placement.h"
+#include "skyline.h"
+
+#define GREEDY_LOOKAHEAD_PIECES 2 // Number of pieces, starting from the piece being placed, whose placements are tried before choosing one
+
+// Return a score for the grid state in 'gridSkyline' before the pieces from 'nextPiece' onwards in 'placementTable' are dropped. Lower scores are better: the lower bound on the final stack height comes first, then the stack height, then the area under the skyline, i.e. the cells covered including holes
+int getGridStateScore(placement_table *placementTable, int nextPiece, skyline gridSkyline);
+
+// Return the best score of the grid states reached by dropping the next 'lookahead' pieces from 'piece' onwards in 'placementTable' onto 'gridSkyline', out of the 'size' pieces in the sequence
+int getLookaheadScore(placement_table *placementTable, int size, int piece, int lookahead, skyline gridSkyline);
+
+// Drop the 'size' pieces in 'placementTable' onto the grid state 'rootSkyline' one by one. The first 'plannedPieces' pieces are dropped at the columns and rotations already in 'pieceColumns' and 'pieceRotations', the others each at the placement with the best score after looking ahead GREEDY_LOOKAHEAD_PIECES pieces.
+// Return the column and rotation of each piece in 'pieceColumns' and 'pieceRotations', and return the resulting stack height
+int getGreedyPermutation(placement_table *placementTable, int size, skyline rootSkyline, int plannedPieces, int pieceColumns[], int pieceRotations[]);
+
+#endif
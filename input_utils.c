@@ -1,9 +1,417 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 
 #include "bool.h"
 #include "input_utils.h"
 #include "tetromino.h"
 #include "grid.h"
+#include "thread_utils.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+#include "benchmark.h"
+#include "beam_search.h"
+#include "distributed.h"
+
+// Parse the number of solver threads in 'text' into 'numberOfSolvers'. Return TRUE if 'text' is a number between 1 and MAX_SOLVERS, FALSE otherwise
+int parseNumberOfSolvers(const char *text, int *numberOfSolvers)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > MAX_SOLVERS) return FALSE;
+
+    *numberOfSolvers = (int) number;
+    return TRUE;
+}
+
+// Parse the index of the allowed CPU the first solver thread is pinned to in 'text' into 'cpu'. Return TRUE if 'text' is a number between 0 and MAX_SOLVERS - 1, FALSE otherwise
+int parseFirstPinnedCpu(const char *text, int *cpu)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 0 || number >= MAX_SOLVERS) return FALSE;
+
+    *cpu = (int) number;
+    return TRUE;
+}
+
+// Parse the size of the transposition table in megabytes in 'text' into 'megabytes'. Return TRUE if 'text' is a number between 0 and MAX_TRANSPOSITION_TABLE_MEGABYTES, FALSE otherwise
+int parseTranspositionTableSize(const char *text, int *megabytes)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 0 || number > MAX_TRANSPOSITION_TABLE_MEGABYTES) return FALSE;
+
+    *megabytes = (int) number;
+    return TRUE;
+}
+
+// Parse the seconds between checkpoints in 'text' into 'seconds'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseCheckpointInterval(const char *text, int *seconds)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > INT_MAX) return FALSE;
+
+    *seconds = (int) number;
+    return TRUE;
+}
+
+// Parse the milliseconds between telemetry snapshots in 'text' into 'milliseconds'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseTelemetryInterval(const char *text, int *milliseconds)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > INT_MAX) return FALSE;
+
+    *milliseconds = (int) number;
+    return TRUE;
+}
+
+// Parse the time limit in milliseconds in 'text' into 'milliseconds'. Return TRUE if 'text' is a number of at least 0, FALSE otherwise
+int parseTimeLimit(const char *text, int *milliseconds)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 0 || number > INT_MAX) return FALSE;
+
+    *milliseconds = (int) number;
+    return TRUE;
+}
+
+// Parse the node budget in 'text' into 'nodes'. Return TRUE if 'text' is a number of at least 0, FALSE otherwise
+int parseNodeBudget(const char *text, uint64_t *nodes)
+{
+    char *end;
+    unsigned long long number = strtoull(text, &end, 10);
+
+    if (end == text || *end != '\0' || *text == '-') return FALSE;
+
+    *nodes = (uint64_t) number;
+    return TRUE;
+}
+
+// Parse the percent by which benchmark results may be worse than the baseline in 'text' into 'percent'. Return TRUE if 'text' is a number between 0 and 1000, FALSE otherwise
+int parseBenchmarkTolerance(const char *text, int *percent)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 0 || number > 1000) return FALSE;
+
+    *percent = (int) number;
+    return TRUE;
+}
+
+// Parse the number of random sequences to fuzz in 'text' into 'fuzzCases'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseFuzzCases(const char *text, int *fuzzCases)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > INT_MAX) return FALSE;
+
+    *fuzzCases = (int) number;
+    return TRUE;
+}
+
+// Parse the seed of the random sequences to fuzz in 'text' into 'seed'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseFuzzSeed(const char *text, uint64_t *seed)
+{
+    char *end;
+    unsigned long long number = strtoull(text, &end, 10);
+
+    if (end == text || *end != '\0' || *text == '-' || number == 0) return FALSE;
+
+    *seed = (uint64_t) number;
+    return TRUE;
+}
+
+// Parse the beam width in 'text' into 'beamWidth'. Return TRUE if 'text' is a number between 1 and MAX_BEAM_WIDTH, FALSE otherwise
+int parseBeamWidth(const char *text, int *beamWidth)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > MAX_BEAM_WIDTH) return FALSE;
+
+    *beamWidth = (int) number;
+    return TRUE;
+}
+
+// Parse the grid width in 'text' into 'gridWidth'. Return TRUE if 'text' is a number between MIN_GRID_WIDTH and MAX_GRID_WIDTH, FALSE otherwise
+int parseGridWidth(const char *text, int *gridWidth)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < MIN_GRID_WIDTH || number > MAX_GRID_WIDTH) return FALSE;
+
+    *gridWidth = (int) number;
+    return TRUE;
+}
+
+// Parse the TCP port in 'text' into 'port'. Return TRUE if 'text' is a number between 1 and 65535, FALSE otherwise
+int parseNodePort(const char *text, int *port)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > 65535) return FALSE;
+
+    *port = (int) number;
+    return TRUE;
+}
+
+// Parse the number of workers the coordinator waits for in 'text' into 'workers'. Return TRUE if 'text' is a number between 1 and MAX_WORKERS, FALSE otherwise
+int parseWorkerCount(const char *text, int *workers)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > MAX_WORKERS) return FALSE;
+
+    *workers = (int) number;
+    return TRUE;
+}
+
+// Parse the address of a coordinator in 'text', HOST:PORT with an IPv6 host in brackets, into 'host' and 'port'. Return TRUE if 'text' is a valid address, FALSE otherwise
+int parseNodeAddress(const char *text, char host[MAX_NODE_HOST_LENGTH], int *port)
+{
+    const char *separator = strrchr(text, ':');
+    size_t hostLength;
+
+    if (separator == NULL || parseNodePort(separator + 1, port) == FALSE) return FALSE;
+
+    // The colons of an IPv6 address are told apart from the port's by the brackets around it
+    if (*text == '[' && separator > text + 1 && separator[-1] == ']')
+    {
+        text++;
+        hostLength = (size_t) (separator - text) - 1;
+    }
+
+    else hostLength = (size_t) (separator - text);
+
+    if (hostLength == 0 || hostLength >= MAX_NODE_HOST_LENGTH || memchr(text, '[', hostLength) != NULL || memchr(text, ']', hostLength) != NULL) return FALSE;
+
+    memcpy(host, text, hostLength);
+    host[hostLength] = '\0';
+    return TRUE;
+}
+
+// Set 'solverSettings' to the settings used when neither the environment nor the command line set them
+void getDefaultSolverSettings(solver_settings *solverSettings)
+{
+    solverSettings->NumberOfSolvers = getAllowedCpuCount();
+    solverSettings->PinSolverThreads = TRUE;
+    solverSettings->FirstPinnedCpu = NO_PINNED_CPU;
+    solverSettings->TranspositionTableMegabytes = DEFAULT_TRANSPOSITION_TABLE_MEGABYTES;
+    solverSettings->ShowProgress = TRUE;
+    solverSettings->BatchFile = NULL;
+    solverSettings->BatchGrids = FALSE;
+    solverSettings->BeamWidth = 0;
+    solverSettings->BatchTrie = FALSE;
+    solverSettings->CacheFile = NULL;
+    solverSettings->CheckpointFile = NULL;
+    solverSettings->CheckpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+    solverSettings->ResumeCheckpoint = FALSE;
+    solverSettings->GridWidth = DEFAULT_GRID_WIDTH;
+    solverSettings->TelemetryFile = NULL;
+    solverSettings->TelemetryInterval = DEFAULT_TELEMETRY_INTERVAL;
+    solverSettings->TimeLimit = 0;
+    solverSettings->NodeBudget = 0;
+    solverSettings->BenchmarkFile = NULL;
+    solverSettings->BaselineFile = NULL;
+    solverSettings->BenchmarkTolerance = DEFAULT_BENCHMARK_TOLERANCE;
+    solverSettings->FuzzCases = 0;
+    solverSettings->FuzzSeed = 0;
+    solverSettings->CoordinatorPort = 0;
+    solverSettings->CoordinatedWorkers = 0;
+    solverSettings->CoordinatorAddress = NULL;
+
+    if (solverSettings->NumberOfSolvers > MAX_SOLVERS) solverSettings->NumberOfSolvers = MAX_SOLVERS;
+}
+
+// Receive the solver settings into 'solverSettings' from the environment and the command line arguments in 'argv', which take precedence. Print the usage and return FALSE if an argument is invalid, return TRUE otherwise
+int getSolverSettings(int argc, char *argv[], solver_settings *solverSettings)
+{
+    char *solverThreadsVariable = getenv(SOLVER_THREADS_VARIABLE);
+    char host[MAX_NODE_HOST_LENGTH];
+    int port;
+
+    getDefaultSolverSettings(solverSettings);
+
+    if (solverThreadsVariable != NULL && parseNumberOfSolvers(solverThreadsVariable, &solverSettings->NumberOfSolvers) == FALSE)
+    {
+        printf("%s must be a number between 1 and %d, not '%s'\n", SOLVER_THREADS_VARIABLE, MAX_SOLVERS, solverThreadsVariable);
+        return FALSE;
+    }
+
+    for (int arg = 1; arg < argc; arg++)
+    {
+        if ((strcmp(argv[arg], "--threads") == 0 || strcmp(argv[arg], "-t") == 0) && arg + 1 < argc && \
+            parseNumberOfSolvers(argv[arg + 1], &solverSettings->NumberOfSolvers) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--no-pinning") == 0) 
+            solverSettings->PinSolverThreads = FALSE;
+
+        else if (strcmp(argv[arg], "--first-cpu") == 0 && arg + 1 < argc && \
+            parseFirstPinnedCpu(argv[arg + 1], &solverSettings->FirstPinnedCpu) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--table-size") == 0 && arg + 1 < argc && \
+            parseTranspositionTableSize(argv[arg + 1], &solverSettings->TranspositionTableMegabytes) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--width") == 0 && arg + 1 < argc && \
+            parseGridWidth(argv[arg + 1], &solverSettings->GridWidth) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--batch") == 0 && arg + 1 < argc)
+        {
+            solverSettings->BatchFile = argv[++arg];
+            solverSettings->ShowProgress = FALSE;
+        }
+
+        else if (strcmp(argv[arg], "--grids") == 0)
+            solverSettings->BatchGrids = TRUE;
+
+        else if (strcmp(argv[arg], "--beam") == 0 && arg + 1 < argc && \
+            parseBeamWidth(argv[arg + 1], &solverSettings->BeamWidth) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--trie") == 0)
+            solverSettings->BatchTrie = TRUE;
+
+        else if (strcmp(argv[arg], "--cache") == 0 && arg + 1 < argc)
+            solverSettings->CacheFile = argv[++arg];
+
+        else if (strcmp(argv[arg], "--checkpoint") == 0 && arg + 1 < argc)
+            solverSettings->CheckpointFile = argv[++arg];
+
+        else if (strcmp(argv[arg], "--checkpoint-interval") == 0 && arg + 1 < argc && \
+            parseCheckpointInterval(argv[arg + 1], &solverSettings->CheckpointInterval) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--resume") == 0)
+            solverSettings->ResumeCheckpoint = TRUE;
+
+        else if (strcmp(argv[arg], "--telemetry") == 0 && arg + 1 < argc)
+            solverSettings->TelemetryFile = argv[++arg];
+
+        else if (strcmp(argv[arg], "--telemetry-interval") == 0 && arg + 1 < argc && \
+            parseTelemetryInterval(argv[arg + 1], &solverSettings->TelemetryInterval) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--time-limit") == 0 && arg + 1 < argc && \
+            parseTimeLimit(argv[arg + 1], &solverSettings->TimeLimit) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--node-budget") == 0 && arg + 1 < argc && \
+            parseNodeBudget(argv[arg + 1], &solverSettings->NodeBudget) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--benchmark") == 0 && arg + 1 < argc)
+            solverSettings->BenchmarkFile = argv[++arg];
+
+        else if (strcmp(argv[arg], "--baseline") == 0 && arg + 1 < argc)
+            solverSettings->BaselineFile = argv[++arg];
+
+        else if (strcmp(argv[arg], "--tolerance") == 0 && arg + 1 < argc && \
+            parseBenchmarkTolerance(argv[arg + 1], &solverSettings->BenchmarkTolerance) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--fuzz") == 0 && arg + 1 < argc && \
+            parseFuzzCases(argv[arg + 1], &solverSettings->FuzzCases) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--fuzz-seed") == 0 && arg + 1 < argc && \
+            parseFuzzSeed(argv[arg + 1], &solverSettings->FuzzSeed) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--coordinate") == 0 && arg + 1 < argc && \
+            parseNodePort(argv[arg + 1], &solverSettings->CoordinatorPort) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--workers") == 0 && arg + 1 < argc && \
+            parseWorkerCount(argv[arg + 1], &solverSettings->CoordinatedWorkers) == TRUE)
+            arg++;
+
+        else if (strcmp(argv[arg], "--worker") == 0 && arg + 1 < argc && \
+            parseNodeAddress(argv[arg + 1], host, &port) == TRUE)
+            solverSettings->CoordinatorAddress = argv[++arg];
+
+        else 
+        {
+            printUsage(argv[0]);
+            return FALSE;
+        }
+    }
+
+    // A search is only resumed from a checkpoint file, batch mode, the benchmark and the fuzz harness don't checkpoint their searches, and results are only compared with a baseline by the benchmark.
+    // Beam search is only run by batch mode, whose grids are only printed for sequences short enough to fit in GRID_HEIGHT, and batches are only solved as a trie by exhaustive search.
+    // Only batch mode coordinates workers, which search each sequence exhaustively without a solution cache or node budget, and the coordinator sets the limits on a worker's search
+    if ((solverSettings->ResumeCheckpoint == TRUE && solverSettings->CheckpointFile == NULL) || (solverSettings->BaselineFile != NULL && solverSettings->BenchmarkFile == NULL) || \
+        (solverSettings->BeamWidth != 0 && (solverSettings->BatchFile == NULL || solverSettings->BatchGrids == TRUE)) || \
+        (solverSettings->BatchTrie == TRUE && (solverSettings->BatchFile == NULL || solverSettings->BeamWidth != 0)) || \
+        (solverSettings->CheckpointFile != NULL && (solverSettings->BatchFile != NULL || solverSettings->BenchmarkFile != NULL || solverSettings->FuzzCases != 0)) || \
+        (solverSettings->CoordinatorPort != 0 && (solverSettings->BatchFile == NULL || solverSettings->BeamWidth != 0 || solverSettings->BatchTrie == TRUE || \
+                                                  solverSettings->CacheFile != NULL || solverSettings->NodeBudget != 0)) || \
+        (solverSettings->CoordinatedWorkers != 0 && solverSettings->CoordinatorPort == 0) || \
+        (solverSettings->CoordinatorAddress != NULL && (solverSettings->CacheFile != NULL || solverSettings->CheckpointFile != NULL || \
+                                                        solverSettings->TimeLimit != 0 || solverSettings->NodeBudget != 0)) || \
+        (solverSettings->BatchFile != NULL) + (solverSettings->BenchmarkFile != NULL) + (solverSettings->FuzzCases != 0) + (solverSettings->CoordinatorAddress != NULL) > 1)
+    {
+        printUsage(argv[0]);
+        return FALSE;
+    }
+
+    // Several workers may run on one machine, so unless told which CPUs to use they leave their threads to the OS rather than all pinning them from CPU 0
+    if (solverSettings->FirstPinnedCpu == NO_PINNED_CPU && solverSettings->CoordinatorAddress == NULL) solverSettings->FirstPinnedCpu = 0;
+
+    return TRUE;
+}
+
+// Print the command line arguments accepted by the program 'program'
+void printUsage(const char *program)
+{
+    printf("Usage: %s [--threads N] [--no-pinning] [--first-cpu C] [--table-size MB] [--width W] [--batch FILE [--grids | --beam K] [--trie]] [--cache FILE] [--checkpoint FILE [--checkpoint-interval S] [--resume]] [--telemetry FILE [--telemetry-interval MS]] [--time-limit MS] [--node-budget N] [--benchmark FILE [--baseline FILE] [--tolerance PCT]] [--fuzz N [--fuzz-seed S]] [--coordinate PORT [--workers N] | --worker HOST:PORT]\n" \
+        "  --threads, -t N          Run N solver threads (1 to %d). Defaults to %s if set, otherwise the number of CPUs the process may run on\n" \
+        "  --no-pinning             Let the OS schedule solver threads on any core instead of pinning each to its own core\n" \
+        "  --first-cpu C            Pin the solver threads to the allowed CPUs from the C-th on. Defaults to 0, except for workers, which are only pinned if it is set\n" \
+        "  --table-size MB          Use MB megabytes (0 to %d) for the transposition table shared by the solver threads. 0 disables it. Defaults to %d\n" \
+        "  --width W                Solve sequences in a grid W columns wide (%d to %d). A resumed search keeps the width it was checkpointed with. Defaults to %d\n" \
+        "  --batch FILE             Solve each line of FILE (- for stdin), a sequence followed by Y or N to allow rotations or not, and print one JSON result per line\n" \
+        "  --grids                  Include the grid of each solution in the batch results\n" \
+        "  --beam K                 Solve batch sequences of any length approximately, keeping the K (1 to %d) best grid states after each piece, instead of searching exhaustively\n" \
+        "  --trie                   Read the whole batch first, then search it as one trie of its sequences' prefixes, so that the grid states of a shared prefix are only searched once. The time limit and node budget apply to the whole search. Results are printed in line order once it ends\n" \
+        "  --cache FILE             Look up solutions in FILE before solving, and store new ones in it. FILE may be shared by processes running at the same time\n" \
+        "  --checkpoint FILE        Checkpoint the search of each sequence to FILE every S seconds, so that it can be resumed once the program is stopped. Can't be used with --batch\n" \
+        "  --checkpoint-interval S  Set the seconds S between checkpoints. Defaults to %d\n" \
+        "  --resume                 Resume the search checkpointed to FILE instead of showing the menu, then exit\n" \
+        "  --telemetry FILE         Write a JSON snapshot of each solver thread's counters to FILE every MS milliseconds while solving, e.g. in /dev/shm to watch long searches\n" \
+        "  --telemetry-interval MS  Set the milliseconds MS between telemetry snapshots. Defaults to %d\n" \
+        "  --time-limit MS          Stop the search of each sequence after MS milliseconds, keeping the lowest stack found so far and a bound on how low it could go. 0 means no limit\n" \
+        "  --node-budget N          Stop the search of each sequence once the solver threads have entered N search tree nodes between them. 0 means no budget\n" \
+        "  --benchmark FILE         Solve a fixed corpus of sequences with 1 solver thread, doubling up to N, write the results to FILE (- for stdout) as CSV, then exit\n" \
+        "  --baseline FILE          Compare the benchmark results with the results in FILE from an earlier run, and exit with status 1 on any regression\n" \
+        "  --tolerance PCT          Count benchmark results more than PCT percent worse than the baseline as regressions. Defaults to %d\n" \
+        "  --fuzz N                 Check the lowest stacks of N random sequences against an unpruned brute force search, with several thread counts, then exit\n" \
+        "  --fuzz-seed S            Generate the random sequences from seed S, to repeat an earlier run. Defaults to the current time\n" \
+        "  --coordinate PORT        Solve each batch sequence with the worker processes connected to TCP port PORT, handing out parts of its search tree and sharing the lowest stack found between them\n" \
+        "  --workers N              Wait for N (1 to %d) workers to connect before solving the first batch sequence. Defaults to 1\n" \
+        "  --worker HOST:PORT       Solve the parts of the search tree handed out by the coordinator at HOST:PORT with --threads solver threads instead of showing the menu, until it finishes its batch\n", \
+        program, MAX_SOLVERS, SOLVER_THREADS_VARIABLE, MAX_TRANSPOSITION_TABLE_MEGABYTES, DEFAULT_TRANSPOSITION_TABLE_MEGABYTES, \
+        MIN_GRID_WIDTH, MAX_GRID_WIDTH, DEFAULT_GRID_WIDTH, MAX_BEAM_WIDTH, DEFAULT_CHECKPOINT_INTERVAL, DEFAULT_TELEMETRY_INTERVAL, DEFAULT_BENCHMARK_TOLERANCE, MAX_WORKERS);
+}
 
 // Display 'prompt' (must be null-terminated) and return the char input by the user. If input empty or longer than one char, display 'prompt' again until a valid input
 char getChar(char * prompt)
@@ -117,6 +525,7 @@ void getSequenceParams(sequence_params *sequenceParams)
 {
     while (getSequence(sequenceParams) == FALSE);
     sequenceParams->AllowRotation = getAllowRotation();
+    memset(&sequenceParams->Root, 0, sizeof(sequenceParams->Root));
 }
 
 // Receive and return the tetromino which the user wants to drop in debug mode. Repeat until input is a valid tetromino
@@ -149,15 +558,15 @@ int getRotation(char tet)
     }
 }
 
-// Receive and return the column which the user wants to drop a tetromino with width 'tetrominoWidth' into in debug mode
-int getColumnToDropIn(int tetrominoWidth)
+// Receive and return the column which the user wants to drop a tetromino with width 'tetrominoWidth' into in debug mode, in a grid 'gridWidth' columns wide
+int getColumnToDropIn(int tetrominoWidth, int gridWidth)
 {
     int column;
 
         while (TRUE)
         {
             column = getInt("Which column would you like to drop it to?\n\0");
-            if (column >= 0 && column <= GRID_WIDTH - tetrominoWidth) return column; // Return 'column' the tetromino lands within the bounds of the grid
+            if (column >= 0 && column <= gridWidth - tetrominoWidth) return column; // Return 'column' the tetromino lands within the bounds of the grid
         }
 }
 
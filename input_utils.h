@@ -4,15 +4,125 @@
 #include <stdint.h>
 
 #include "tetromino.h"
+#include "placement.h"
+#include "transposition_table.h"
+#include "permutation_count.h"
+
+#define MAX_SOLVERS 1024 // Maximum number of solver threads which can be requested
+#define SOLVER_THREADS_VARIABLE "TETRIS_SOLVER_THREADS" // Environment variable which sets the number of solver threads, unless overridden by the command line
+#define NO_PINNED_CPU -1 // Leaves the solver threads of solve contexts unpinned
+#define MAX_NODE_HOST_LENGTH 256 // Longest host name of a coordinator address, including the terminating null character
+
+typedef struct // Stores the settings used to run the solvers, from the command line and environment
+{
+    int NumberOfSolvers; // Number of solver units, each run on its own solver thread. Defaults to the number of CPUs the process may run on
+    int PinSolverThreads; // If TRUE, each solver thread is pinned to its own CPU core
+    // Index of the allowed CPU the first solver thread of a solve context is pinned to, the others being pinned to the allowed CPUs after it, if PinSolverThreads is TRUE. NO_PINNED_CPU by default, so that contexts solving at the same time in
+    // a library user don't share cores. The command line pins from --first-cpu, or CPU 0, as its modes solve in one context at a time. Workers are only pinned from --first-cpu, as several may run on one machine
+    int FirstPinnedCpu;
+    int TranspositionTableMegabytes; // Memory used by the transposition table shared by the solvers. 0 disables it
+    int ShowProgress; // If TRUE, solvers print their progress while solving. FALSE in batch mode, which only prints results
+    const char *BatchFile; // File of sequences solved in batch mode, or "-" for stdin. NULL if the interactive menu is used
+    int BatchGrids; // If TRUE, batch mode results include the grid of each solution
+    int BeamWidth; // Grid states kept after each piece by the beam search batch mode solves sequences of any length with, instead of searching them exhaustively. 0 if sequences are searched exhaustively
+    int BatchTrie; // If TRUE, batch mode reads the whole batch first and searches it as one trie of its sequences' prefixes, searching the grid states of a shared prefix once for all of them
+    const char *CacheFile; // File storing solutions between runs, shared by every process using it. NULL if solutions aren't cached
+    const char *CheckpointFile; // File the search of a sequence is checkpointed to, so that it can be resumed once the process is stopped. NULL if searches aren't checkpointed
+    int CheckpointInterval; // Seconds between checkpoints
+    int ResumeCheckpoint; // If TRUE, the search checkpointed to the checkpoint file is resumed instead of showing the interactive menu
+    int GridWidth; // Number of columns in the grid sequences are solved in, from MIN_GRID_WIDTH to MAX_GRID_WIDTH
+    const char *TelemetryFile; // File a snapshot of the solvers' counters is written to while solving, so that searches can be watched from other processes. NULL if no telemetry is published
+    int TelemetryInterval; // Milliseconds between telemetry snapshots
+    int TimeLimit; // Milliseconds after which the search of each sequence stops, keeping the lowest stack found so far. 0 if searches have no time limit
+    uint64_t NodeBudget; // Search tree nodes the solvers may enter between them before the search of each sequence stops. 0 if searches have no node budget
+    const char *BenchmarkFile; // File the benchmark results are written to, or "-" for stdout. NULL if the benchmark isn't run
+    const char *BaselineFile; // Benchmark results file the results are compared with. NULL if they aren't compared
+    int BenchmarkTolerance; // Percent by which the benchmark results may be worse than the baseline before they count as a regression
+    int FuzzCases; // Number of random sequences checked against the reference enumerator. 0 if the fuzz harness isn't run
+    uint64_t FuzzSeed; // Seed of the random sequences. 0 seeds them from the time
+    int CoordinatorPort; // TCP port batch mode listens on for worker processes, which solve each sequence between them. 0 if batch mode solves sequences itself
+    int CoordinatedWorkers; // Workers the coordinator waits for before solving the first sequence. 0 if not set, in which case it waits for one
+    const char *CoordinatorAddress; // HOST:PORT of the coordinator this process solves work units for instead of showing the interactive menu. NULL if it isn't a worker
+} solver_settings;
+
+typedef struct // Stores the grid state a sequence is dropped onto and the plan its search starts from when it is a window of a stream of pieces solved online. Zeroed for a sequence dropped into an empty grid
+{
+    // Stores the grid state the first piece is dropped onto, in both skyline types as grids at most MAX_NARROW_SKYLINE_COLUMNS wide are searched with narrow skylines
+    skyline Skyline;
+    narrow_skyline NarrowSkyline;
+    int Streamed; // TRUE if the sequence is a window of a stream. Its placement table is never mirrored, so that the transposition table entries stored for one window hold for the next
+    int Depth; // Depth of the first piece in the transposition table keys, i.e. the pieces of the stream dropped since the table was cleared, so that nodes of consecutive windows holding the same pieces share keys
+    // Stores the placements of the first pieces in the solution of the previous window, which the incumbent is seeded with if they stack lower than the greedy solution
+    int PlannedPieces;
+    int PlannedColumns[MAX_SEQUENCE_SIZE];
+    int PlannedRotations[MAX_SEQUENCE_SIZE];
+} sequence_root;
 
 typedef struct // Stores the input parameters for a sequence
 {
     char Sequence[MAX_SEQUENCE_SIZE];
     int Size;
     int AllowRotation;
-    uint64_t ColumnCounterPermutations[MAX_SEQUENCE_SIZE]; // Stores the number of permutations which an increment in each piece's column counter represents
+    int GridWidth; // Number of columns in the grid the sequence is dropped into, from MIN_GRID_WIDTH to MAX_GRID_WIDTH
+    permutation_count SubtreePermutations[MAX_SEQUENCE_SIZE]; // Stores the number of permutations below a node reached by dropping each piece
+    placement_table PlacementTable; // Stores every placement of each piece, built before solving
+    sequence_root Root;
 } sequence_params;
 
+// Parse the number of solver threads in 'text' into 'numberOfSolvers'. Return TRUE if 'text' is a number between 1 and MAX_SOLVERS, FALSE otherwise
+int parseNumberOfSolvers(const char *text, int *numberOfSolvers);
+
+// Parse the index of the allowed CPU the first solver thread is pinned to in 'text' into 'cpu'. Return TRUE if 'text' is a number between 0 and MAX_SOLVERS - 1, FALSE otherwise
+int parseFirstPinnedCpu(const char *text, int *cpu);
+
+// Parse the size of the transposition table in megabytes in 'text' into 'megabytes'. Return TRUE if 'text' is a number between 0 and MAX_TRANSPOSITION_TABLE_MEGABYTES, FALSE otherwise
+int parseTranspositionTableSize(const char *text, int *megabytes);
+
+// Parse the seconds between checkpoints in 'text' into 'seconds'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseCheckpointInterval(const char *text, int *seconds);
+
+// Parse the milliseconds between telemetry snapshots in 'text' into 'milliseconds'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseTelemetryInterval(const char *text, int *milliseconds);
+
+// Parse the time limit in milliseconds in 'text' into 'milliseconds'. Return TRUE if 'text' is a number of at least 0, FALSE otherwise
+int parseTimeLimit(const char *text, int *milliseconds);
+
+// Parse the node budget in 'text' into 'nodes'. Return TRUE if 'text' is a number of at least 0, FALSE otherwise
+int parseNodeBudget(const char *text, uint64_t *nodes);
+
+// Parse the percent by which benchmark results may be worse than the baseline in 'text' into 'percent'. Return TRUE if 'text' is a number between 0 and 1000, FALSE otherwise
+int parseBenchmarkTolerance(const char *text, int *percent);
+
+// Parse the number of random sequences to fuzz in 'text' into 'fuzzCases'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseFuzzCases(const char *text, int *fuzzCases);
+
+// Parse the seed of the random sequences to fuzz in 'text' into 'seed'. Return TRUE if 'text' is a positive number, FALSE otherwise
+int parseFuzzSeed(const char *text, uint64_t *seed);
+
+// Parse the beam width in 'text' into 'beamWidth'. Return TRUE if 'text' is a number between 1 and MAX_BEAM_WIDTH, FALSE otherwise
+int parseBeamWidth(const char *text, int *beamWidth);
+
+// Parse the grid width in 'text' into 'gridWidth'. Return TRUE if 'text' is a number between MIN_GRID_WIDTH and MAX_GRID_WIDTH, FALSE otherwise
+int parseGridWidth(const char *text, int *gridWidth);
+
+// Parse the TCP port in 'text' into 'port'. Return TRUE if 'text' is a number between 1 and 65535, FALSE otherwise
+int parseNodePort(const char *text, int *port);
+
+// Parse the number of workers the coordinator waits for in 'text' into 'workers'. Return TRUE if 'text' is a number between 1 and MAX_WORKERS, FALSE otherwise
+int parseWorkerCount(const char *text, int *workers);
+
+// Parse the address of a coordinator in 'text', HOST:PORT with an IPv6 host in brackets, into 'host' and 'port'. Return TRUE if 'text' is a valid address, FALSE otherwise
+int parseNodeAddress(const char *text, char host[MAX_NODE_HOST_LENGTH], int *port);
+
+// Set 'solverSettings' to the settings used when neither the environment nor the command line set them
+void getDefaultSolverSettings(solver_settings *solverSettings);
+
+// Receive the solver settings into 'solverSettings' from the environment and the command line arguments in 'argv', which take precedence. Print the usage and return FALSE if an argument is invalid, return TRUE otherwise
+int getSolverSettings(int argc, char *argv[], solver_settings *solverSettings);
+
+// Print the command line arguments accepted by the program 'program'
+void printUsage(const char *program);
+
 // Display 'prompt' (must be null-terminated) and return the char input by the user. If input empty or longer than one char, display 'prompt' again until a valid input
 char getChar(char * prompt);
 
@@ -34,8 +144,8 @@ char getTetrominoToDrop();
 // Receive the rotation the user would like to apply to 'tet' when dropping in debug mode. Convert the rotation angle into an index pointing to the struct of 'tet' rotated by the input rotation, and return it. Repeat until input is a valid rotation
 int getRotation(char tet);
 
-// Receive and return the column which the user wants to drop a tetromino with width 'tetrominoWidth' into in debug mode
-int getColumnToDropIn(int tetrominoWidth);
+// Receive and return the column which the user wants to drop a tetromino with width 'tetrominoWidth' into in debug mode, in a grid 'gridWidth' columns wide
+int getColumnToDropIn(int tetrominoWidth, int gridWidth);
 
 // Receive and return user's debug menu selection. Repeat until input is a valid menu item
 char getDebugMenuInput();
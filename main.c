@@ -3,13 +3,27 @@
 #include "bool.h"
 #include "input_utils.h"
 #include "solver.h"
+#include "debug.h"
+#include "test.h"
+#include "batch.h"
+#include "benchmark.h"
+#include "fuzz.h"
+#include "distributed.h"
 
-int main()
+int main(int argc, char *argv[])
 {
     char input;
     sequence_params sequenceParams;
+    solver_settings solverSettings;
 
-    printf("\n");
+    if (getSolverSettings(argc, argv, &solverSettings) == FALSE) return 1;
+    if (solverSettings.BenchmarkFile != NULL) return runBenchmark(&solverSettings) == TRUE ? 0 : 1;
+    if (solverSettings.FuzzCases != 0) return runFuzz(&solverSettings) == TRUE ? 0 : 1;
+    if (solverSettings.BatchFile != NULL) return runBatch(&solverSettings) == TRUE ? 0 : 1;
+    if (solverSettings.CoordinatorAddress != NULL) return runWorker(&solverSettings) == TRUE ? 0 : 1;
+    if (solverSettings.ResumeCheckpoint == TRUE) return resumeSequence(&solverSettings) == TRUE ? 0 : 1;
+
+    printf("\nUsing %d solver thread(s)%s\n\n", solverSettings.NumberOfSolvers, solverSettings.PinSolverThreads == TRUE ? ", pinned to CPU cores" : "");
 
     while (TRUE)
     {        
@@ -19,13 +33,14 @@ int main()
         {
             case '1':
                 getSequenceParams(&sequenceParams);                   
-                solveSequence(&sequenceParams);                
+                sequenceParams.GridWidth = solverSettings.GridWidth;
+                solveSequence(&sequenceParams, &solverSettings);                
                 break;
             case '2':
-                debugMode();
+                debugMode(solverSettings.GridWidth);
                 break;
             case '3':
-                runTests();
+                runTests(&solverSettings);
                 break;
             case '4':
                 return 0;
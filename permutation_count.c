@@ -0,0 +1,27 @@
+#include <stdio.h>
+
+#include "permutation_count.h"
+
+// Write 'count' in decimal to 'text', and return 'text'
+char *formatPermutationCount(permutation_count count, char text[MAX_PERMUTATION_COUNT_LENGTH])
+{
+#ifdef __SIZEOF_INT128__
+    char digits[MAX_PERMUTATION_COUNT_LENGTH];
+    int digitCount = 0;
+    int character = 0;
+
+    // printf has no conversion for 128-bit integers, so the digits are written from the lowest
+    do
+    {
+        digits[digitCount++] = (char) ('0' + (int) (count % 10));
+        count /= 10;
+    } while (count > 0);
+
+    while (digitCount > 0) text[character++] = digits[--digitCount];
+    text[character] = '\0';
+#else
+    snprintf(text, MAX_PERMUTATION_COUNT_LENGTH, "%.0f", count);
+#endif
+
+    return text;
+}
@@ -0,0 +1,21 @@
+#ifndef PERMUTATION_COUNT_H
+#define PERMUTATION_COUNT_H
+
+#include <float.h>
+
+// Stores a number of permutations. A sequence of MAX_SEQUENCE_SIZE rotated pieces has far more than 2^64 permutations, so counts are 128 bits wide where the compiler has a 128-bit integer type, which holds the permutations of any sequence. 
+// Otherwise they are floating point, which is exact up to 2^53 permutations and approximate above
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 permutation_count;
+#define MAX_PERMUTATION_COUNT ((permutation_count) -1)
+#else
+typedef double permutation_count;
+#define MAX_PERMUTATION_COUNT DBL_MAX
+#endif
+
+#define MAX_PERMUTATION_COUNT_LENGTH 48 // Characters in the decimal form of any permutation count, including the null terminator
+
+// Write 'count' in decimal to 'text', and return 'text'
+char *formatPermutationCount(permutation_count count, char text[MAX_PERMUTATION_COUNT_LENGTH]);
+
+#endif
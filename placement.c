@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "placement.h"
+#include "tetromino.h"
+#include "skyline.h"
+
+// Fill 'rotationOrder' with the order in which the 'rotations' rotations of 'piece' are tried: 'firstRotation' first, then the rest from the flattest to the tallest
+void getRotationOrder(char piece, int rotations, int firstRotation, int rotationOrder[])
+{
+    int orderedRotations = 0;
+
+    rotationOrder[orderedRotations++] = firstRotation;
+
+    for (int height = 1; height <= MAX_TETROMINO_WIDTH; height++)
+    {
+        for (int rotation = 0; rotation < rotations; rotation++)
+            if (rotation != firstRotation && getTetromino(piece, rotation)->Height == height) rotationOrder[orderedRotations++] = rotation;
+    }
+}
+
+// Return TRUE if every rotation of each of the 'size' pieces in 'sequence' which is tried has its mirror image tried for the mirror piece, FALSE otherwise. Only the default rotation is tried unless 'allowRotation' is TRUE
+int isMirrorableSequence(char sequence[], int size, int allowRotation)
+{
+    int rotations;
+
+    for (int piece = 0; piece < size; piece++)
+    {
+        rotations = allowRotation ? getRotations(sequence[piece]) : 1;
+
+        for (int rotation = 0; rotation < rotations; rotation++)
+        {
+            if (getMirrorRotation(sequence[piece], rotation) == NO_MIRROR_ROTATION || getMirrorRotation(sequence[piece], rotation) >= rotations) return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+// Return TRUE if 'tetPlacement' and 'otherPlacement' cover the same columns, and their top cells have the same shape shifted up or down, FALSE otherwise
+int isSameShapePlacement(placement *tetPlacement, placement *otherPlacement)
+{
+    int column = tetPlacement->Shift / 8;
+    int heightDifference = getColumnHeight(tetPlacement->TopProfile, column) - getColumnHeight(otherPlacement->TopProfile, column);
+
+    if (areSkylinesEqual(tetPlacement->CoveredColumns, otherPlacement->CoveredColumns) == FALSE) return FALSE;
+
+    for (; column < MAX_SKYLINE_COLUMNS && getColumnHeight(tetPlacement->CoveredColumns, column) != 0; column++)
+        if (getColumnHeight(tetPlacement->TopProfile, column) - getColumnHeight(otherPlacement->TopProfile, column) != heightDifference) return FALSE;
+
+    return TRUE;
+}
+
+// Fill 'placementTable' with every placement of each of the 'size' pieces in 'sequence', into a grid 'gridWidth' columns wide. Only the default rotation is used unless 'allowRotation' is TRUE. 
+// If 'firstColumns' and 'firstRotations' are not NULL, the placement of each piece in them is tried first, followed by the piece's other rotations from the flattest to the tallest
+// Unless 'allowMirror' is FALSE, the sequence may be solved as its mirror image, in which case each placement holds the column and rotation it stands for in 'sequence'
+void buildPlacementTable(placement_table *placementTable, char sequence[], int size, int allowRotation, int gridWidth, int allowMirror, int firstColumns[], int firstRotations[])
+{
+    char pieces[MAX_SEQUENCE_SIZE]; // The sequence in the orientation it is solved in
+    int rotationOrder[MAX_ROTATIONS];
+    int firstRotation;
+    int firstColumn;
+    int rotation;
+    int column;
+    tetromino *tet;
+    placement tetPlacement; // The placement of the current rotation in column 0
+    placement *columnPlacement;
+    placement *mirrorPlacement;
+    int placements = 0;
+    int bottomRow;
+    int pieceCells[MAX_SEQUENCE_SIZE];
+    int pieceMinHeights[MAX_SEQUENCE_SIZE];
+
+    // A sequence and its mirror image stack to mirror images of each other, so both are solved in the orientation which comes first alphabetically
+    for (int piece = 0; piece < size; piece++) pieces[piece] = getMirrorTetromino(sequence[piece]);
+    placementTable->Mirrored = allowMirror == TRUE && isMirrorableSequence(sequence, size, allowRotation) == TRUE && memcmp(pieces, sequence, size) < 0 ? TRUE : FALSE;
+    if (placementTable->Mirrored == FALSE) memcpy(pieces, sequence, size);
+
+    for (int piece = 0; piece < size; piece++)
+    {
+        placementTable->RotationCounts[piece] = allowRotation ? getRotations(pieces[piece]) : 1;
+        pieceCells[piece] = 0;
+        pieceMinHeights[piece] = MAX_TETROMINO_WIDTH;
+
+        // The first placement is given in the orientation of 'sequence'
+        firstRotation = firstRotations == NULL ? ROTATION_0 : firstRotations[piece];
+        firstColumn = firstColumns == NULL ? 0 : firstColumns[piece];
+        if (placementTable->Mirrored == TRUE && firstColumns != NULL)
+        {
+            firstColumn = gridWidth - getTetromino(sequence[piece], firstRotation)->Width - firstColumn;
+            firstRotation = getMirrorRotation(sequence[piece], firstRotation);
+        }
+
+        getRotationOrder(pieces[piece], placementTable->RotationCounts[piece], firstRotation, rotationOrder);
+        placementTable->PieceFirstPlacements[piece] = placements;
+
+        for (int triedRotation = 0; triedRotation < placementTable->RotationCounts[piece]; triedRotation++)
+        {
+            rotation = rotationOrder[triedRotation];
+            tet = getTetromino(pieces[piece], rotation);
+
+            tetPlacement.LandingColumns = EMPTY_SKYLINE;
+            tetPlacement.CoveredColumns = EMPTY_SKYLINE;
+            tetPlacement.TopProfile = EMPTY_SKYLINE;
+            tetPlacement.Height = (unsigned char) tet->Height;
+            tetPlacement.Rotation = (unsigned char) (placementTable->Mirrored == TRUE ? getMirrorRotation(pieces[piece], rotation) : rotation);
+            tetPlacement.MirrorDuplicate = FALSE;
+            if (tet->Height < pieceMinHeights[piece]) pieceMinHeights[piece] = tet->Height;
+
+            for (int tetCol = 0; tetCol < MAX_TETROMINO_WIDTH; tetCol++)
+            {
+                tetPlacement.BottomOffsets[tetCol] = MAX_SKYLINE_HEIGHT;
+                if (tetCol >= tet->Width) continue;
+
+                // Scan up from the tetromino's bottom row (row 3 of its pattern) to the column's bottom cell
+                for (bottomRow = 3; tet->Pattern[bottomRow][tetCol] == '_'; bottomRow--);
+
+                tetPlacement.BottomOffsets[tetCol] = (unsigned char) (3 - bottomRow);
+                tetPlacement.LandingColumns = orSkylines(tetPlacement.LandingColumns, shiftSkylineLeft(makeSkyline(0x01), 8 * tetCol));
+                tetPlacement.CoveredColumns = orSkylines(tetPlacement.CoveredColumns, shiftSkylineLeft(makeSkyline(0xFF), 8 * tetCol));
+                tetPlacement.TopProfile = orSkylines(tetPlacement.TopProfile, shiftSkylineLeft(makeSkyline((uint64_t) tet->ColumnHeights[tetCol]), 8 * tetCol));
+                if (rotation == ROTATION_0) pieceCells[piece] += tet->ColumnHeights[tetCol] - tetPlacement.BottomOffsets[tetCol];
+            }
+
+            placementTable->ColumnCounts[piece][triedRotation] = gridWidth + 1 - tet->Width;
+            placementTable->FirstPlacements[piece][triedRotation] = placements;
+
+            // Shift the column 0 placement to each column the tetromino can be dropped into. The first column is tried first in the first rotation, the others from left to right
+            for (int triedColumn = 0; triedColumn < placementTable->ColumnCounts[piece][triedRotation]; triedColumn++)
+            {
+                if (firstColumns == NULL || triedRotation > 0) column = triedColumn;
+                else if (triedColumn == 0) column = firstColumn;
+                else column = triedColumn <= firstColumn ? triedColumn - 1 : triedColumn;
+
+                columnPlacement = &placementTable->Placements[placements++];
+
+                *columnPlacement = tetPlacement;
+                columnPlacement->LandingColumns = shiftSkylineLeft(columnPlacement->LandingColumns, 8 * column);
+                columnPlacement->CoveredColumns = shiftSkylineLeft(columnPlacement->CoveredColumns, 8 * column);
+                columnPlacement->TopProfile = shiftSkylineLeft(columnPlacement->TopProfile, 8 * column);
+                columnPlacement->Shift = (unsigned char) (8 * column);
+                columnPlacement->Column = (unsigned char) (placementTable->Mirrored == TRUE ? gridWidth - tet->Width - column : column);
+            }
+        }
+
+        // Link each placement to the earlier placements of the piece which may stack to the same grid state
+        for (int placementIndex = placementTable->PieceFirstPlacements[piece]; placementIndex < placements; placementIndex++)
+        {
+            columnPlacement = &placementTable->Placements[placementIndex];
+            columnPlacement->SameShapePlacementCount = 0;
+
+            for (int earlierIndex = placementTable->PieceFirstPlacements[piece]; earlierIndex < placementIndex; earlierIndex++)
+            {
+                if (isSameShapePlacement(&placementTable->Placements[earlierIndex], columnPlacement) == TRUE)
+                    columnPlacement->SameShapePlacements[columnPlacement->SameShapePlacementCount++] = (unsigned short) earlierIndex;
+            }
+        }
+    }
+
+    placementTable->PieceFirstPlacements[size] = placements;
+    placementTable->GridWidth = gridWidth;
+    placementTable->SuffixCells[size] = 0;
+    placementTable->SuffixMinHeights[size] = 0;
+    placementTable->MirrorSymmetricPiece = size;
+
+    for (int piece = size - 1; piece >= 0; piece--)
+    {
+        placementTable->SuffixCells[piece] = placementTable->SuffixCells[piece + 1] + pieceCells[piece];
+        placementTable->SuffixMinHeights[piece] = pieceMinHeights[piece] > placementTable->SuffixMinHeights[piece + 1] ? pieceMinHeights[piece] : placementTable->SuffixMinHeights[piece + 1];
+
+        if (placementTable->MirrorSymmetricPiece == piece + 1 && getMirrorTetromino(pieces[piece]) == pieces[piece] && isMirrorableSequence(&pieces[piece], 1, allowRotation) == TRUE)
+            placementTable->MirrorSymmetricPiece = piece;
+    }
+
+    // Once the rest of the sequence is its own mirror image, each placement dropped onto a symmetric grid state stacks to the mirror images of the stacks of its mirror placement, so only the one tried first is tried
+    for (int piece = placementTable->MirrorSymmetricPiece; piece < size; piece++)
+    {
+        for (int placementIndex = placementTable->PieceFirstPlacements[piece]; placementIndex < placementTable->PieceFirstPlacements[piece + 1]; placementIndex++)
+        {
+            columnPlacement = &placementTable->Placements[placementIndex];
+            tet = getTetromino(pieces[piece], columnPlacement->Rotation);
+
+            for (int mirrorIndex = placementTable->PieceFirstPlacements[piece]; mirrorIndex < placementIndex; mirrorIndex++)
+            {
+                mirrorPlacement = &placementTable->Placements[mirrorIndex];
+
+                if (mirrorPlacement->Rotation == getMirrorRotation(pieces[piece], columnPlacement->Rotation) && mirrorPlacement->Column == gridWidth - tet->Width - columnPlacement->Column)
+                    columnPlacement->MirrorDuplicate = TRUE;
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "bool.h"
+#include "tetromino.h"
+#include "skyline.h"
+#include "grid.h"
+
+#define MAX_ROTATIONS 4
+#define MAX_TETROMINO_WIDTH 4
+#define MAX_PIECE_PLACEMENTS (MAX_ROTATIONS * MAX_GRID_WIDTH) // Upper bound on the (rotation, column) pairs of one piece
+
+typedef struct // Stores a legal way of dropping a piece, i.e. a rotation and the column its leftmost cell is dropped into, precomputed for the solver
+{
+    skyline LandingColumns; // The lowest bit of each column covered by the tetromino. Multiplying by the landing height gives the landing height in each covered column
+    skyline CoveredColumns; // All bits of each column covered by the tetromino
+    skyline TopProfile; // The height of each covered column's top cell above the tetromino's bottom row, in the covered columns
+
+    // The height of each tetromino column's bottom cell above the tetromino's bottom row. Columns past the tetromino's width hold MAX_SKYLINE_HEIGHT so they never decide the landing height
+    unsigned char BottomOffsets[MAX_TETROMINO_WIDTH];
+    unsigned char Shift; // Bit position of the column the tetromino is dropped into, in a skyline
+    unsigned char Height; // Height of the tetromino
+    // The column and rotation in the orientation of the sequence being solved, which may be the mirror image of the orientation the placement is dropped in
+    unsigned char Column;
+    unsigned char Rotation;
+    // TRUE if the placement's mirror image is tried before it. If the rest of the sequence from its piece is its own mirror image, dropping either onto a grid state which is its own mirror image gives grid states which stack to the same heights, so the placement is skipped
+    unsigned char MirrorDuplicate;
+    // Every column a tetromino covers is raised when it is dropped, so only placements covering the same columns with the same top shape (shifted up or down) can stack to the same grid state. Stores the number and indices of the placements of the same piece tried before this one which do
+    unsigned char SameShapePlacementCount;
+    unsigned short SameShapePlacements[MAX_ROTATIONS - 1];
+} placement;
+
+typedef struct // Stores every placement of each piece in a sequence. Built once per sequence, before solving
+{
+    placement Placements[MAX_SEQUENCE_SIZE * MAX_PIECE_PLACEMENTS];
+
+    // Rotations and columns are indexed in the order they are tried, which is not necessarily their numbering. Each placement holds its actual rotation and column
+    int RotationCounts[MAX_SEQUENCE_SIZE]; // Number of rotations tried for each piece
+    int ColumnCounts[MAX_SEQUENCE_SIZE][MAX_ROTATIONS]; // Number of columns each tried rotation of each piece can be dropped into
+    int FirstPlacements[MAX_SEQUENCE_SIZE][MAX_ROTATIONS]; // Index of the first tried placement of each tried rotation of each piece. The 'c'th tried column follows it at index + 'c'
+    int PieceFirstPlacements[MAX_SEQUENCE_SIZE + 1]; // Index of the first placement of each piece. The placements of a piece run up to the first placement of the next piece, and the entry after the last piece holds the number of placements
+
+    // Used to bound the final stack height below a grid state, given the pieces still to be dropped from each piece onwards
+    int SuffixCells[MAX_SEQUENCE_SIZE + 1]; // Number of cells in the pieces from each piece onwards
+    int SuffixMinHeights[MAX_SEQUENCE_SIZE + 1]; // The greatest height of any piece from each piece onwards, in its flattest rotation
+    int GridWidth; // Number of columns in the grid the pieces are dropped into
+
+    int Mirrored; // TRUE if the pieces are dropped in the mirror image of the sequence, which is solved instead as it comes first alphabetically
+    int MirrorSymmetricPiece; // Index of the first piece from which the rest of the sequence is its own mirror image. Grid states from there on stack to the same heights as their mirror images
+} placement_table;
+
+// Fill 'rotationOrder' with the order in which the 'rotations' rotations of 'piece' are tried: 'firstRotation' first, then the rest from the flattest to the tallest
+void getRotationOrder(char piece, int rotations, int firstRotation, int rotationOrder[]);
+
+// Return TRUE if every rotation of each of the 'size' pieces in 'sequence' which is tried has its mirror image tried for the mirror piece, FALSE otherwise. Only the default rotation is tried unless 'allowRotation' is TRUE
+int isMirrorableSequence(char sequence[], int size, int allowRotation);
+
+// Return TRUE if 'tetPlacement' and 'otherPlacement' cover the same columns, and their top cells have the same shape shifted up or down, FALSE otherwise
+int isSameShapePlacement(placement *tetPlacement, placement *otherPlacement);
+
+// Fill 'placementTable' with every placement of each of the 'size' pieces in 'sequence', into a grid 'gridWidth' columns wide. Only the default rotation is used unless 'allowRotation' is TRUE. 
+// If 'firstColumns' and 'firstRotations' are not NULL, the placement of each piece in them is tried first, followed by the piece's other rotations from the flattest to the tallest
+// Unless 'allowMirror' is FALSE, the sequence may be solved as its mirror image, in which case each placement holds the column and rotation it stands for in 'sequence'
+void buildPlacementTable(placement_table *placementTable, char sequence[], int size, int allowRotation, int gridWidth, int allowMirror, int firstColumns[], int firstRotations[]);
+
+// Define the placement operations for each skyline type. Operations on narrow skylines are suffixed with 'Narrow', and only read the low columns of the placement masks
+#define SKYLINE_TYPE skyline
+#define SKYLINE_FUNCTION(name) name
+#include "placement_operations.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+#define SKYLINE_TYPE narrow_skyline
+#define SKYLINE_FUNCTION(name) name##Narrow
+#include "placement_operations.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+// Return the number of placements of piece 'piece' in 'placementTable'
+SKYLINE_INLINE int getPiecePlacementCount(placement_table *placementTable, int piece)
+{
+    return placementTable->PieceFirstPlacements[piece + 1] - placementTable->PieceFirstPlacements[piece];
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Defines the operations dropping placements onto skylines of type SKYLINE_TYPE, each named SKYLINE_FUNCTION(name). Included by placement.h once for each skyline type, so it has no include guard
+
+// Return the y coordinate at which the tetromino in 'placement' lands, given the grid state in 'gridSkyline'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getPlacementLandingHeight)(placement *placement, SKYLINE_TYPE gridSkyline)
+{
+    // The tetromino covers at most 4 columns, so the columns under it fit in the lowest 64 bits
+    uint64_t columns = SKYLINE_FUNCTION(getLowSkylineBits)(SKYLINE_FUNCTION(shiftSkylineRight)(gridSkyline, placement->Shift));
+
+    // The column whose bottom cell is the tetromino's bottom row has an offset of 0, so the landing height is never negative
+    int landingHeight = (int) (columns & 0xFF) - placement->BottomOffsets[0];
+    int columnLandingHeight = (int) ((columns >> 8) & 0xFF) - placement->BottomOffsets[1];
+    if (columnLandingHeight > landingHeight) landingHeight = columnLandingHeight;
+    columnLandingHeight = (int) ((columns >> 16) & 0xFF) - placement->BottomOffsets[2];
+    if (columnLandingHeight > landingHeight) landingHeight = columnLandingHeight;
+    columnLandingHeight = (int) ((columns >> 24) & 0xFF) - placement->BottomOffsets[3];
+    if (columnLandingHeight > landingHeight) landingHeight = columnLandingHeight;
+
+    return landingHeight;
+}
+
+// Return the grid state after dropping the tetromino in 'placement' onto the grid state in 'gridSkyline'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(dropPlacement)(placement *placement, SKYLINE_TYPE gridSkyline)
+{
+    int landingHeight = SKYLINE_FUNCTION(getPlacementLandingHeight)(placement, gridSkyline);
+    int topHeight = landingHeight + placement->Height;
+
+    SKYLINE_TYPE droppedColumns = SKYLINE_FUNCTION(multiplySkylines)(SKYLINE_FUNCTION(makeSkyline)((uint64_t) landingHeight), SKYLINE_FUNCTION(castSkyline)(placement->LandingColumns));
+
+    droppedColumns = SKYLINE_FUNCTION(addSkylines)(droppedColumns, SKYLINE_FUNCTION(castSkyline)(placement->TopProfile));
+    gridSkyline = SKYLINE_FUNCTION(orSkylines)(SKYLINE_FUNCTION(andSkylines)(gridSkyline, SKYLINE_FUNCTION(invertSkyline)(SKYLINE_FUNCTION(castSkyline)(placement->CoveredColumns))), droppedColumns);
+    if (topHeight > SKYLINE_FUNCTION(getSkylineHeight)(gridSkyline)) gridSkyline = SKYLINE_FUNCTION(setSkylineHeight)(gridSkyline, topHeight);
+
+    return gridSkyline;
+}
+
+// Return TRUE if a placement in 'placementTable', whose grid is 'gridWidth' columns wide, tried before 'placement' makes it redundant, when 'placement' is dropped onto the grid state 'gridSkyline' and stacks to the grid state 'droppedSkyline', FALSE otherwise. 
+// The earlier placement stacks to the same grid state or its mirror image, so the subtree below it gives the same stack heights
+SKYLINE_INLINE int SKYLINE_FUNCTION(isDuplicatePlacement)(placement_table *placementTable, placement *placement, SKYLINE_TYPE gridSkyline, SKYLINE_TYPE droppedSkyline, int gridWidth)
+{
+    if (placement->MirrorDuplicate == TRUE && SKYLINE_FUNCTION(areSkylinesEqual)(SKYLINE_FUNCTION(mirrorSkyline)(gridSkyline, gridWidth), gridSkyline) == TRUE) return TRUE;
+
+    for (int sameShapePlacement = 0; sameShapePlacement < placement->SameShapePlacementCount; sameShapePlacement++)
+        if (SKYLINE_FUNCTION(areSkylinesEqual)(SKYLINE_FUNCTION(dropPlacement)(&placementTable->Placements[placement->SameShapePlacements[sameShapePlacement]], gridSkyline), droppedSkyline) == TRUE) return TRUE;
+
+    return FALSE;
+}
+
+// Return a lower bound on the final stack height once the pieces from 'nextPiece' onwards in 'placementTable', whose grid is 'gridWidth' columns wide, are dropped onto the grid state in 'gridSkyline'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getStackHeightBound)(placement_table *placementTable, int nextPiece, SKYLINE_TYPE gridSkyline, int gridWidth)
+{
+    int stackHeight = SKYLINE_FUNCTION(getSkylineHeight)(gridSkyline);
+    // The remaining cells can at best fill the grid up level, so the columns must reach the average height once they are added
+    int areaHeight = (SKYLINE_FUNCTION(getSkylineArea)(gridSkyline) + placementTable->SuffixCells[nextPiece] + gridWidth - 1) / gridWidth;
+    // Each remaining piece lands on or above the lowest column
+    int pieceHeight = SKYLINE_FUNCTION(getLowestColumnHeight)(gridSkyline, gridWidth) + placementTable->SuffixMinHeights[nextPiece];
+
+    if (areaHeight > stackHeight) stackHeight = areaHeight;
+    if (pieceHeight > stackHeight) stackHeight = pieceHeight;
+
+    return stackHeight;
+}
@@ -0,0 +1,384 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "bool.h"
+#include "prefix_trie.h"
+#include "input_utils.h"
+#include "placement.h"
+#include "skyline.h"
+#include "heuristic.h"
+#include "solver.h"
+#include "solver_library.h"
+#include "solution_cache.h"
+#include "tetromino.h"
+#include "thread_utils.h"
+
+// Create an empty trie of sequences solved in a grid 'gridWidth' columns wide, looking up and storing their solutions in the solution cache of 'solveContext' and stopping at the limits in its settings. Return TRUE if it was created, FALSE if it couldn't be allocated
+int createPrefixTrie(prefix_trie *trie, int gridWidth, solve_context *solveContext)
+{
+    char pieces[] = TRIE_PIECES;
+
+    memset(trie, 0, sizeof(prefix_trie));
+
+    trie->GridWidth = gridWidth;
+    trie->SolveContext = solveContext;
+    trie->NodeCapacity = 64;
+    trie->SequenceCapacity = 64;
+
+    trie->Nodes = malloc(sizeof(trie_node) * trie->NodeCapacity);
+    trie->Sequences = malloc(sizeof(trie_sequence) * trie->SequenceCapacity);
+    trie->VisitedStates = malloc(sizeof(trie_visited_state) * TRIE_VISITED_STATES);
+
+    if (trie->Nodes == NULL || trie->Sequences == NULL || trie->VisitedStates == NULL)
+    {
+        free(trie->Nodes);
+        free(trie->Sequences);
+        free(trie->VisitedStates);
+        return FALSE;
+    }
+
+    for (int allowRotation = FALSE; allowRotation <= TRUE; allowRotation++)
+    {
+        memset(&trie->Nodes[allowRotation], 0, sizeof(trie_node));
+        trie->Nodes[allowRotation].AllowRotation = allowRotation;
+        trie->Nodes[allowRotation].Parent = trie->Nodes[allowRotation].FirstChild = NO_TRIE_NODE;
+        trie->Nodes[allowRotation].NextSibling = trie->Nodes[allowRotation].FirstSequence = NO_TRIE_NODE;
+
+        // The placements are never mirrored, so that each one holds the column and rotation it is dropped at
+        buildPlacementTable(&trie->PieceTables[allowRotation], pieces, (int) strlen(pieces), allowRotation, gridWidth, FALSE, NULL, NULL);
+    }
+
+    trie->NodeCount = 2;
+    return TRUE;
+}
+
+// Free 'trie'
+void destroyPrefixTrie(prefix_trie *trie)
+{
+    free(trie->Nodes);
+    free(trie->Sequences);
+    free(trie->VisitedStates);
+}
+
+// Return the child of node 'node' of 'trie' reached by dropping 'piece', adding it if 'trie' has none. Return NO_TRIE_NODE if it couldn't be allocated
+int getTrieChild(prefix_trie *trie, int node, char piece)
+{
+    trie_node *grownNodes;
+    trie_node *child;
+    tetromino *tet;
+
+    for (int childNode = trie->Nodes[node].FirstChild; childNode != NO_TRIE_NODE; childNode = trie->Nodes[childNode].NextSibling)
+        if (trie->Nodes[childNode].Piece == piece) return childNode;
+
+    if (trie->NodeCount == trie->NodeCapacity)
+    {
+        grownNodes = realloc(trie->Nodes, sizeof(trie_node) * trie->NodeCapacity * 2);
+        if (grownNodes == NULL) return NO_TRIE_NODE;
+
+        trie->Nodes = grownNodes;
+        trie->NodeCapacity *= 2;
+    }
+
+    child = &trie->Nodes[trie->NodeCount];
+    memset(child, 0, sizeof(trie_node));
+    child->Piece = piece;
+    child->Depth = trie->Nodes[node].Depth + 1;
+    child->AllowRotation = trie->Nodes[node].AllowRotation;
+    child->Parent = node;
+    child->FirstChild = child->FirstSequence = NO_TRIE_NODE;
+    child->NextSibling = trie->Nodes[node].FirstChild;
+    child->PieceMinHeight = MAX_TETROMINO_WIDTH;
+
+    for (int rotation = 0; rotation < (child->AllowRotation == TRUE ? getRotations(piece) : 1); rotation++)
+    {
+        tet = getTetromino(piece, rotation);
+        if (tet->Height < child->PieceMinHeight) child->PieceMinHeight = tet->Height;
+    }
+
+    for (int row = 0; row < 4; row++)
+        for (int col = 0; col < 4; col++)
+            if (getTetromino(piece, ROTATION_0)->Pattern[row][col] != '_') child->PieceCells++;
+
+    trie->Nodes[node].FirstChild = trie->NodeCount;
+    return trie->NodeCount++;
+}
+
+// Add the 'size' pieces in 'sequence' with rotations allowed if 'allowRotation' is TRUE, read from line 'lineNumber' of a batch file, to 'trie', seeding its solution with its cached solution or its greedy solution. Return TRUE if it was added, FALSE if it couldn't be allocated
+int addTrieSequence(prefix_trie *trie, const char *sequence, int size, int allowRotation, int lineNumber)
+{
+    sequence_params *sequenceParams = &trie->SequenceParams;
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    double startTime = getWallClockTime();
+    trie_sequence *grownSequences;
+    trie_sequence *entry;
+    solution_cache_entry cachedSolution;
+    int node = allowRotation == TRUE ? TRUE : FALSE;
+
+    if (trie->SequenceCount == trie->SequenceCapacity)
+    {
+        grownSequences = realloc(trie->Sequences, sizeof(trie_sequence) * trie->SequenceCapacity * 2);
+        if (grownSequences == NULL) return FALSE;
+
+        trie->Sequences = grownSequences;
+        trie->SequenceCapacity *= 2;
+    }
+
+    entry = &trie->Sequences[trie->SequenceCount];
+    memset(entry, 0, sizeof(trie_sequence));
+    memcpy(entry->Sequence, sequence, size);
+    entry->Size = size;
+    entry->AllowRotation = allowRotation == TRUE ? TRUE : FALSE;
+    entry->LineNumber = lineNumber;
+    entry->EndNode = entry->NextSequence = NO_TRIE_NODE;
+
+    memcpy(sequenceParams->Sequence, sequence, size);
+    sequenceParams->Size = size;
+    sequenceParams->AllowRotation = entry->AllowRotation;
+    sequenceParams->GridWidth = trie->GridWidth;
+    memset(&sequenceParams->Root, 0, sizeof(sequenceParams->Root));
+
+    entry->Result.Status = SOLVE_OK;
+    entry->Result.Permutations = getSequencePermutations(sequenceParams);
+
+    if (trie->SolveContext->SolverSettings.CacheFile != NULL && lookUpCachedSolution(&trie->SolveContext->SolutionCache, sequenceParams, trie->GridWidth, &cachedSolution) == TRUE)
+    {
+        entry->Result.StackHeight = entry->Result.LowerBound = cachedSolution.StackHeight;
+        entry->Result.Optimal = TRUE;
+        entry->Result.Cached = TRUE;
+
+        for (int piece = 0; piece < size; piece++)
+        {
+            entry->Result.PieceColumns[piece] = cachedSolution.PieceColumns[piece];
+            entry->Result.PieceRotations[piece] = cachedSolution.PieceRotations[piece];
+        }
+    }
+
+    else
+    {
+        buildPlacementTable(placementTable, sequenceParams->Sequence, size, entry->AllowRotation, trie->GridWidth, FALSE, NULL, NULL);
+        entry->Result.StackHeight = getGreedyPermutation(placementTable, size, EMPTY_SKYLINE, 0, entry->Result.PieceColumns, entry->Result.PieceRotations);
+        entry->Result.LowerBound = getStackHeightBound(placementTable, 0, EMPTY_SKYLINE, trie->GridWidth);
+        entry->Result.Optimal = entry->Result.StackHeight == entry->Result.LowerBound ? TRUE : FALSE;
+        if (entry->Result.Optimal == TRUE) cacheTrieSolution(trie, trie->SequenceCount);
+    }
+
+    entry->Result.TriedPermutations = entry->Result.Optimal == TRUE ? entry->Result.Permutations : 0;
+    entry->Result.ElapsedTime = getWallClockTime() - startTime;
+
+    // A sequence whose solution is already proven to be the lowest stack is left out of the trie, so that it doesn't keep states alive for nothing
+    if (entry->Result.Optimal == TRUE)
+    {
+        entry->Solved = TRUE;
+        trie->SequenceCount++;
+        return TRUE;
+    }
+
+    for (int piece = 0; piece < size; piece++)
+    {
+        node = getTrieChild(trie, node, sequence[piece]);
+        if (node == NO_TRIE_NODE) return FALSE;
+    }
+
+    entry->EndNode = node;
+    entry->TargetHeight = entry->Result.LowerBound;
+    entry->NextSequence = trie->Nodes[node].FirstSequence;
+    trie->Nodes[node].FirstSequence = trie->SequenceCount++;
+    return TRUE;
+}
+
+// Store the solution of sequence 'sequence' of 'trie' in the solution cache of its solve context, if it has one
+void cacheTrieSolution(prefix_trie *trie, int sequence)
+{
+    sequence_params *sequenceParams = &trie->SequenceParams;
+    trie_sequence *entry = &trie->Sequences[sequence];
+
+    if (trie->SolveContext->SolverSettings.CacheFile == NULL) return;
+
+    memcpy(sequenceParams->Sequence, entry->Sequence, entry->Size);
+    sequenceParams->Size = entry->Size;
+    sequenceParams->AllowRotation = entry->AllowRotation;
+    sequenceParams->GridWidth = trie->GridWidth;
+
+    storeCachedSolution(&trie->SolveContext->SolutionCache, sequenceParams, trie->GridWidth, entry->Result.StackHeight, entry->Result.PieceColumns, entry->Result.PieceRotations);
+}
+
+// Set the number of unsolved sequences and the limits of node 'node' of 'trie' from the target heights of its unsolved sequences and the limits of its children
+void setTrieNodeLimits(prefix_trie *trie, int node)
+{
+    trie_node *trieNode = &trie->Nodes[node];
+    trie_node *child;
+    int stackHeight;
+    int maxBaseHeight;
+
+    trieNode->UnsolvedSequences = 0;
+    trieNode->MaxStackHeight = 0;
+    trieNode->MaxArea = trieNode->MaxBaseHeight = INT_MIN;
+
+    // A sequence ending at the node has no pieces left, so a state need only be within its target height
+    for (int sequence = trieNode->FirstSequence; sequence != NO_TRIE_NODE; sequence = trie->Sequences[sequence].NextSequence)
+    {
+        if (trie->Sequences[sequence].Solved == TRUE) continue;
+
+        stackHeight = trie->Sequences[sequence].TargetHeight + 1;
+        trieNode->UnsolvedSequences++;
+        if (stackHeight > trieNode->MaxStackHeight) trieNode->MaxStackHeight = stackHeight;
+        if (trie->GridWidth * (stackHeight - 1) > trieNode->MaxArea) trieNode->MaxArea = trie->GridWidth * (stackHeight - 1);
+        if (stackHeight - 1 > trieNode->MaxBaseHeight) trieNode->MaxBaseHeight = stackHeight - 1;
+    }
+
+    // A state must leave room for the child's piece as well as the pieces after it. Taking the loosest limits of the child and the piece separately only loosens the limits, so no state a sequence needs is pruned
+    for (int childNode = trieNode->FirstChild; childNode != NO_TRIE_NODE; childNode = trie->Nodes[childNode].NextSibling)
+    {
+        child = &trie->Nodes[childNode];
+        if (child->UnsolvedSequences == 0) continue;
+
+        maxBaseHeight = child->MaxStackHeight - 1 - child->PieceMinHeight < child->MaxBaseHeight ? child->MaxStackHeight - 1 - child->PieceMinHeight : child->MaxBaseHeight;
+
+        trieNode->UnsolvedSequences += child->UnsolvedSequences;
+        if (child->MaxStackHeight > trieNode->MaxStackHeight) trieNode->MaxStackHeight = child->MaxStackHeight;
+        if (child->MaxArea - child->PieceCells > trieNode->MaxArea) trieNode->MaxArea = child->MaxArea - child->PieceCells;
+        if (maxBaseHeight > trieNode->MaxBaseHeight) trieNode->MaxBaseHeight = maxBaseHeight;
+    }
+}
+
+// Solve sequence 'sequence' of 'trie' with the grid state being searched at its end node, 'stackHeight' high and within its target height, storing the placements on the path to it, and tighten the limits of the nodes on its path
+void solveTrieSequence(prefix_trie *trie, int sequence, int stackHeight)
+{
+    trie_sequence *entry = &trie->Sequences[sequence];
+
+    // Only the greedy solution is as low as the target height if the stack is no lower
+    if (stackHeight < entry->Result.StackHeight)
+    {
+        entry->Result.StackHeight = stackHeight;
+
+        for (int piece = 0; piece < entry->Size; piece++)
+        {
+            entry->Result.PieceColumns[piece] = trie->PathColumns[piece];
+            entry->Result.PieceRotations[piece] = trie->PathRotations[piece];
+        }
+    }
+
+    entry->Result.LowerBound = entry->Result.StackHeight;
+    entry->Result.Optimal = TRUE;
+    entry->Result.TriedPermutations = entry->Result.Permutations;
+    entry->Solved = TRUE;
+    cacheTrieSolution(trie, sequence);
+
+    for (int node = entry->EndNode; node != NO_TRIE_NODE; node = trie->Nodes[node].Parent) setTrieNodeLimits(trie, node);
+}
+
+// Search the grid state 'gridSkyline', lowered by 'baseHeight', reached at node 'node' of 'trie', improving the sequences ending at the node and then searching the states reached by dropping the piece of each child with unsolved sequences
+void searchTrieState(prefix_trie *trie, int node, skyline gridSkyline, int baseHeight)
+{
+    int depth = trie->Nodes[node].Depth;
+    int stackHeight = baseHeight + getSkylineHeight(gridSkyline);
+    placement_table *placementTable = &trie->PieceTables[trie->Nodes[node].AllowRotation];
+    placement *piecePlacement;
+    trie_visited_state *visitedState;
+    trie_node *child;
+    skyline droppedSkyline;
+    int droppedBaseHeight;
+    int loweredHeight;
+    int piece;
+
+    for (int sequence = trie->Nodes[node].FirstSequence; sequence != NO_TRIE_NODE; sequence = trie->Sequences[sequence].NextSequence)
+        if (trie->Sequences[sequence].Solved == FALSE && stackHeight <= trie->Sequences[sequence].TargetHeight) solveTrieSequence(trie, sequence, stackHeight);
+
+    for (int childNode = trie->Nodes[node].FirstChild; childNode != NO_TRIE_NODE; childNode = trie->Nodes[childNode].NextSibling)
+    {
+        child = &trie->Nodes[childNode];
+        piece = (int) (strchr(TRIE_PIECES, child->Piece) - TRIE_PIECES);
+
+        // The child's limits tighten as its sequences are solved, and it is left as soon as every one of them is
+        for (int placementIndex = placementTable->PieceFirstPlacements[piece]; placementIndex < placementTable->PieceFirstPlacements[piece + 1]; placementIndex++)
+        {
+            if (child->UnsolvedSequences == 0 || trie->Stopped == TRUE) break;
+
+            piecePlacement = &placementTable->Placements[placementIndex];
+            droppedSkyline = dropPlacement(piecePlacement, gridSkyline);
+
+            // The height and area don't depend on how far the skyline is lowered, so most states are pruned before it is
+            if (baseHeight + getSkylineHeight(droppedSkyline) >= child->MaxStackHeight || getSkylineArea(droppedSkyline) + trie->GridWidth * baseHeight > child->MaxArea) continue;
+
+            droppedSkyline = normaliseSkyline(droppedSkyline, trie->GridWidth, &loweredHeight);
+            droppedBaseHeight = baseHeight + loweredHeight;
+            if (droppedBaseHeight > child->MaxBaseHeight) continue;
+
+            // A state already searched at the child in this pass from a lower base stacks every piece after it to the same shape, only higher
+            visitedState = &trie->VisitedStates[getSkylineHash(droppedSkyline, (uint64_t) childNode) & (TRIE_VISITED_STATES - 1)];
+            if (visitedState->Node == childNode && areSkylinesEqual(visitedState->Skyline, droppedSkyline) == TRUE && visitedState->BaseHeight <= droppedBaseHeight) continue;
+
+            visitedState->Node = childNode;
+            visitedState->Skyline = droppedSkyline;
+            visitedState->BaseHeight = droppedBaseHeight;
+
+            if ((++trie->States % TRIE_CHECK_INTERVAL == 0 && trie->Deadline != 0 && getWallClockTime() >= trie->Deadline) || (trie->NodeBudget != 0 && trie->States >= trie->NodeBudget))
+                trie->Stopped = TRUE;
+
+            trie->PathColumns[depth] = piecePlacement->Column;
+            trie->PathRotations[depth] = piecePlacement->Rotation;
+            searchTrieState(trie, childNode, droppedSkyline, droppedBaseHeight);
+        }
+    }
+}
+
+// Solve every sequence added to 'trie', storing each solution in its sequence, searching it in passes until none are left unsolved or the search is stopped, and splitting the time spent searching it evenly between the sequences searched
+void solvePrefixTrie(prefix_trie *trie)
+{
+    solver_settings *solverSettings = &trie->SolveContext->SolverSettings;
+    double startTime = getWallClockTime();
+    trie_sequence *entry;
+    double searchTime;
+    int searchedSequences = 0;
+
+    trie->States = 0;
+    trie->Deadline = solverSettings->TimeLimit != 0 ? startTime + solverSettings->TimeLimit / 1000.0 : 0;
+    trie->NodeBudget = solverSettings->NodeBudget;
+    trie->Stopped = FALSE;
+
+    for (int sequence = 0; sequence < trie->SequenceCount; sequence++)
+        if (trie->Sequences[sequence].Solved == FALSE) searchedSequences++;
+
+    while (trie->Stopped == FALSE)
+    {
+        // Every child is added after its parent, so the limits are set from the leaves up
+        for (int node = trie->NodeCount - 1; node >= 0; node--) setTrieNodeLimits(trie, node);
+        if (trie->Nodes[FALSE].UnsolvedSequences + trie->Nodes[TRUE].UnsolvedSequences == 0) break;
+
+        // States searched in earlier passes were searched within lower target heights, so they are searched again
+        for (int visitedState = 0; visitedState < TRIE_VISITED_STATES; visitedState++) trie->VisitedStates[visitedState].Node = NO_TRIE_NODE;
+
+        // Each root holds the empty grid
+        for (int allowRotation = FALSE; allowRotation <= TRUE; allowRotation++)
+            if (trie->Nodes[allowRotation].UnsolvedSequences != 0) searchTrieState(trie, allowRotation, EMPTY_SKYLINE, 0);
+
+        // A sequence unsolved after a whole pass has no stack within its target height. Once its target height reaches its greedy solution, that is the lowest stack
+        for (int sequence = 0; sequence < trie->SequenceCount && trie->Stopped == FALSE; sequence++)
+        {
+            entry = &trie->Sequences[sequence];
+            if (entry->Solved == TRUE) continue;
+
+            entry->Result.LowerBound = ++entry->TargetHeight;
+
+            if (entry->TargetHeight == entry->Result.StackHeight)
+            {
+                entry->Result.Optimal = TRUE;
+                entry->Result.TriedPermutations = entry->Result.Permutations;
+                entry->Solved = TRUE;
+                cacheTrieSolution(trie, sequence);
+            }
+        }
+    }
+
+    searchTime = getWallClockTime() - startTime;
+
+    for (int sequence = 0; sequence < trie->SequenceCount; sequence++)
+    {
+        entry = &trie->Sequences[sequence];
+        if (entry->EndNode == NO_TRIE_NODE) continue;
+
+        entry->Result.ElapsedTime += searchTime / searchedSequences;
+        if (entry->Solved == FALSE) entry->Result.Status = SOLVE_STOPPED;
+    }
+}
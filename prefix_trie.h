@@ -0,0 +1,108 @@
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "placement.h"
+#include "skyline.h"
+#include "solver_library.h"
+
+#define TRIE_PIECES "IJLOSTZ" // Pieces whose placements are built once per batch, and dropped for each node of the trie holding them
+#define TRIE_VISITED_STATES (1 << 20) // Entries in the table of grid states already searched at a node of the trie. A power of 2
+#define TRIE_CHECK_INTERVAL 1024 // Grid states entered between checks of the time limit
+#define NO_TRIE_NODE -1
+
+typedef struct // Stores a grid state already searched at a node of the trie, so that it isn't searched again from the same or a higher base height. Later states overwrite earlier ones with the same hash
+{
+    skyline Skyline; // Lowered so that its lowest column is at height 0
+    int Node; // NO_TRIE_NODE if the entry is empty
+    int BaseHeight; // Height the skyline was lowered by
+} trie_visited_state;
+
+typedef struct // Stores a node of the trie, i.e. a prefix shared by one or more sequences of the batch
+{
+    char Piece; // Last piece of the prefix. The pieces before it are those of the node's ancestors
+    int Depth; // Number of pieces in the prefix
+    int AllowRotation; // Sequences with and without rotation have separate roots, as they never share states
+    int PieceCells;
+    int PieceMinHeight; // Height of the piece in its flattest rotation
+    int Parent; // NO_TRIE_NODE for the roots
+    int FirstChild;
+    int NextSibling;
+    int FirstSequence; // First sequence of the batch which ends at the node, linked through their NextSequence. NO_TRIE_NODE if none
+    int UnsolvedSequences; // Number of unsolved sequences ending at or below the node. The node isn't searched once there are none
+    // Stores the loosest limits the unsolved sequences ending at or below the node put on the grid states reached by its prefix in the current pass. A state over any of them can't lead to a stack within any of the sequences' target heights, so it is pruned
+    int MaxStackHeight; // One above the highest target height of the sequences
+    int MaxArea; // Most cells a state may have under its skyline, so that the rest of some sequence could fill the grid up level to its target height
+    int MaxBaseHeight; // Highest lowest column a state may have, so that the tallest remaining piece of some sequence could land within its target height
+} trie_node;
+
+typedef struct // Stores a sequence of the batch and its solution, which starts as the greedy solution and is replaced by the first stack found within its target height
+{
+    char Sequence[MAX_SEQUENCE_SIZE];
+    int Size;
+    int AllowRotation;
+    int LineNumber; // Line of the batch file holding the sequence
+    int EndNode; // NO_TRIE_NODE if the sequence was solved when it was added, and never added to the trie
+    int NextSequence; // Next sequence ending at the same node
+    int Solved; // TRUE once its solution is proven to be the lowest stack
+    int TargetHeight; // Stack height the current pass looks for a stack within. Starts at its lower bound and is raised by one after each pass which finds none, so the first stack found is the lowest
+    solve_result Result;
+} trie_sequence;
+
+typedef struct // Stores a batch of sequences in a trie of their prefixes, searched depth first in passes of rising target heights, so that the grid states reached by a prefix shared by several sequences are searched once for all of them
+{
+    int GridWidth;
+    solve_context *SolveContext; // Holds the solution cache, and the time limit and node budget the search of the trie stops at
+
+    trie_node *Nodes; // Holds one root per rotation flag, then the other nodes in the order they are added
+    int NodeCount;
+    int NodeCapacity;
+    trie_sequence *Sequences; // In the order they are added
+    int SequenceCount;
+    int SequenceCapacity;
+
+    placement_table PieceTables[2]; // Stores the placements of each piece in TRIE_PIECES, without and with rotation
+    sequence_params SequenceParams; // Holds each sequence as it is added, while it is looked up in the solution cache and its greedy solution and lower bound are worked out
+
+    // Stores the column and rotation index of each piece on the path to the grid state being searched
+    int PathColumns[MAX_SEQUENCE_SIZE];
+    int PathRotations[MAX_SEQUENCE_SIZE];
+    trie_visited_state *VisitedStates;
+
+    // Stores the number of grid states entered over every pass, and the wall clock time and number of states after which the search stops. 0 if the search has no time limit or node budget
+    uint64_t States;
+    double Deadline;
+    uint64_t NodeBudget;
+    int Stopped; // TRUE once the time limit or node budget is reached
+} prefix_trie;
+
+// Create an empty trie of sequences solved in a grid 'gridWidth' columns wide, looking up and storing their solutions in the solution cache of 'solveContext' and stopping at the limits in its settings. Return TRUE if it was created, FALSE if it couldn't be allocated
+int createPrefixTrie(prefix_trie *trie, int gridWidth, solve_context *solveContext);
+
+// Free 'trie'
+void destroyPrefixTrie(prefix_trie *trie);
+
+// Return the child of node 'node' of 'trie' reached by dropping 'piece', adding it if 'trie' has none. Return NO_TRIE_NODE if it couldn't be allocated
+int getTrieChild(prefix_trie *trie, int node, char piece);
+
+// Add the 'size' pieces in 'sequence' with rotations allowed if 'allowRotation' is TRUE, read from line 'lineNumber' of a batch file, to 'trie', seeding its solution with its cached solution or its greedy solution. Return TRUE if it was added, FALSE if it couldn't be allocated
+int addTrieSequence(prefix_trie *trie, const char *sequence, int size, int allowRotation, int lineNumber);
+
+// Store the solution of sequence 'sequence' of 'trie' in the solution cache of its solve context, if it has one
+void cacheTrieSolution(prefix_trie *trie, int sequence);
+
+// Set the number of unsolved sequences and the limits of node 'node' of 'trie' from the target heights of its unsolved sequences and the limits of its children
+void setTrieNodeLimits(prefix_trie *trie, int node);
+
+// Solve sequence 'sequence' of 'trie' with the grid state being searched at its end node, 'stackHeight' high and within its target height, storing the placements on the path to it, and tighten the limits of the nodes on its path
+void solveTrieSequence(prefix_trie *trie, int sequence, int stackHeight);
+
+// Search the grid state 'gridSkyline', lowered by 'baseHeight', reached at node 'node' of 'trie', solving the sequences ending at the node it is within the target height of, then searching the states reached by dropping the piece of each child with unsolved sequences
+void searchTrieState(prefix_trie *trie, int node, skyline gridSkyline, int baseHeight);
+
+// Solve every sequence added to 'trie', storing each solution in its sequence, searching it in passes until none are left unsolved or the search is stopped, and splitting the time spent searching it evenly between the sequences searched
+void solvePrefixTrie(prefix_trie *trie);
+
+#endif
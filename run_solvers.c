@@ -1,32 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bool.h"
 #include "input_utils.h"
 #include "solver.h"
 #include "run_solvers.h"
+#include "thread_utils.h"
 
 #ifdef _WIN32 // Windows implementation (multi-threaded)
 
 #include <windows.h>
 
+// Run all solvers in 'solvers' one by one using the main thread, to solve the sequence in 'sequenceParams' when the solver threads couldn't be allocated
+void runSolversInMainThread(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams)
+{
+    solver_thread_params solverThreadParams;
+
+    printf("Could not allocate the solver threads!\nRunning the solvers in the main thread...\n\n");
+
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
+    {
+        solverThreadParams.Solver = &solvers[solver];
+        solverThreadParams.SequenceParams = sequenceParams;
+        solverThreadParams.Cpu = UNPINNED_SOLVER_THREAD; // Don't pin the main thread
+        runSolver(&solverThreadParams);
+    }
+}
+
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Create and start a solver thread for each solver, using Windows threading routines
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams)
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams)
 {       
-    HANDLE solverThreadHandles[NUMBER_OF_SOLVERS];
-    solver_thread_params solverThreadParams[NUMBER_OF_SOLVERS];
+    HANDLE *solverThreadHandles = malloc(sizeof(HANDLE) * solverSettings->NumberOfSolvers);
+    solver_thread_params *solverThreadParams = malloc(sizeof(solver_thread_params) * solverSettings->NumberOfSolvers);
+
+    if (solverThreadHandles == NULL || solverThreadParams == NULL)
+    {
+        free(solverThreadHandles);
+        free(solverThreadParams);
+        runSolversInMainThread(solvers, solverSettings, sequenceParams);
+        return;
+    }
 
-    for (int solver = 0; solver < NUMBER_OF_SOLVERS; solver++)
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
     {        
         solverThreadParams[solver].Solver = &solvers[solver];
         solverThreadParams[solver].SequenceParams = sequenceParams;
+        solverThreadParams[solver].Cpu = solverSettings->PinSolverThreads == TRUE ? solver : UNPINNED_SOLVER_THREAD;
         solverThreadHandles[solver] = CreateThread(NULL, 0, runSolver, &solverThreadParams[solver], 0, NULL);
 
         if (solverThreadHandles[solver] == NULL)
         {
             printf("Could not create solver thread!\nRunning solver %d in main thread...\n\n", solvers[solver].SolverID);
+            solverThreadParams[solver].Cpu = UNPINNED_SOLVER_THREAD; // Don't pin the main thread
             runSolver(&solverThreadParams[solver]);
         }
     }    
 
-    for (int solverThread = 0; solverThread < NUMBER_OF_SOLVERS; solverThread++) 
+    for (int solverThread = 0; solverThread < solverSettings->NumberOfSolvers; solverThread++) 
+    {
+        if (solverThreadHandles[solverThread] == NULL) continue;
         WaitForSingleObject(solverThreadHandles[solverThread], INFINITE);    
+        CloseHandle(solverThreadHandles[solverThread]);
+    }
+
+    free(solverThreadHandles);
+    free(solverThreadParams);
 }
 
 // Runs the solver in its own thread of execution, using the 'solver' and 'sequence_params' parameters inside 'threadParams' (must point to a solver_thread_params)
@@ -34,74 +72,91 @@ DWORD WINAPI runSolver(LPVOID threadParams)
 {
     solver_thread_params *solverThreadParams = (solver_thread_params *) threadParams;
 
-    solver *solver = solverThreadParams->Solver;
-    sequence_params *sequenceParams = solverThreadParams->SequenceParams;
-    int stackHeight;
-    int progressDisplayThreshold = 1;
+    if (solverThreadParams->Cpu != UNPINNED_SOLVER_THREAD) pinCurrentThread(solverThreadParams->Cpu);
 
-    time_t startTime;
-    time(&startTime);        
-    
-    while (solver->CurrentPermutation < solver->Permutations)
-    {        
-        stackHeight = tryPermutation(solver, sequenceParams);
-        
-        // If the permutation wasn't skipped 
-        if (stackHeight != SKIPPED_PERMUTATION) 
-        {
-            // Save permutation if it is better than previous ones
-            if (stackHeight < solver->MinStackHeight) 
-            {
-                solver->MinStackHeight = stackHeight;
-                memcpy(solver->BestPieceColumns, solver->ColumnCounters, sizeof(solver->BestPieceColumns));
-                memcpy(solver->BestPieceRotations, solver->RotationCounters, sizeof(solver->BestPieceRotations)); 
-                solver->LastChangedPiece = 0; // Invalidate intermediate grid states since the minStackHeight has changed 
-                getNextPermutation(solver, sequenceParams);                         
-            }
-            
-            else solver->LastChangedPiece = getNextPermutation(solver, sequenceParams); 
-
-            solver->CurrentPermutation++;
-        }
-        
-        // Print solver progress
-        if (solver->CurrentPermutation / PROGRESS_DISPLAY_INTERVAL == progressDisplayThreshold)
-        {
-            printSolverProgress(solver, startTime);                                 
-            progressDisplayThreshold++;
-        }            
-    }
+    searchWorkItems(solverThreadParams->Solver, solverThreadParams->SequenceParams);
+    return 0;
+}
 
-    printSolverProgress(solver, startTime);
+// Runs the solver of a solver pool in its own thread of execution for each search the pool runs, using the parameters inside 'threadParams' (must point to a pooled_solver_params)
+DWORD WINAPI runPooledSolverThread(LPVOID threadParams)
+{
+    runPooledSolver((pooled_solver_params *) threadParams);
     return 0;
 }
 
+// Create a solver thread running the solver in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createPooledSolverThread(solver_thread *thread, pooled_solver_params *threadParams)
+{
+    *thread = CreateThread(NULL, 0, runPooledSolverThread, threadParams, 0, NULL);
+    return *thread != NULL ? TRUE : FALSE;
+}
+
+// Block until the solver thread 'thread' has exited, then free its handle
+void joinPooledSolverThread(solver_thread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
 
-#elif linux // Linux implementation (multi-threaded)
+#elif defined __linux__ // Linux implementation (multi-threaded)
 
 #include <pthread.h>
 
+// Run all solvers in 'solvers' one by one using the main thread, to solve the sequence in 'sequenceParams' when the solver threads couldn't be allocated
+void runSolversInMainThread(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams)
+{
+    solver_thread_params solverThreadParams;
+
+    printf("Could not allocate the solver threads!\nRunning the solvers in the main thread...\n\n");
+
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
+    {
+        solverThreadParams.Solver = &solvers[solver];
+        solverThreadParams.SequenceParams = sequenceParams;
+        solverThreadParams.Cpu = UNPINNED_SOLVER_THREAD; // Don't pin the main thread
+        runSolver(&solverThreadParams);
+    }
+}
+
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Create and start a solver thread for each solver, using Linux threading routines
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams)
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams)
 {       
-    pthread_t solverThreadHandles[NUMBER_OF_SOLVERS];
-    solver_thread_params solverThreadParams[NUMBER_OF_SOLVERS];
+    pthread_t *solverThreadHandles = malloc(sizeof(pthread_t) * solverSettings->NumberOfSolvers);
+    int *solverThreadCreated = malloc(sizeof(int) * solverSettings->NumberOfSolvers);
+    solver_thread_params *solverThreadParams = malloc(sizeof(solver_thread_params) * solverSettings->NumberOfSolvers);
+
+    if (solverThreadHandles == NULL || solverThreadCreated == NULL || solverThreadParams == NULL)
+    {
+        free(solverThreadHandles);
+        free(solverThreadCreated);
+        free(solverThreadParams);
+        runSolversInMainThread(solvers, solverSettings, sequenceParams);
+        return;
+    }
 
-    for (int solver = 0; solver < NUMBER_OF_SOLVERS; solver++)
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
     {        
         solverThreadParams[solver].Solver = &solvers[solver];
         solverThreadParams[solver].SequenceParams = sequenceParams;
-        pthread_create(&solverThreadHandles[solver], NULL, runSolver, &solverThreadParams[solver], 0, NULL);
+        solverThreadParams[solver].Cpu = solverSettings->PinSolverThreads == TRUE ? solver : UNPINNED_SOLVER_THREAD;
+        solverThreadCreated[solver] = pthread_create(&solverThreadHandles[solver], NULL, runSolver, &solverThreadParams[solver]) == 0;
 
-        if (solverThreadHandles[solver] == NULL)
+        if (solverThreadCreated[solver] == FALSE)
         {
             printf("Could not create solver thread!\nRunning solver %d in main thread...\n\n", solvers[solver].SolverID);
+            solverThreadParams[solver].Cpu = UNPINNED_SOLVER_THREAD; // Don't pin the main thread
             runSolver(&solverThreadParams[solver]);
         }
     }    
 
-    for (int solverThread = 0; solverThread < NUMBER_OF_SOLVERS; solverThread++) 
-        pthread_join(solverThreadHandles[solverThread], NULL);        
+    for (int solverThread = 0; solverThread < solverSettings->NumberOfSolvers; solverThread++) 
+        if (solverThreadCreated[solverThread] == TRUE) pthread_join(solverThreadHandles[solverThread], NULL);        
+
+    free(solverThreadHandles);
+    free(solverThreadCreated);
+    free(solverThreadParams);
 }
 
 // Runs the solver in its own thread of execution, using the 'solver' and 'sequence_params' parameters inside 'threadParams' (must point to a solver_thread_params)
@@ -109,97 +164,164 @@ void* runSolver(void* threadParams)
 {
     solver_thread_params *solverThreadParams = (solver_thread_params *) threadParams;
 
-    solver *solver = solverThreadParams->Solver;
-    sequence_params *sequenceParams = solverThreadParams->SequenceParams;
-    int stackHeight;
-    int progressDisplayThreshold = 1;
+    if (solverThreadParams->Cpu != UNPINNED_SOLVER_THREAD) pinCurrentThread(solverThreadParams->Cpu);
 
-    time_t startTime;
-    time(&startTime);        
-    
-    while (solver->CurrentPermutation < solver->Permutations)
-    {        
-        stackHeight = tryPermutation(solver, sequenceParams);
-        
-        // If the permutation wasn't skipped 
-        if (stackHeight != SKIPPED_PERMUTATION) 
-        {
-            // Save permutation if it is better than previous ones
-            if (stackHeight < solver->MinStackHeight) 
-            {
-                solver->MinStackHeight = stackHeight;
-                memcpy(solver->BestPieceColumns, solver->ColumnCounters, sizeof(solver->BestPieceColumns));
-                memcpy(solver->BestPieceRotations, solver->RotationCounters, sizeof(solver->BestPieceRotations)); 
-                solver->LastChangedPiece = 0; // Invalidate intermediate grid states since the minStackHeight has changed 
-                getNextPermutation(solver, sequenceParams);                         
-            }
-            
-            else solver->LastChangedPiece = getNextPermutation(solver, sequenceParams); 
-
-            solver->CurrentPermutation++;
-        }
-        
-        // Print solver progress
-        if (solver->CurrentPermutation / PROGRESS_DISPLAY_INTERVAL == progressDisplayThreshold)
-        {
-            printSolverProgress(solver, startTime);                                 
-            progressDisplayThreshold++;
-        }                                       
-    }
+    searchWorkItems(solverThreadParams->Solver, solverThreadParams->SequenceParams);
+    return 0;
+}
 
-    printSolverProgress(solver, startTime);
+// Runs the solver of a solver pool in its own thread of execution for each search the pool runs, using the parameters inside 'threadParams' (must point to a pooled_solver_params)
+void* runPooledSolverThread(void *threadParams)
+{
+    runPooledSolver((pooled_solver_params *) threadParams);
     return 0;
 }
 
+// Create a solver thread running the solver in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createPooledSolverThread(solver_thread *thread, pooled_solver_params *threadParams)
+{
+    return pthread_create(thread, NULL, runPooledSolverThread, threadParams) == 0 ? TRUE : FALSE;
+}
+
+// Block until the solver thread 'thread' has exited, then free its handle
+void joinPooledSolverThread(solver_thread thread)
+{
+    pthread_join(thread, NULL);
+}
+
 
 #else // Standard implementation (single-threaded)
 
 // Runs 'solver' to solve the sequence in 'sequenceParams'
 void runSolver(solver * solver, sequence_params *sequenceParams)
 {
-    int stackHeight; 
-    int progressDisplayThreshold = 1;
-
-    time_t startTime;
-    time(&startTime);
-    
-    while (solver->CurrentPermutation < solver->Permutations)
-    {        
-        stackHeight = tryPermutation(solver, sequenceParams);
-        
-        // If the permutation wasn't skipped 
-        if (stackHeight != SKIPPED_PERMUTATION) 
-        {
-            // Save permutation if it is better than previous ones
-            if (stackHeight < solver->MinStackHeight) 
-            {
-                solver->MinStackHeight = stackHeight;
-                memcpy(solver->BestPieceColumns, solver->ColumnCounters, sizeof(solver->BestPieceColumns));
-                memcpy(solver->BestPieceRotations, solver->RotationCounters, sizeof(solver->BestPieceRotations)); 
-                solver->LastChangedPiece = 0; // Invalidate intermediate grid states since the minStackHeight has changed 
-                getNextPermutation(solver, sequenceParams);                         
-            }
-            
-            else solver->LastChangedPiece = getNextPermutation(solver, sequenceParams);                         
-            solver->CurrentPermutation++;
-        }
-
-        // Print solver progress
-        if (solver->CurrentPermutation / PROGRESS_DISPLAY_INTERVAL == progressDisplayThreshold)
-        {
-            printSolverProgress(solver, startTime);                                 
-            progressDisplayThreshold++;
-        }                                            
-    }
-
-    printSolverProgress(solver, startTime);
+    searchWorkItems(solver, sequenceParams);
 }
 
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Run all solvers one by one using the main thread only
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams)
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams)
 {       
-    for (int solver = 0; solver < NUMBER_OF_SOLVERS; solver++)
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
         runSolver(&solvers[solver], sequenceParams);
 }
 
+// Create a solver thread running the solver in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createPooledSolverThread(solver_thread *thread, pooled_solver_params *threadParams)
+{
+    // Without threads, every solver is run by the thread running the search
+    (void) thread;
+    (void) threadParams;
+    return FALSE;
+}
+
+// Block until the solver thread 'thread' has exited, then free its handle
+void joinPooledSolverThread(solver_thread thread)
+{
+    (void) thread;
+}
+
 #endif
+
+// Start a thread waiting for searches for each of the solvers in 'solvers', as set in 'solverSettings'. Return TRUE if the pool was started, FALSE if it couldn't be allocated
+int startSolverPool(solver_pool *solverPool, solver solvers[], solver_settings *solverSettings)
+{
+    solverPool->Solvers = solvers;
+    solverPool->NumberOfSolvers = solverSettings->NumberOfSolvers;
+    solverPool->SequenceParams = NULL;
+    solverPool->Search = 0;
+    solverPool->RunningThreads = 0;
+    solverPool->Stopping = FALSE;
+    solverPool->Threads = malloc(sizeof(solver_thread) * solverPool->NumberOfSolvers);
+    solverPool->ThreadCreated = malloc(sizeof(int) * solverPool->NumberOfSolvers);
+    solverPool->ThreadParams = malloc(sizeof(pooled_solver_params) * solverPool->NumberOfSolvers);
+
+    if (solverPool->Threads == NULL || solverPool->ThreadCreated == NULL || solverPool->ThreadParams == NULL)
+    {
+        free(solverPool->Threads);
+        free(solverPool->ThreadCreated);
+        free(solverPool->ThreadParams);
+        return FALSE;
+    }
+
+    initialiseLock(&solverPool->Lock);
+    initialiseCondition(&solverPool->SearchStarted);
+    initialiseCondition(&solverPool->SearchFinished);
+
+    for (int solver = 0; solver < solverPool->NumberOfSolvers; solver++)
+    {
+        solverPool->ThreadParams[solver].Pool = solverPool;
+        solverPool->ThreadParams[solver].Solver = solver;
+        solverPool->ThreadParams[solver].Cpu = solverSettings->PinSolverThreads == TRUE && solverSettings->FirstPinnedCpu != NO_PINNED_CPU ? solverSettings->FirstPinnedCpu + solver : UNPINNED_SOLVER_THREAD;
+        solverPool->ThreadCreated[solver] = createPooledSolverThread(&solverPool->Threads[solver], &solverPool->ThreadParams[solver]);
+    }
+
+    return TRUE;
+}
+
+// Run the searches of 'solverPool' for the solver it runs in 'threadParams', until the pool is stopped
+void runPooledSolver(pooled_solver_params *threadParams)
+{
+    solver_pool *solverPool = threadParams->Pool;
+    unsigned int lastSearch = 0;
+
+    if (threadParams->Cpu != UNPINNED_SOLVER_THREAD) pinCurrentThread(threadParams->Cpu);
+
+    acquireLock(&solverPool->Lock);
+
+    while (TRUE)
+    {
+        while (solverPool->Search == lastSearch && solverPool->Stopping == FALSE) waitCondition(&solverPool->SearchStarted, &solverPool->Lock);
+        if (solverPool->Stopping == TRUE) break;
+
+        lastSearch = solverPool->Search;
+        releaseLock(&solverPool->Lock);
+
+        searchWorkItems(&solverPool->Solvers[threadParams->Solver], solverPool->SequenceParams);
+
+        acquireLock(&solverPool->Lock);
+        if (--solverPool->RunningThreads == 0) signalCondition(&solverPool->SearchFinished);
+    }
+
+    releaseLock(&solverPool->Lock);
+}
+
+// Search the whole search tree of the sequence in 'sequenceParams', which its solvers must have been initialised for, with the solvers of 'solverPool'. Return once all of them have finished
+void runSolverPool(solver_pool *solverPool, sequence_params *sequenceParams)
+{
+    acquireLock(&solverPool->Lock);
+
+    solverPool->SequenceParams = sequenceParams;
+    solverPool->RunningThreads = 0;
+    for (int solver = 0; solver < solverPool->NumberOfSolvers; solver++) solverPool->RunningThreads += solverPool->ThreadCreated[solver];
+
+    solverPool->Search++;
+    signalCondition(&solverPool->SearchStarted);
+    releaseLock(&solverPool->Lock);
+
+    for (int solver = 0; solver < solverPool->NumberOfSolvers; solver++)
+        if (solverPool->ThreadCreated[solver] == FALSE) searchWorkItems(&solverPool->Solvers[solver], sequenceParams);
+
+    acquireLock(&solverPool->Lock);
+    while (solverPool->RunningThreads > 0) waitCondition(&solverPool->SearchFinished, &solverPool->Lock);
+    releaseLock(&solverPool->Lock);
+}
+
+// Tell the threads of 'solverPool' to exit, wait for them and free the pool. No search may be running
+void stopSolverPool(solver_pool *solverPool)
+{
+    acquireLock(&solverPool->Lock);
+    solverPool->Stopping = TRUE;
+    signalCondition(&solverPool->SearchStarted);
+    releaseLock(&solverPool->Lock);
+
+    for (int solver = 0; solver < solverPool->NumberOfSolvers; solver++)
+        if (solverPool->ThreadCreated[solver] == TRUE) joinPooledSolverThread(solverPool->Threads[solver]);
+
+    destroyCondition(&solverPool->SearchStarted);
+    destroyCondition(&solverPool->SearchFinished);
+    destroyLock(&solverPool->Lock);
+
+    free(solverPool->Threads);
+    free(solverPool->ThreadCreated);
+    free(solverPool->ThreadParams);
+}
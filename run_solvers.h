@@ -1,39 +1,116 @@
+#ifndef RUN_SOLVERS_H
+#define RUN_SOLVERS_H
+
 #include "input_utils.h"
 #include "solver.h"
+#include "thread_utils.h"
+
+#define UNPINNED_SOLVER_THREAD -1
 
 typedef struct // Stores the data required by a solver thread
 {
     solver *Solver;
     sequence_params *SequenceParams;
+    int Cpu; // Index of the CPU core the solver thread is pinned to, or UNPINNED_SOLVER_THREAD
 } solver_thread_params;
 
+typedef struct solver_pool solver_pool;
+
+typedef struct // Stores the data required by a solver thread of a solver pool
+{
+    solver_pool *Pool;
+    int Solver; // Index of the solver the thread runs in the pool's solvers
+    int Cpu; // Index of the CPU core the solver thread is pinned to, or UNPINNED_SOLVER_THREAD
+} pooled_solver_params;
+
 
 #ifdef _WIN32 // Windows implementation (multi-threaded)
 
 #include <windows.h>
 
+typedef HANDLE solver_thread;
+
+// Run all solvers in 'solvers' one by one using the main thread, to solve the sequence in 'sequenceParams' when the solver threads couldn't be allocated
+void runSolversInMainThread(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
+
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Create and start a solver thread for each solver, using Windows threading routines
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams);
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
 
 // Runs the solver in its own thread of execution, using the 'solver' and 'sequence_params' parameters inside 'threadParams' (must point to a solver_thread_params)
 DWORD WINAPI runSolver(LPVOID threadParams);
 
+// Runs the solver of a solver pool in its own thread of execution for each search the pool runs, using the parameters inside 'threadParams' (must point to a pooled_solver_params)
+DWORD WINAPI runPooledSolverThread(LPVOID threadParams);
 
-#elif linux // Linux implementation (multi-threaded)
+
+#elif defined __linux__ // Linux implementation (multi-threaded)
+
+#include <pthread.h>
+
+typedef pthread_t solver_thread;
+
+// Run all solvers in 'solvers' one by one using the main thread, to solve the sequence in 'sequenceParams' when the solver threads couldn't be allocated
+void runSolversInMainThread(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
 
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Create and start a solver thread for each solver, using Linux threading routines
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams);
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
 
 // Runs the solver in its own thread of execution, using the 'solver' and 'sequence_params' parameters inside 'threadParams' (must point to a solver_thread_params)
 void* runSolver(void *threadParams);
 
+// Runs the solver of a solver pool in its own thread of execution for each search the pool runs, using the parameters inside 'threadParams' (must point to a pooled_solver_params)
+void* runPooledSolverThread(void *threadParams);
+
 
 #else // Standard implementation (single-threaded)
 
+typedef int solver_thread;
+
 // Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'. Run all solvers one by one using the main thread
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams);
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
 
 // Runs 'solver' to solve the sequence in 'sequenceParams'
 void runSolver(solver * solver, sequence_params *sequenceParams);
 
 #endif
+
+struct solver_pool // Stores solver threads which are kept waiting between searches, so that many sequences can be solved without creating threads for each one
+{
+    solver *Solvers;
+    int NumberOfSolvers;
+
+    // Stores the search the threads run. 'Search' is incremented each time a search is started
+    sequence_params *SequenceParams;
+    unsigned int Search;
+    int RunningThreads; // Number of solver threads which haven't finished the current search
+    int Stopping; // TRUE once the threads are told to exit
+
+    solver_lock Lock;
+    solver_condition SearchStarted;
+    solver_condition SearchFinished;
+
+    // Solvers whose thread couldn't be created are run by the thread running the search
+    solver_thread *Threads;
+    int *ThreadCreated;
+    pooled_solver_params *ThreadParams;
+};
+
+// Create a solver thread running the solver in 'threadParams', storing its handle in 'thread'. Return TRUE if the thread was created, FALSE otherwise
+int createPooledSolverThread(solver_thread *thread, pooled_solver_params *threadParams);
+
+// Block until the solver thread 'thread' has exited, then free its handle
+void joinPooledSolverThread(solver_thread thread);
+
+// Start a thread waiting for searches for each of the solvers in 'solvers', as set in 'solverSettings'. Return TRUE if the pool was started, FALSE if it couldn't be allocated
+int startSolverPool(solver_pool *solverPool, solver solvers[], solver_settings *solverSettings);
+
+// Run the searches of 'solverPool' for the solver it runs in 'threadParams', until the pool is stopped
+void runPooledSolver(pooled_solver_params *threadParams);
+
+// Search the whole search tree of the sequence in 'sequenceParams', which its solvers must have been initialised for, with the solvers of 'solverPool'. Return once all of them have finished
+void runSolverPool(solver_pool *solverPool, sequence_params *sequenceParams);
+
+// Tell the threads of 'solverPool' to exit, wait for them and free the pool. No search may be running
+void stopSolverPool(solver_pool *solverPool);
+
+#endif
@@ -0,0 +1,233 @@
+#include <stdlib.h>
+
+#include "bool.h"
+#include "scheduler.h"
+#include "input_utils.h"
+#include "placement.h"
+#include "thread_utils.h"
+
+// Initialise 'workQueue' to hand out the search tree of the sequence in 'sequenceParams' as prefixes, so that each of 'solvers' solvers gets at least MIN_PREFIXES_PER_SOLVER of them where possible
+void initialiseWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int solvers)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+
+    // Lengthen the prefix until there are enough prefixes to go around. The last piece is never part of a prefix, so that each prefix is a node with children
+    workQueue->PrefixLength = 0;
+    workQueue->Prefixes = sequenceParams->Size == 0 ? 0 : 1;
+
+    while (workQueue->PrefixLength < sequenceParams->Size - 1 && workQueue->Prefixes < (uint64_t) solvers * MIN_PREFIXES_PER_SOLVER)
+    {
+        workQueue->Prefixes *= getPiecePlacementCount(placementTable, workQueue->PrefixLength);
+        workQueue->PrefixLength++;
+    }
+
+    workQueue->NextPrefix = 0;
+
+    workQueue->DonatedItemCount = 0;
+    workQueue->BusySolvers = 0;
+    workQueue->IdleSolvers = 0;
+    workQueue->RequestedItems = 0;
+    workQueue->Stopped = FALSE;
+    workQueue->Held = FALSE;
+
+    workQueue->ResumedItems = NULL;
+    workQueue->ResumedItemCount = 0;
+
+    initialiseLock(&workQueue->Lock);
+    initialiseCondition(&workQueue->WorkChanged);
+}
+
+// Set 'workQueue' to hand out the work left in a search when it was checkpointed: the 'resumedItemCount' work items in 'resumedItems', then the prefixes of length 'prefixLength' from index 'nextPrefix'. Return TRUE if the work fits the search tree of the sequence in 'sequenceParams', FALSE otherwise (in which case 'workQueue' is left unchanged)
+int resumeWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int prefixLength, uint64_t nextPrefix, work_item resumedItems[], int resumedItemCount)
+{
+    uint64_t prefixes = 1;
+
+    if (prefixLength < 0 || prefixLength > sequenceParams->Size - 1) return FALSE;
+
+    for (int piece = 0; piece < prefixLength; piece++) prefixes *= getPiecePlacementCount(&sequenceParams->PlacementTable, piece);
+    if (nextPrefix > prefixes) return FALSE;
+
+    for (int item = 0; item < resumedItemCount; item++)
+        if (isValidWorkItem(sequenceParams, &resumedItems[item]) == FALSE) return FALSE;
+
+    workQueue->PrefixLength = prefixLength;
+    workQueue->Prefixes = prefixes;
+    workQueue->NextPrefix = nextPrefix;
+    workQueue->ResumedItems = resumedItems;
+    workQueue->ResumedItemCount = resumedItemCount;
+
+    return TRUE;
+}
+
+// Set 'workQueue' to hand out only the prefixes of length 'prefixLength' from index 'firstPrefix' up to but not including 'endPrefix', the part of the search tree a coordinator assigned to this process. Return TRUE if they fit the search tree of the sequence in 'sequenceParams', FALSE otherwise
+int restrictWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int prefixLength, uint64_t firstPrefix, uint64_t endPrefix)
+{
+    if (firstPrefix > endPrefix || resumeWorkQueue(workQueue, sequenceParams, prefixLength, firstPrefix, NULL, 0) == FALSE || endPrefix > workQueue->Prefixes) return FALSE;
+
+    workQueue->Prefixes = endPrefix;
+    return TRUE;
+}
+
+// Free the resources held by 'workQueue' once all solvers have stopped
+void destroyWorkQueue(work_queue *workQueue)
+{
+    destroyCondition(&workQueue->WorkChanged);
+    destroyLock(&workQueue->Lock);
+}
+
+// Fill 'item' with the prefix at index 'prefix' of the sequence in 'sequenceParams', out of the prefixes of length 'prefixLength'
+void getPrefixWorkItem(sequence_params *sequenceParams, int prefixLength, uint64_t prefix, work_item *item)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    int placements;
+
+    // Prefixes are numbered in the order they are searched, with the last piece of the prefix changing fastest
+    for (int piece = prefixLength - 1; piece >= 0; piece--)
+    {
+        placements = getPiecePlacementCount(placementTable, piece);
+        item->Placements[piece] = (unsigned short) (placementTable->PieceFirstPlacements[piece] + prefix % placements);
+        prefix /= placements;
+    }
+
+    item->Depth = prefixLength;
+    item->FirstChild = placementTable->PieceFirstPlacements[prefixLength];
+    item->EndChild = placementTable->PieceFirstPlacements[prefixLength + 1];
+}
+
+// Return TRUE if the work item 'item' is a part of the search tree of the sequence in 'sequenceParams', FALSE otherwise
+int isValidWorkItem(sequence_params *sequenceParams, work_item *item)
+{
+    int *pieceFirstPlacements = sequenceParams->PlacementTable.PieceFirstPlacements;
+
+    if (item->Depth < 0 || item->Depth > sequenceParams->Size - 1) return FALSE;
+
+    for (int piece = 0; piece < item->Depth; piece++)
+        if (item->Placements[piece] < pieceFirstPlacements[piece] || item->Placements[piece] >= pieceFirstPlacements[piece + 1]) return FALSE;
+
+    return item->FirstChild >= pieceFirstPlacements[item->Depth] && item->FirstChild <= item->EndChild && item->EndChild <= pieceFirstPlacements[item->Depth + 1] ? TRUE : FALSE;
+}
+
+// Return the number of permutations in the work item 'item' of the sequence in 'sequenceParams'
+permutation_count getWorkItemPermutations(sequence_params *sequenceParams, work_item *item)
+{
+    return (permutation_count) (item->EndChild - item->FirstChild) * sequenceParams->SubtreePermutations[item->Depth];
+}
+
+// Return the number of permutations in the work items and prefixes left in 'workQueue', which hands out the search tree of the sequence in 'sequenceParams'
+permutation_count getQueuedPermutations(work_queue *workQueue, sequence_params *sequenceParams)
+{
+    permutation_count permutations = (permutation_count) (workQueue->Prefixes - workQueue->NextPrefix) * getPiecePlacementCount(&sequenceParams->PlacementTable, workQueue->PrefixLength) * \
+                            sequenceParams->SubtreePermutations[workQueue->PrefixLength];
+
+    for (int item = 0; item < workQueue->ResumedItemCount; item++) permutations += getWorkItemPermutations(sequenceParams, &workQueue->ResumedItems[item]);
+    for (int item = 0; item < workQueue->DonatedItemCount; item++) permutations += getWorkItemPermutations(sequenceParams, &workQueue->DonatedItems[item]);
+
+    return permutations;
+}
+
+// Receive the next part of the search tree to search from 'workQueue' into 'item', waiting for a busy solver to split its work item if none are left. Pass TRUE in 'finishedItem' if the caller has finished its previous work item. Return TRUE if a work item was received, FALSE if the whole search tree has been searched
+int getWorkItem(work_queue *workQueue, sequence_params *sequenceParams, int finishedItem, work_item *item)
+{
+    int waiting = FALSE;
+    int receivedItem;
+
+    acquireLock(&workQueue->Lock);
+    if (finishedItem == TRUE && --workQueue->BusySolvers == 0) signalCondition(&workQueue->WorkChanged);
+
+    while (TRUE)
+    {
+        receivedItem = TRUE;
+
+        // The search was stopped early, the rest of the search tree is left unsearched
+        if (workQueue->Stopped == TRUE)
+            receivedItem = FALSE;
+
+        // A checkpoint is being taken, wait for it to be written rather than moving work out of the queue
+        else if (workQueue->Held == TRUE)
+        {
+            waitCondition(&workQueue->WorkChanged, &workQueue->Lock);
+            continue;
+        }
+
+        else if (workQueue->ResumedItemCount > 0)
+            *item = workQueue->ResumedItems[--workQueue->ResumedItemCount];
+
+        else if (workQueue->DonatedItemCount > 0)
+            *item = workQueue->DonatedItems[--workQueue->DonatedItemCount];
+
+        else if (workQueue->NextPrefix < workQueue->Prefixes)
+            getPrefixWorkItem(sequenceParams, workQueue->PrefixLength, workQueue->NextPrefix++, item);
+
+        // No work items left and no busy solver which could split one, the whole search tree has been searched
+        else if (workQueue->BusySolvers == 0)
+            receivedItem = FALSE;
+
+        // Wait for a busy solver to split its work item
+        else
+        {
+            if (waiting == FALSE)
+            {
+                waiting = TRUE;
+                workQueue->IdleSolvers++;
+                workQueue->RequestedItems = workQueue->IdleSolvers - workQueue->DonatedItemCount;
+            }
+
+            // Sleeps rather than spinning, so that the lock stays free for the busy solvers donating work items
+            waitCondition(&workQueue->WorkChanged, &workQueue->Lock);
+            continue;
+        }
+
+        if (waiting == TRUE) workQueue->IdleSolvers--;
+        if (receivedItem == TRUE) workQueue->BusySolvers++;
+        workQueue->RequestedItems = workQueue->IdleSolvers - workQueue->DonatedItemCount;
+
+        releaseLock(&workQueue->Lock);
+        return receivedItem;
+    }
+}
+
+// Stop handing out work items from 'workQueue', and signal busy solvers to abandon theirs
+void stopWorkQueue(work_queue *workQueue)
+{
+    acquireLock(&workQueue->Lock);
+    workQueue->Stopped = TRUE;
+    signalCondition(&workQueue->WorkChanged);
+    releaseLock(&workQueue->Lock);
+}
+
+// Hand the work item 'item' split off by a busy solver to an idle solver waiting in 'workQueue'. Return TRUE if it was handed out, FALSE if no idle solver needs it (in which case the caller keeps it)
+int donateWorkItem(work_queue *workQueue, work_item *item)
+{
+    acquireLock(&workQueue->Lock);
+
+    // Another busy solver may have already served the idle solvers, or the donor may have already recorded its work in a checkpoint being taken
+    if (workQueue->IdleSolvers - workQueue->DonatedItemCount <= 0 || workQueue->DonatedItemCount == MAX_DONATED_ITEMS || workQueue->Held == TRUE)
+    {
+        releaseLock(&workQueue->Lock);
+        return FALSE;
+    }
+
+    workQueue->DonatedItems[workQueue->DonatedItemCount++] = *item;
+    workQueue->RequestedItems = workQueue->IdleSolvers - workQueue->DonatedItemCount;
+    signalCondition(&workQueue->WorkChanged);
+
+    releaseLock(&workQueue->Lock);
+    return TRUE;
+}
+
+// Hold 'workQueue', which must be locked, so that no work items are handed out or donated until it is released
+void holdWorkQueue(work_queue *workQueue)
+{
+    workQueue->Held = TRUE;
+
+    // Busy solvers would otherwise keep trying to split their work items for the waiting solvers
+    workQueue->RequestedItems = 0;
+}
+
+// Release 'workQueue', which must be locked, once held by holdWorkQueue
+void releaseWorkQueue(work_queue *workQueue)
+{
+    workQueue->Held = FALSE;
+    workQueue->RequestedItems = workQueue->IdleSolvers - workQueue->DonatedItemCount;
+    signalCondition(&workQueue->WorkChanged);
+}
@@ -0,0 +1,87 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "thread_utils.h"
+
+#define MIN_PREFIXES_PER_SOLVER 8 // Minimum number of prefixes handed out per solver, so that solvers finishing early can pick up more work
+#define MAX_DONATED_ITEMS 64 // Maximum number of work items split off by busy solvers which can wait in the queue at once
+
+typedef struct // Stores a part of the search tree of a sequence: the subtrees below the node reached by dropping the first 'Depth' pieces at 'Placements', whose placement of the next piece is in [FirstChild, EndChild)
+{
+    int Depth;
+    unsigned short Placements[MAX_SEQUENCE_SIZE]; // Indices into the placement table
+    int FirstChild;
+    int EndChild;
+} work_item;
+
+typedef struct // Hands out parts of the search tree to solvers as they become idle. Shared by all solvers
+{
+    // The search tree is first handed out as the subtrees below each placement of the first 'PrefixLength' pieces, in order
+    int PrefixLength;
+    uint64_t Prefixes; // Number of prefixes
+    uint64_t NextPrefix; // Index of the next prefix to hand out
+
+    // Stores the work items split off by busy solvers for idle solvers, once all prefixes are handed out
+    work_item DonatedItems[MAX_DONATED_ITEMS];
+    int DonatedItemCount;
+
+    int BusySolvers; // Number of solvers currently searching a work item
+    int IdleSolvers; // Number of solvers waiting for a work item
+    // Number of idle solvers not yet given a donated work item. Busy solvers poll it to decide whether to split their work item, so it is only written under 'Lock'
+    volatile int RequestedItems;
+    // Set to TRUE when the search is stopped before the whole search tree has been searched. Busy solvers poll it to abandon their work items, and no more work items are handed out
+    volatile int Stopped;
+    // Set to TRUE while a checkpoint of the search is taken. No work items are handed out or donated while it is held, so the work left in the queue and in the busy solvers stays put until each busy solver has recorded its own
+    volatile int Held;
+
+    // Stores the work items read from a checkpoint when the search is resumed. They are handed out before the donated work items and prefixes
+    work_item *ResumedItems;
+    int ResumedItemCount;
+
+    solver_lock Lock;
+    solver_condition WorkChanged; // Signalled whenever an idle solver waiting in the queue may be able to go on: a work item is donated, the last busy solver finishes, the search is stopped or the queue is released
+} work_queue;
+
+// Initialise 'workQueue' to hand out the search tree of the sequence in 'sequenceParams' as prefixes, so that each of 'solvers' solvers gets at least MIN_PREFIXES_PER_SOLVER of them where possible
+void initialiseWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int solvers);
+
+// Set 'workQueue' to hand out the work left in a search when it was checkpointed: the 'resumedItemCount' work items in 'resumedItems', then the prefixes of length 'prefixLength' from index 'nextPrefix'. Return TRUE if the work fits the search tree of the sequence in 'sequenceParams', FALSE otherwise (in which case 'workQueue' is left unchanged)
+int resumeWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int prefixLength, uint64_t nextPrefix, work_item resumedItems[], int resumedItemCount);
+
+// Set 'workQueue' to hand out only the prefixes of length 'prefixLength' from index 'firstPrefix' up to but not including 'endPrefix', the part of the search tree a coordinator assigned to this process. Return TRUE if they fit the search tree of the sequence in 'sequenceParams', FALSE otherwise
+int restrictWorkQueue(work_queue *workQueue, sequence_params *sequenceParams, int prefixLength, uint64_t firstPrefix, uint64_t endPrefix);
+
+// Free the resources held by 'workQueue' once all solvers have stopped
+void destroyWorkQueue(work_queue *workQueue);
+
+// Fill 'item' with the prefix at index 'prefix' of the sequence in 'sequenceParams', out of the prefixes of length 'prefixLength'
+void getPrefixWorkItem(sequence_params *sequenceParams, int prefixLength, uint64_t prefix, work_item *item);
+
+// Return TRUE if the work item 'item' is a part of the search tree of the sequence in 'sequenceParams', FALSE otherwise
+int isValidWorkItem(sequence_params *sequenceParams, work_item *item);
+
+// Return the number of permutations in the work item 'item' of the sequence in 'sequenceParams'
+permutation_count getWorkItemPermutations(sequence_params *sequenceParams, work_item *item);
+
+// Return the number of permutations in the work items and prefixes left in 'workQueue', which hands out the search tree of the sequence in 'sequenceParams'
+permutation_count getQueuedPermutations(work_queue *workQueue, sequence_params *sequenceParams);
+
+// Receive the next part of the search tree to search from 'workQueue' into 'item', waiting for a busy solver to split its work item if none are left. Pass TRUE in 'finishedItem' if the caller has finished its previous work item. Return TRUE if a work item was received, FALSE if the whole search tree has been searched
+int getWorkItem(work_queue *workQueue, sequence_params *sequenceParams, int finishedItem, work_item *item);
+
+// Stop handing out work items from 'workQueue', and signal busy solvers to abandon theirs
+void stopWorkQueue(work_queue *workQueue);
+
+// Hand the work item 'item' split off by a busy solver to an idle solver waiting in 'workQueue'. Return TRUE if it was handed out, FALSE if no idle solver needs it (in which case the caller keeps it)
+int donateWorkItem(work_queue *workQueue, work_item *item);
+
+// Hold 'workQueue', which must be locked, so that no work items are handed out or donated until it is released
+void holdWorkQueue(work_queue *workQueue);
+
+// Release 'workQueue', which must be locked, once held by holdWorkQueue
+void releaseWorkQueue(work_queue *workQueue);
+
+#endif
@@ -0,0 +1,221 @@
+// Defines the search kernel for grids KERNEL_WIDTH columns wide, i.e. the functions searching a work item, each named KERNEL_FUNCTION(name). Included by solver.c once for each grid width, so it has no include guard
+// The grid width is a constant in each kernel, so the loops over the columns of a skyline are unrolled and no node branches on the width. Grids at most MAX_NARROW_SKYLINE_COLUMNS wide are searched with narrow skylines
+
+#if KERNEL_WIDTH <= MAX_NARROW_SKYLINE_COLUMNS
+#define SKYLINE_TYPE narrow_skyline
+#define SKYLINE_FUNCTION(name) name##Narrow
+#define PATH_SKYLINES NarrowSkylines
+#define ROOT_SKYLINE NarrowSkyline
+#else
+#define SKYLINE_TYPE skyline
+#define SKYLINE_FUNCTION(name) name
+#define PATH_SKYLINES Skylines
+#define ROOT_SKYLINE Skyline
+#endif
+
+// Return the key of the grid state 'gridSkyline' reached after dropping the first 'depth' pieces in the transposition table, i.e. its normalised skyline, and its base height in 'baseHeight'. If the remaining pieces are their own mirror image, the grid state and its mirror image share a key
+skyline KERNEL_FUNCTION(getTranspositionKey)(sequence_params *sequenceParams, int depth, SKYLINE_TYPE gridSkyline, int *baseHeight)
+{
+    SKYLINE_TYPE normalisedSkyline = SKYLINE_FUNCTION(normaliseSkyline)(gridSkyline, KERNEL_WIDTH, baseHeight);
+    SKYLINE_TYPE mirroredSkyline;
+
+    if (depth < sequenceParams->PlacementTable.MirrorSymmetricPiece) return SKYLINE_FUNCTION(widenSkyline)(normalisedSkyline);
+
+    mirroredSkyline = SKYLINE_FUNCTION(mirrorSkyline)(normalisedSkyline, KERNEL_WIDTH);
+    return SKYLINE_FUNCTION(widenSkyline)(SKYLINE_FUNCTION(isSkylineLess)(mirroredSkyline, normalisedSkyline) == TRUE ? mirroredSkyline : normalisedSkyline);
+}
+
+// Push the node with the grid state 'gridSkyline', reached by dropping the next piece at the current placement of the deepest node, onto the path of 'solver'
+void KERNEL_FUNCTION(enterNode)(solver *solver, sequence_params *sequenceParams, SKYLINE_TYPE gridSkyline)
+{
+    int depth = ++solver->Depth;
+
+    solver->Counters.Nodes++;
+    solver->PATH_SKYLINES[depth] = gridSkyline;
+    solver->NextPlacements[depth] = sequenceParams->PlacementTable.PieceFirstPlacements[depth];
+    solver->EndPlacements[depth] = sequenceParams->PlacementTable.PieceFirstPlacements[depth + 1];
+    solver->NodeBounds[depth] = NO_NODE_BOUND;
+    solver->WholeNodes[depth] = TRUE;
+}
+
+// Pop the deepest node off the path of 'solver' once all of its children have been tried or pruned, passing its bound to its parent. Store its bound in the transposition table if the solver searched all of its children
+void KERNEL_FUNCTION(leaveNode)(solver *solver, sequence_params *sequenceParams)
+{
+    int depth = solver->Depth--;
+    skyline normalisedSkyline;
+    int baseHeight;
+
+    if (solver->WholeNodes[depth] == TRUE && solver->NodeBounds[depth] != NO_NODE_BOUND && sequenceParams->Size - depth >= TRANSPOSITION_MIN_REMAINING_PIECES)
+    {
+        normalisedSkyline = KERNEL_FUNCTION(getTranspositionKey)(sequenceParams, depth, solver->PATH_SKYLINES[depth], &baseHeight);
+        storeTranspositionBound(solver->TranspositionTable, sequenceParams->Root.Depth + depth, normalisedSkyline, solver->NodeBounds[depth] - baseHeight);
+    }
+
+    boundNode(solver, depth - 1, solver->NodeBounds[depth]);
+}
+
+// Try each remaining placement of the last piece at the deepest node on the path of 'solver', and save the lowest resulting stack if it is better than the current best
+void KERNEL_FUNCTION(tryLastPiece)(solver *solver, sequence_params *sequenceParams)
+{
+    placement *placements = sequenceParams->PlacementTable.Placements;
+    int depth = solver->Depth;
+    SKYLINE_TYPE gridSkyline = solver->PATH_SKYLINES[depth];
+    int stackHeight;
+    int minStackHeight = NO_NODE_BOUND;
+    int bestPlacement = solver->NextPlacements[depth];
+
+    // Only the lowest stack can be the best permutation, so the leaves are compared here rather than pushed onto the path. Duplicate placements stack to the same heights as the placements they duplicate, so they needn't be skipped
+    for (int placementIndex = solver->NextPlacements[depth]; placementIndex < solver->EndPlacements[depth]; placementIndex++)
+    {
+        stackHeight = SKYLINE_FUNCTION(getSkylineHeight)(SKYLINE_FUNCTION(dropPlacement)(&placements[placementIndex], gridSkyline));
+
+        if (stackHeight < minStackHeight)
+        {
+            minStackHeight = stackHeight;
+            bestPlacement = placementIndex;
+        }
+    }
+
+    solver->TriedPermutations += solver->EndPlacements[depth] - solver->NextPlacements[depth];
+    solver->NextPlacements[depth] = solver->EndPlacements[depth];
+    boundNode(solver, depth, minStackHeight);
+
+    // Save permutation if it is better than the ones found by all solvers so far
+    if (minStackHeight < ATOMIC_LOAD_INT(&solver->Incumbent->MinStackHeight))
+    {
+        solver->PathPlacements[depth] = bestPlacement;
+        saveIfBestPermutation(solver, sequenceParams, minStackHeight);
+    }
+}
+
+// Set the path of 'solver' to the root of the work item 'item'. Return FALSE if the prefix of the work item is no better than the current best, or duplicates another prefix, TRUE otherwise
+int KERNEL_FUNCTION(enterWorkItem)(solver *solver, sequence_params *sequenceParams, work_item *item)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    placement *piecePlacement;
+    SKYLINE_TYPE gridSkyline = sequenceParams->Root.ROOT_SKYLINE;
+    int prunedPrefix = FALSE;
+
+    for (int depth = 0; depth < item->Depth; depth++)
+    {
+        solver->PATH_SKYLINES[depth] = gridSkyline;
+        solver->PathPlacements[depth] = item->Placements[depth];
+        piecePlacement = &placementTable->Placements[item->Placements[depth]];
+        gridSkyline = SKYLINE_FUNCTION(dropPlacement)(piecePlacement, gridSkyline);
+
+        if (SKYLINE_FUNCTION(isDuplicatePlacement)(placementTable, piecePlacement, solver->PATH_SKYLINES[depth], gridSkyline, KERNEL_WIDTH) == TRUE || \
+            SKYLINE_FUNCTION(getStackHeightBound)(placementTable, depth + 1, gridSkyline, KERNEL_WIDTH) >= ATOMIC_LOAD_INT(&solver->Incumbent->MinStackHeight))
+        {
+            prunedPrefix = TRUE;
+            break;
+        }
+    }
+
+    if (prunedPrefix == TRUE)
+    {
+        solver->TriedPermutations += (permutation_count) (item->EndChild - item->FirstChild) * sequenceParams->SubtreePermutations[item->Depth];
+        return FALSE;
+    }
+
+    // The root of a work item may hold only some of its node's children, so its bound is never stored
+    solver->Depth = solver->RootDepth = item->Depth;
+    solver->PATH_SKYLINES[item->Depth] = gridSkyline;
+    solver->NextPlacements[item->Depth] = item->FirstChild;
+    solver->EndPlacements[item->Depth] = item->EndChild;
+    solver->NodeBounds[item->Depth] = NO_NODE_BOUND;
+    solver->WholeNodes[item->Depth] = FALSE;
+
+    return TRUE;
+}
+
+// Search the subtrees in the work item 'item' depth first, pruning each subtree which cannot hold a better permutation than the current best
+void KERNEL_FUNCTION(searchWorkItem)(solver *solver, sequence_params *sequenceParams, work_item *item)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    placement *piecePlacement;
+    SKYLINE_TYPE gridSkyline;
+    int lastPiece = sequenceParams->Size - 1;
+    int depth;
+    int minStackHeight;
+    int stackHeightBound;
+    int tableBound;
+    int baseHeight;
+
+    if (KERNEL_FUNCTION(enterWorkItem)(solver, sequenceParams, item) == FALSE) return;
+
+    while (TRUE)
+    {
+        depth = solver->Depth;
+
+        if (depth == lastPiece)
+        {
+            KERNEL_FUNCTION(tryLastPiece)(solver, sequenceParams);
+
+            // Print solver progress
+            if (solver->TriedPermutations >= solver->ProgressDisplayThreshold)
+            {
+                printSolverProgress(solver);
+                solver->ProgressDisplayThreshold = solver->TriedPermutations + solver->ProgressDisplayInterval;
+            }
+        }
+
+        // Backtrack once all children of the node have been tried or pruned
+        if (solver->NextPlacements[depth] == solver->EndPlacements[depth])
+        {
+            if (depth == solver->RootDepth) return;
+
+            KERNEL_FUNCTION(leaveNode)(solver, sequenceParams);
+            continue;
+        }
+
+        solver->PathPlacements[depth] = solver->NextPlacements[depth]++;
+        piecePlacement = &placementTable->Placements[solver->PathPlacements[depth]];
+
+        gridSkyline = SKYLINE_FUNCTION(dropPlacement)(piecePlacement, solver->PATH_SKYLINES[depth]);
+
+        // Skip the placement if an earlier placement of the piece stacks to the same grid state, or to its mirror image once the rest of the sequence is its own mirror image. The earlier placement's subtree gives the same stack heights, so it doesn't bound its parent either
+        if (SKYLINE_FUNCTION(isDuplicatePlacement)(placementTable, piecePlacement, solver->PATH_SKYLINES[depth], gridSkyline, KERNEL_WIDTH) == TRUE)
+        {
+            solver->Counters.DuplicateSubtrees++;
+            solver->TriedPermutations += sequenceParams->SubtreePermutations[depth];
+            continue;
+        }
+
+        minStackHeight = ATOMIC_LOAD_INT(&solver->Incumbent->MinStackHeight);
+        stackHeightBound = SKYLINE_FUNCTION(getStackHeightBound)(placementTable, depth + 1, gridSkyline, KERNEL_WIDTH);
+
+        // If the same grid state, up to its base height, was reached before, its stored bound may be tighter
+        if (stackHeightBound < minStackHeight && lastPiece - depth >= TRANSPOSITION_MIN_REMAINING_PIECES)
+        {
+            tableBound = probeTranspositionTable(solver->TranspositionTable, sequenceParams->Root.Depth + depth + 1, KERNEL_FUNCTION(getTranspositionKey)(sequenceParams, depth + 1, gridSkyline, &baseHeight));
+
+            if (tableBound != NO_TRANSPOSITION_BOUND)
+            {
+                solver->Counters.TableHits++;
+                if (baseHeight + tableBound > stackHeightBound) stackHeightBound = baseHeight + tableBound;
+            }
+        }
+
+        // Prune the subtree below the child if it is determined to be no better than the best permutation found by any solver, by not descending into it
+        if (stackHeightBound >= minStackHeight)
+        {
+            boundNode(solver, depth, stackHeightBound);
+            solver->Counters.PrunedSubtrees[depth]++;
+            solver->TriedPermutations += sequenceParams->SubtreePermutations[depth];
+            continue;
+        }
+
+        KERNEL_FUNCTION(enterNode)(solver, sequenceParams, gridSkyline);
+
+        // Give part of the remaining work item to idle solvers
+        if (ATOMIC_LOAD_INT(&solver->WorkQueue->RequestedItems) > 0) splitWorkItem(solver, sequenceParams);
+
+        // Abandon the work item once the search is stopped early
+        if (solver->SearchControl != NULL && --solver->NodesUntilLimitCheck == 0 && pollSearchControl(solver, sequenceParams) == TRUE) return;
+    }
+}
+
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+#undef PATH_SKYLINES
+#undef ROOT_SKYLINE
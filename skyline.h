@@ -0,0 +1,224 @@
+#ifndef SKYLINE_H
+#define SKYLINE_H
+
+#include <stdint.h>
+
+#include "bool.h"
+
+// Skyline operations are a few register operations each, so they are inlined into the solving loop
+#ifdef _MSC_VER
+#define SKYLINE_INLINE static __inline
+#else
+#define SKYLINE_INLINE static inline
+#endif
+
+#define MAX_SKYLINE_HEIGHT 255
+#define STACK_HEIGHT_SHIFT(skylineType) (8 * (int) sizeof(skylineType) - 8) // Position of the stack height byte in a skyline of type 'skylineType'
+
+#define EMPTY_SKYLINE makeSkyline(0)
+
+// Stores the state of the grid i.e. height of each column, one byte per column with column 0 in the lowest byte. Unused columns are 0. 
+// The highest byte holds the height of the highest column, so that it is saved and restored along with the columns
+// Skylines are 128 bits wide, so that they hold grids up to 15 columns wide. Compilers without a 128-bit integer type, such as MSVC, store them as two 64-bit words
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 skyline;
+#else
+typedef struct // Stores a skyline as two 64-bit words, where the compiler has no 128-bit integer type
+{
+    uint64_t Low; // Columns 0 to 7
+    uint64_t High; // Columns 8 to 14 and the height of the highest column
+} skyline;
+#endif
+#define MAX_SKYLINE_COLUMNS 15
+
+// Stores the state of a grid at most MAX_NARROW_SKYLINE_COLUMNS wide in a 64-bit skyline, which takes fewer instructions to update. Used by the solver for narrow grids
+typedef uint64_t narrow_skyline;
+#define MAX_NARROW_SKYLINE_COLUMNS 7
+
+// Define the arithmetic on each skyline type. Operations on narrow skylines are suffixed with 'Narrow'
+#define SKYLINE_TYPE narrow_skyline
+#define SKYLINE_FUNCTION(name) name##Narrow
+#include "skyline_arithmetic.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+#ifdef __SIZEOF_INT128__
+
+#define SKYLINE_TYPE skyline
+#define SKYLINE_FUNCTION(name) name
+#include "skyline_arithmetic.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+#else // Arithmetic on skylines held in two 64-bit words, carrying between the words
+
+// Return the skyline whose low and high 64-bit words are 'low' and 'high'
+SKYLINE_INLINE skyline getSkylineFromWords(uint64_t low, uint64_t high)
+{
+    skyline state;
+
+    state.Low = low;
+    state.High = high;
+    return state;
+}
+
+// Return a skyline holding 'bits' in its lowest 64 bits
+SKYLINE_INLINE skyline makeSkyline(uint64_t bits)
+{
+    return getSkylineFromWords(bits, 0);
+}
+
+// Return a skyline with each of its 64-bit words set to 'word'
+SKYLINE_INLINE skyline repeatSkylineWord(uint64_t word)
+{
+    return getSkylineFromWords(word, word);
+}
+
+// Return the lowest 64 bits of 'state'
+SKYLINE_INLINE uint64_t getLowSkylineBits(skyline state)
+{
+    return state.Low;
+}
+
+// Return the bits of 'state' above its lowest 64 bits, which are 0 in a 64-bit skyline
+SKYLINE_INLINE uint64_t getHighSkylineBits(skyline state)
+{
+    return state.High;
+}
+
+// Return 'state' shifted towards its highest bit by 'bits' bits, which must be less than its width
+SKYLINE_INLINE skyline shiftSkylineLeft(skyline state, int bits)
+{
+    // A 64-bit word can't be shifted by its whole width, so shifts by 0 and by 64 or more don't carry between the words
+    if (bits == 0) return state;
+    if (bits >= 64) return getSkylineFromWords(0, state.Low << (bits - 64));
+
+    return getSkylineFromWords(state.Low << bits, state.High << bits | state.Low >> (64 - bits));
+}
+
+// Return 'state' shifted towards its lowest bit by 'bits' bits, which must be less than its width
+SKYLINE_INLINE skyline shiftSkylineRight(skyline state, int bits)
+{
+    // A 64-bit word can't be shifted by its whole width, so shifts by 0 and by 64 or more don't carry between the words
+    if (bits == 0) return state;
+    if (bits >= 64) return getSkylineFromWords(state.High >> (bits - 64), 0);
+
+    return getSkylineFromWords(state.Low >> bits | state.High << (64 - bits), state.High >> bits);
+}
+
+// Return the bits set in both 'state' and 'mask'
+SKYLINE_INLINE skyline andSkylines(skyline state, skyline mask)
+{
+    return getSkylineFromWords(state.Low & mask.Low, state.High & mask.High);
+}
+
+// Return the bits set in either 'state' or 'mask'
+SKYLINE_INLINE skyline orSkylines(skyline state, skyline mask)
+{
+    return getSkylineFromWords(state.Low | mask.Low, state.High | mask.High);
+}
+
+// Return the bits not set in 'state'
+SKYLINE_INLINE skyline invertSkyline(skyline state)
+{
+    return getSkylineFromWords(~state.Low, ~state.High);
+}
+
+// Return the sum of 'state' and 'other', wrapping around past the width of the skyline
+SKYLINE_INLINE skyline addSkylines(skyline state, skyline other)
+{
+    uint64_t low = state.Low + other.Low;
+
+    // The low word wrapped around if the sum is less than either of its terms
+    return getSkylineFromWords(low, state.High + other.High + (low < state.Low ? 1 : 0));
+}
+
+// Return 'state' minus 'other', wrapping around below 0
+SKYLINE_INLINE skyline subtractSkylines(skyline state, skyline other)
+{
+    return getSkylineFromWords(state.Low - other.Low, state.High - other.High - (state.Low < other.Low ? 1 : 0));
+}
+
+// Return the product of 'state' and 'other', wrapping around past the width of the skyline
+SKYLINE_INLINE skyline multiplySkylines(skyline state, skyline other)
+{
+    // Multiply the low words in 32-bit halves, so that no partial product overflows, then add the products of the low and high words to the high word
+    uint64_t lowProduct = (state.Low & 0xFFFFFFFF) * (other.Low & 0xFFFFFFFF);
+    uint64_t crossProduct = (state.Low >> 32) * (other.Low & 0xFFFFFFFF);
+    uint64_t otherCrossProduct = (state.Low & 0xFFFFFFFF) * (other.Low >> 32);
+    uint64_t middle = (lowProduct >> 32) + (crossProduct & 0xFFFFFFFF) + (otherCrossProduct & 0xFFFFFFFF);
+    uint64_t high = (state.Low >> 32) * (other.Low >> 32) + (crossProduct >> 32) + (otherCrossProduct >> 32) + (middle >> 32);
+
+    return getSkylineFromWords(middle << 32 | (lowProduct & 0xFFFFFFFF), high + state.Low * other.High + state.High * other.Low);
+}
+
+// Return TRUE if 'state' and 'other' hold the same bits, FALSE otherwise
+SKYLINE_INLINE int areSkylinesEqual(skyline state, skyline other)
+{
+    return state.Low == other.Low && state.High == other.High ? TRUE : FALSE;
+}
+
+// Return TRUE if 'state' is less than 'other' as an unsigned number, FALSE otherwise. Orders skylines, e.g. to pick one of a grid state and its mirror image
+SKYLINE_INLINE int isSkylineLess(skyline state, skyline other)
+{
+    return state.High < other.High || (state.High == other.High && state.Low < other.Low) ? TRUE : FALSE;
+}
+
+#endif
+
+// Return the lowest 64 bits of 'state' as a narrow skyline, e.g. the masks of a placement in a grid at most MAX_NARROW_SKYLINE_COLUMNS wide
+SKYLINE_INLINE narrow_skyline castSkylineNarrow(skyline state)
+{
+    return getLowSkylineBits(state);
+}
+
+// Return 'state'. Lets the operations on either skyline type read the skyline masks of a placement the same way
+SKYLINE_INLINE skyline castSkyline(skyline state)
+{
+    return state;
+}
+
+// Return the narrow skyline 'state' in the lowest 64 bits of a skyline, e.g. to key the transposition table by it
+SKYLINE_INLINE skyline widenSkylineNarrow(narrow_skyline state)
+{
+    return makeSkyline(state);
+}
+
+// Return 'state'. Lets the operations on either skyline type key the transposition table the same way
+SKYLINE_INLINE skyline widenSkyline(skyline state)
+{
+    return state;
+}
+
+// Define the skyline operations for each skyline type. Operations on narrow skylines are suffixed with 'Narrow'
+#define SKYLINE_TYPE skyline
+#define SKYLINE_FUNCTION(name) name
+#include "skyline_operations.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+#define SKYLINE_TYPE narrow_skyline
+#define SKYLINE_FUNCTION(name) name##Narrow
+#include "skyline_operations.h"
+#undef SKYLINE_TYPE
+#undef SKYLINE_FUNCTION
+
+// Return the grid state 'state', at most MAX_NARROW_SKYLINE_COLUMNS wide, as a narrow skyline
+SKYLINE_INLINE narrow_skyline getNarrowSkyline(skyline state)
+{
+    narrow_skyline columns = getLowSkylineBits(state) & (((narrow_skyline) 1 << STACK_HEIGHT_SHIFT(narrow_skyline)) - 1);
+
+    return columns | (narrow_skyline) getSkylineHeight(state) << STACK_HEIGHT_SHIFT(narrow_skyline);
+}
+
+// Return a hash of the grid state 'state' mixed with 'salt', which tells apart equal skylines reached in different ways, e.g. at different base heights
+SKYLINE_INLINE uint64_t getSkylineHash(skyline state, uint64_t salt)
+{
+    uint64_t hash = getLowSkylineBits(state) * 0x9E3779B97F4A7C15ULL ^ getHighSkylineBits(state) * 0xC2B2AE3D27D4EB4FULL ^ salt * 0x165667B19E3779F9ULL;
+
+    hash ^= hash >> 29;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    return hash ^ (hash >> 32);
+}
+
+#endif
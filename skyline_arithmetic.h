@@ -0,0 +1,88 @@
+// Defines the arithmetic on skylines of type SKYLINE_TYPE, an unsigned integer type, each named SKYLINE_FUNCTION(name). Included by skyline.h once for each skyline type held in an integer type, so it has no include guard
+// Skylines held in two 64-bit words have the same operations, defined in skyline.h. Each operation is a single integer operation here
+
+// Return a skyline holding 'bits' in its lowest 64 bits
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(makeSkyline)(uint64_t bits)
+{
+    return (SKYLINE_TYPE) bits;
+}
+
+// Return a skyline with each of its 64-bit words set to 'word'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(repeatSkylineWord)(uint64_t word)
+{
+    // Shifted in two steps, as a 64-bit skyline can't be shifted by its whole width
+    return (SKYLINE_TYPE) word | (SKYLINE_TYPE) word << 32 << 32;
+}
+
+// Return the lowest 64 bits of 'state'
+SKYLINE_INLINE uint64_t SKYLINE_FUNCTION(getLowSkylineBits)(SKYLINE_TYPE state)
+{
+    return (uint64_t) state;
+}
+
+// Return the bits of 'state' above its lowest 64 bits, which are 0 in a 64-bit skyline
+SKYLINE_INLINE uint64_t SKYLINE_FUNCTION(getHighSkylineBits)(SKYLINE_TYPE state)
+{
+    // Shifted in two steps, as a 64-bit skyline can't be shifted by its whole width
+    return (uint64_t) (state >> 32 >> 32);
+}
+
+// Return 'state' shifted towards its highest bit by 'bits' bits, which must be less than its width
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_TYPE state, int bits)
+{
+    return state << bits;
+}
+
+// Return 'state' shifted towards its lowest bit by 'bits' bits, which must be less than its width
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(shiftSkylineRight)(SKYLINE_TYPE state, int bits)
+{
+    return state >> bits;
+}
+
+// Return the bits set in both 'state' and 'mask'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(andSkylines)(SKYLINE_TYPE state, SKYLINE_TYPE mask)
+{
+    return state & mask;
+}
+
+// Return the bits set in either 'state' or 'mask'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(orSkylines)(SKYLINE_TYPE state, SKYLINE_TYPE mask)
+{
+    return state | mask;
+}
+
+// Return the bits not set in 'state'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(invertSkyline)(SKYLINE_TYPE state)
+{
+    return ~state;
+}
+
+// Return the sum of 'state' and 'other', wrapping around past the width of the skyline
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(addSkylines)(SKYLINE_TYPE state, SKYLINE_TYPE other)
+{
+    return state + other;
+}
+
+// Return 'state' minus 'other', wrapping around below 0
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(subtractSkylines)(SKYLINE_TYPE state, SKYLINE_TYPE other)
+{
+    return state - other;
+}
+
+// Return the product of 'state' and 'other', wrapping around past the width of the skyline
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(multiplySkylines)(SKYLINE_TYPE state, SKYLINE_TYPE other)
+{
+    return state * other;
+}
+
+// Return TRUE if 'state' and 'other' hold the same bits, FALSE otherwise
+SKYLINE_INLINE int SKYLINE_FUNCTION(areSkylinesEqual)(SKYLINE_TYPE state, SKYLINE_TYPE other)
+{
+    return state == other ? TRUE : FALSE;
+}
+
+// Return TRUE if 'state' is less than 'other' as an unsigned number, FALSE otherwise. Orders skylines, e.g. to pick one of a grid state and its mirror image
+SKYLINE_INLINE int SKYLINE_FUNCTION(isSkylineLess)(SKYLINE_TYPE state, SKYLINE_TYPE other)
+{
+    return state < other ? TRUE : FALSE;
+}
@@ -0,0 +1,88 @@
+// Defines the operations on skylines of type SKYLINE_TYPE, each named SKYLINE_FUNCTION(name). Included by skyline.h once for each skyline type, so it has no include guard
+
+// Return the height of column 'column' in 'state'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getColumnHeight)(SKYLINE_TYPE state, int column)
+{
+    return (int) (SKYLINE_FUNCTION(getLowSkylineBits)(SKYLINE_FUNCTION(shiftSkylineRight)(state, 8 * column)) & 0xFF);
+}
+
+// Return the height of the highest column in 'state'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getSkylineHeight)(SKYLINE_TYPE state)
+{
+    return (int) SKYLINE_FUNCTION(getLowSkylineBits)(SKYLINE_FUNCTION(shiftSkylineRight)(state, STACK_HEIGHT_SHIFT(SKYLINE_TYPE)));
+}
+
+// Return the column heights in 'state', without the height of the highest column
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(getSkylineColumns)(SKYLINE_TYPE state)
+{
+    return SKYLINE_FUNCTION(andSkylines)(state, SKYLINE_FUNCTION(invertSkyline)(SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)(0xFF), STACK_HEIGHT_SHIFT(SKYLINE_TYPE))));
+}
+
+// Return 'state' with the height of its highest column replaced by 'height'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(setSkylineHeight)(SKYLINE_TYPE state, int height)
+{
+    return SKYLINE_FUNCTION(orSkylines)(SKYLINE_FUNCTION(getSkylineColumns)(state), SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)((uint64_t) height), STACK_HEIGHT_SHIFT(SKYLINE_TYPE)));
+}
+
+// Return 'state' with the heights of the 'width' columns starting from column 'column' replaced by the heights in 'columns' (one byte per column, lowest byte first). 'columns' must not be lower than the columns it replaces
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(raiseColumns)(SKYLINE_TYPE state, int column, int width, SKYLINE_TYPE columns, int columnsHeight)
+{
+    SKYLINE_TYPE replacedColumns = SKYLINE_FUNCTION(subtractSkylines)(SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)(1), 8 * width), SKYLINE_FUNCTION(makeSkyline)(1));
+
+    replacedColumns = SKYLINE_FUNCTION(shiftSkylineLeft)(replacedColumns, 8 * column);
+    state = SKYLINE_FUNCTION(orSkylines)(SKYLINE_FUNCTION(andSkylines)(state, SKYLINE_FUNCTION(invertSkyline)(replacedColumns)), SKYLINE_FUNCTION(shiftSkylineLeft)(columns, 8 * column));
+    if (columnsHeight > SKYLINE_FUNCTION(getSkylineHeight)(state)) state = SKYLINE_FUNCTION(setSkylineHeight)(state, columnsHeight);
+
+    return state;
+}
+
+// Return 'state' with the height of column 'column' raised to 'height'
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(raiseColumnHeight)(SKYLINE_TYPE state, int column, int height)
+{
+    return SKYLINE_FUNCTION(raiseColumns)(state, column, 1, SKYLINE_FUNCTION(makeSkyline)((uint64_t) height), height);
+}
+
+// Return the height of the lowest of the first 'width' columns in 'state'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getLowestColumnHeight)(SKYLINE_TYPE state, int width)
+{
+    int lowestHeight = SKYLINE_FUNCTION(getColumnHeight)(state, 0);
+
+    for (int column = 1; column < width; column++)
+        if (SKYLINE_FUNCTION(getColumnHeight)(state, column) < lowestHeight) lowestHeight = SKYLINE_FUNCTION(getColumnHeight)(state, column);
+
+    return lowestHeight;
+}
+
+// Return the sum of the column heights in 'state'
+SKYLINE_INLINE int SKYLINE_FUNCTION(getSkylineArea)(SKYLINE_TYPE state)
+{
+    SKYLINE_TYPE columns = SKYLINE_FUNCTION(getSkylineColumns)(state);
+    SKYLINE_TYPE lanes = SKYLINE_FUNCTION(repeatSkylineWord)(0x0001000100010001); // The lowest bit of each 16-bit lane
+    SKYLINE_TYPE laneColumns = SKYLINE_FUNCTION(repeatSkylineWord)(0x00FF00FF00FF00FF); // The low byte of each 16-bit lane
+
+    // Add neighbouring columns into 16-bit lanes, which cannot overflow, then add the lanes into the highest one
+    columns = SKYLINE_FUNCTION(addSkylines)(SKYLINE_FUNCTION(andSkylines)(columns, laneColumns), SKYLINE_FUNCTION(andSkylines)(SKYLINE_FUNCTION(shiftSkylineRight)(columns, 8), laneColumns));
+    return (int) SKYLINE_FUNCTION(getLowSkylineBits)(SKYLINE_FUNCTION(shiftSkylineRight)(SKYLINE_FUNCTION(multiplySkylines)(columns, lanes), 8 * (int) sizeof(SKYLINE_TYPE) - 16));
+}
+
+// Return 'state' lowered so that the lowest of its first 'width' columns is at height 0, and the height it was lowered by in 'baseHeight'. Stacking pieces onto either skyline gives the same shape, so they share a normalised skyline
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(normaliseSkyline)(SKYLINE_TYPE state, int width, int *baseHeight)
+{
+    SKYLINE_TYPE columnBytes = SKYLINE_FUNCTION(subtractSkylines)(SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)(1), 8 * width), SKYLINE_FUNCTION(makeSkyline)(1));
+    SKYLINE_TYPE loweredBytes = SKYLINE_FUNCTION(andSkylines)(SKYLINE_FUNCTION(repeatSkylineWord)(0x0101010101010101), columnBytes);
+
+    loweredBytes = SKYLINE_FUNCTION(orSkylines)(loweredBytes, SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)(1), STACK_HEIGHT_SHIFT(SKYLINE_TYPE)));
+    *baseHeight = SKYLINE_FUNCTION(getLowestColumnHeight)(state, width);
+    return SKYLINE_FUNCTION(subtractSkylines)(state, SKYLINE_FUNCTION(multiplySkylines)(SKYLINE_FUNCTION(makeSkyline)((uint64_t) *baseHeight), loweredBytes));
+}
+
+// Return 'state' with its first 'width' columns in reverse order
+SKYLINE_INLINE SKYLINE_TYPE SKYLINE_FUNCTION(mirrorSkyline)(SKYLINE_TYPE state, int width)
+{
+    SKYLINE_TYPE mirroredState = SKYLINE_FUNCTION(setSkylineHeight)(SKYLINE_FUNCTION(makeSkyline)(0), SKYLINE_FUNCTION(getSkylineHeight)(state));
+
+    for (int column = 0; column < width; column++)
+        mirroredState = SKYLINE_FUNCTION(orSkylines)(mirroredState, SKYLINE_FUNCTION(shiftSkylineLeft)(SKYLINE_FUNCTION(makeSkyline)((uint64_t) SKYLINE_FUNCTION(getColumnHeight)(state, column)), 8 * (width - 1 - column)));
+
+    return mirroredState;
+}
@@ -0,0 +1,341 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bool.h"
+#include "solution_cache.h"
+#include "input_utils.h"
+#include "tetromino.h"
+
+#ifdef _WIN32 // Windows implementation (memory-mapped file)
+
+#include <windows.h>
+
+// Open the file at 'path', creating it if it doesn't exist, and map 'size' bytes of it into the memory of 'solutionCache'. Return TRUE if it was mapped, FALSE otherwise
+int mapCacheFile(solution_cache *solutionCache, const char *path, size_t size)
+{
+    solutionCache->File = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (solutionCache->File == INVALID_HANDLE_VALUE) return FALSE;
+
+    // The mapping grows the file to 'size' bytes if it is smaller
+    solutionCache->Mapping = CreateFileMappingA(solutionCache->File, NULL, PAGE_READWRITE, (DWORD) ((uint64_t) size >> 32), (DWORD) size, NULL);
+    if (solutionCache->Mapping == NULL)
+    {
+        CloseHandle(solutionCache->File);
+        return FALSE;
+    }
+
+    solutionCache->View = MapViewOfFile(solutionCache->Mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (solutionCache->View == NULL)
+    {
+        CloseHandle(solutionCache->Mapping);
+        CloseHandle(solutionCache->File);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+// Unmap and close the file of 'solutionCache'
+void unmapCacheFile(solution_cache *solutionCache)
+{
+    UnmapViewOfFile(solutionCache->View);
+    CloseHandle(solutionCache->Mapping);
+    CloseHandle(solutionCache->File);
+}
+
+// Block until the file of 'solutionCache' is locked by the calling thread. Only one thread holds an 'exclusive' lock, any number of threads may hold a lock which isn't
+void lockCacheFile(solution_cache *solutionCache, int exclusive)
+{
+    OVERLAPPED lockedRange = {0};
+
+    LockFileEx(solutionCache->File, exclusive == TRUE ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, 1, 0, &lockedRange);
+}
+
+// Release the lock held on the file of 'solutionCache'
+void unlockCacheFile(solution_cache *solutionCache)
+{
+    OVERLAPPED lockedRange = {0};
+
+    UnlockFileEx(solutionCache->File, 0, 1, 0, &lockedRange);
+}
+
+// Write the 'size' bytes at 'start', inside the mapped file of 'solutionCache', back to the file if the file isn't written to as its memory is
+void writeCacheRange(solution_cache *solutionCache, void *start, size_t size)
+{
+    // Other processes map the same pages, and the system writes them back to the file
+    (void) solutionCache;
+    (void) start;
+    (void) size;
+}
+
+
+#elif defined __linux__ // Linux implementation (memory-mapped file)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Open the file at 'path', creating it if it doesn't exist, and map 'size' bytes of it into the memory of 'solutionCache'. Return TRUE if it was mapped, FALSE otherwise
+int mapCacheFile(solution_cache *solutionCache, const char *path, size_t size)
+{
+    struct stat fileStatus;
+
+    solutionCache->File = open(path, O_RDWR | O_CREAT, 0644);
+    if (solutionCache->File < 0) return FALSE;
+
+    // Processes opening a new file at the same time grow it to the same size
+    if (fstat(solutionCache->File, &fileStatus) != 0 || ((size_t) fileStatus.st_size < size && ftruncate(solutionCache->File, (off_t) size) != 0))
+    {
+        close(solutionCache->File);
+        return FALSE;
+    }
+
+    solutionCache->View = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, solutionCache->File, 0);
+    if (solutionCache->View == MAP_FAILED)
+    {
+        close(solutionCache->File);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+// Unmap and close the file of 'solutionCache'
+void unmapCacheFile(solution_cache *solutionCache)
+{
+    munmap(solutionCache->View, solutionCache->Size);
+    close(solutionCache->File);
+}
+
+// Block until the file of 'solutionCache' is locked by the calling thread. Only one thread holds an 'exclusive' lock, any number of threads may hold a lock which isn't
+void lockCacheFile(solution_cache *solutionCache, int exclusive)
+{
+    // Each cache opens its own file description, so the lock also excludes other caches in the same process
+    while (flock(solutionCache->File, exclusive == TRUE ? LOCK_EX : LOCK_SH) != 0 && errno == EINTR);
+}
+
+// Release the lock held on the file of 'solutionCache'
+void unlockCacheFile(solution_cache *solutionCache)
+{
+    flock(solutionCache->File, LOCK_UN);
+}
+
+// Write the 'size' bytes at 'start', inside the mapped file of 'solutionCache', back to the file if the file isn't written to as its memory is
+void writeCacheRange(solution_cache *solutionCache, void *start, size_t size)
+{
+    // Other processes map the same pages, and the kernel writes them back to the file
+    (void) solutionCache;
+    (void) start;
+    (void) size;
+}
+
+
+#else // Standard implementation (file read into memory, not shared between processes)
+
+#include <stdio.h>
+
+// Open the file at 'path', creating it if it doesn't exist, and map 'size' bytes of it into the memory of 'solutionCache'. Return TRUE if it was mapped, FALSE otherwise
+int mapCacheFile(solution_cache *solutionCache, const char *path, size_t size)
+{
+    solutionCache->File = fopen(path, "r+b");
+    if (solutionCache->File == NULL) solutionCache->File = fopen(path, "w+b");
+    if (solutionCache->File == NULL) return FALSE;
+
+    // Without memory-mapped files the whole file is read into memory. Bytes past the end of the file read as zero
+    solutionCache->View = calloc(1, size);
+    if (solutionCache->View == NULL)
+    {
+        fclose(solutionCache->File);
+        return FALSE;
+    }
+
+    fread(solutionCache->View, 1, size, solutionCache->File);
+    return TRUE;
+}
+
+// Unmap and close the file of 'solutionCache'
+void unmapCacheFile(solution_cache *solutionCache)
+{
+    free(solutionCache->View);
+    fclose(solutionCache->File);
+}
+
+// Block until the file of 'solutionCache' is locked by the calling thread. Only one thread holds an 'exclusive' lock, any number of threads may hold a lock which isn't
+void lockCacheFile(solution_cache *solutionCache, int exclusive)
+{
+    // Only one thread runs, and the file isn't shared between processes
+    (void) solutionCache;
+    (void) exclusive;
+}
+
+// Release the lock held on the file of 'solutionCache'
+void unlockCacheFile(solution_cache *solutionCache)
+{
+    (void) solutionCache;
+}
+
+// Write the 'size' bytes at 'start', inside the mapped file of 'solutionCache', back to the file if the file isn't written to as its memory is
+void writeCacheRange(solution_cache *solutionCache, void *start, size_t size)
+{
+    fseek(solutionCache->File, (long) ((char *) start - (char *) solutionCache->View), SEEK_SET);
+    fwrite(start, 1, size, solutionCache->File);
+    fflush(solutionCache->File);
+}
+
+#endif
+
+// Return a hash of the rotations of every tetromino in tetromino.c
+uint64_t getTetrominoTableHash()
+{
+    uint64_t hash = 0xCBF29CE484222325; // FNV-1a offset basis
+    tetromino *tet;
+    const unsigned char *tetBytes;
+
+    // Custom tetrominos may use any character, so every character which is a tetromino is hashed
+    for (int piece = 1; piece < 128; piece++)
+    {
+        if (getTetromino((char) piece, ROTATION_0) == FALSE) continue;
+
+        for (int rotation = 0; rotation < getRotations((char) piece); rotation++)
+        {
+            tet = getTetromino((char) piece, rotation);
+            tetBytes = (const unsigned char *) tet;
+
+            hash = (hash ^ (uint64_t) piece) * 0x100000001B3;
+            for (size_t tetByte = 0; tetByte < sizeof(tetromino); tetByte++) hash = (hash ^ tetBytes[tetByte]) * 0x100000001B3;
+        }
+    }
+
+    return hash;
+}
+
+// Return the key of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide
+uint64_t getSolutionCacheKey(sequence_params *sequenceParams, int gridWidth)
+{
+    uint64_t key = 0xCBF29CE484222325;
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++) key = (key ^ (unsigned char) sequenceParams->Sequence[piece]) * 0x100000001B3;
+    key = (key ^ (uint64_t) sequenceParams->AllowRotation) * 0x100000001B3;
+    key = (key ^ (uint64_t) gridWidth) * 0x100000001B3;
+
+    // Keys of 0 are kept for empty slots
+    return key != 0 ? key : 1;
+}
+
+// Open the cache file at 'path' into 'solutionCache', discarding its solutions if they were stored by a program with a different cache layout or tetrominos. Return TRUE if it was opened, FALSE otherwise
+int openSolutionCache(solution_cache *solutionCache, const char *path)
+{
+    solution_cache_header expectedHeader = {0};
+
+    solutionCache->Size = sizeof(solution_cache_header) + sizeof(solution_cache_entry) * SOLUTION_CACHE_SLOTS;
+    if (mapCacheFile(solutionCache, path, solutionCache->Size) == FALSE) return FALSE;
+
+    solutionCache->Header = (solution_cache_header *) solutionCache->View;
+    solutionCache->Entries = (solution_cache_entry *) (solutionCache->Header + 1);
+
+    expectedHeader.Magic = SOLUTION_CACHE_MAGIC;
+    expectedHeader.FormatVersion = SOLUTION_CACHE_FORMAT_VERSION;
+    expectedHeader.Slots = SOLUTION_CACHE_SLOTS;
+    expectedHeader.MaxSequenceSize = MAX_SEQUENCE_SIZE;
+    expectedHeader.TetrominoHash = getTetrominoTableHash();
+
+    // A new file is all zeroes, so its header is written the same way as the header of a file from an older program
+    lockCacheFile(solutionCache, TRUE);
+
+    expectedHeader.Solutions = solutionCache->Header->Solutions;
+    if (memcmp(solutionCache->Header, &expectedHeader, sizeof(solution_cache_header)) != 0)
+    {
+        // The slots of a new file are already empty, and are left unwritten so that the file stays sparse
+        expectedHeader.Solutions = 0;
+        if (solutionCache->Header->Magic != 0) memset(solutionCache->View, 0, solutionCache->Size);
+        memcpy(solutionCache->Header, &expectedHeader, sizeof(solution_cache_header));
+        writeCacheRange(solutionCache, solutionCache->View, solutionCache->Size);
+    }
+
+    unlockCacheFile(solutionCache);
+    return TRUE;
+}
+
+// Close the cache file of 'solutionCache'. Its solutions are kept in the file
+void closeSolutionCache(solution_cache *solutionCache)
+{
+    unmapCacheFile(solutionCache);
+}
+
+// Return the slot of 'solutionCache' holding the solution of the sequence in 'sequenceParams' with the key 'key', solved in a grid 'gridWidth' columns wide.
+// If it isn't cached, return the empty slot it would be stored in, or NULL if the slots it may be stored in are full. 'solutionCache' must be locked
+solution_cache_entry *findCacheSlot(solution_cache *solutionCache, sequence_params *sequenceParams, int gridWidth, uint64_t key)
+{
+    solution_cache_entry *entry;
+
+    // Solutions are never removed, so a solution is always found before the first empty slot after its home slot
+    for (int probe = 0; probe < SOLUTION_CACHE_MAX_PROBES; probe++)
+    {
+        entry = &solutionCache->Entries[(key + probe) & (SOLUTION_CACHE_SLOTS - 1)];
+
+        if (entry->Filled == FALSE) return entry;
+        if (entry->Key == key && entry->Size == sequenceParams->Size && entry->AllowRotation == sequenceParams->AllowRotation && \
+            entry->GridWidth == gridWidth && memcmp(entry->Sequence, sequenceParams->Sequence, sequenceParams->Size) == 0) return entry;
+    }
+
+    return NULL;
+}
+
+// Copy the solution of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide from 'solutionCache' into 'solution'. Return TRUE if it was cached, FALSE otherwise
+int lookUpCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, int gridWidth, solution_cache_entry *solution)
+{
+    solution_cache_entry *entry;
+    int cached = FALSE;
+
+    lockCacheFile(solutionCache, FALSE);
+
+    entry = findCacheSlot(solutionCache, sequenceParams, gridWidth, getSolutionCacheKey(sequenceParams, gridWidth));
+    if (entry != NULL && entry->Filled == TRUE)
+    {
+        *solution = *entry;
+        cached = TRUE;
+    }
+
+    unlockCacheFile(solutionCache);
+    return cached;
+}
+
+// Store the solution of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide, the column and rotation of each piece in 'pieceColumns' and 'pieceRotations' stacking to 'stackHeight', in 'solutionCache'.
+// The solution isn't stored if it is already cached, or the slots it may be stored in are full
+void storeCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, int gridWidth, int stackHeight, int pieceColumns[], int pieceRotations[])
+{
+    uint64_t key = getSolutionCacheKey(sequenceParams, gridWidth);
+    solution_cache_entry *entry;
+
+    lockCacheFile(solutionCache, TRUE);
+
+    // Another process may have stored the solution since it was looked up
+    entry = findCacheSlot(solutionCache, sequenceParams, gridWidth, key);
+    if (entry != NULL && entry->Filled == FALSE)
+    {
+        entry->Key = key;
+        entry->Size = (unsigned char) sequenceParams->Size;
+        entry->AllowRotation = (unsigned char) sequenceParams->AllowRotation;
+        entry->GridWidth = (unsigned char) gridWidth;
+        entry->StackHeight = (unsigned char) stackHeight;
+        memcpy(entry->Sequence, sequenceParams->Sequence, sequenceParams->Size);
+
+        for (int piece = 0; piece < sequenceParams->Size; piece++)
+        {
+            entry->PieceColumns[piece] = (unsigned char) pieceColumns[piece];
+            entry->PieceRotations[piece] = (unsigned char) pieceRotations[piece];
+        }
+
+        // The slot is marked as filled last, so a process which stops while storing the solution leaves the slot empty
+        entry->Filled = TRUE;
+        solutionCache->Header->Solutions++;
+
+        writeCacheRange(solutionCache, entry, sizeof(solution_cache_entry));
+        writeCacheRange(solutionCache, solutionCache->Header, sizeof(solution_cache_header));
+    }
+
+    unlockCacheFile(solutionCache);
+}
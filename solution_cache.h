@@ -0,0 +1,106 @@
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "input_utils.h"
+#include "tetromino.h"
+
+#define SOLUTION_CACHE_MAGIC 0x4548434143535354 // "TSSCACHE" in little-endian byte order, so that other files aren't mistaken for a cache
+#define SOLUTION_CACHE_FORMAT_VERSION 2 // Incremented whenever the layout of the cache file changes
+#define SOLUTION_CACHE_SLOTS 65536 // Must be a power of 2. Unused slots take no disk space on file systems with sparse files
+#define SOLUTION_CACHE_MAX_PROBES 32 // Number of slots searched for a solution before it is considered not cached
+
+typedef struct // Stores the header at the start of a cache file. The solutions in the file are discarded if any field differs from the one expected by the program opening it
+{
+    uint64_t Magic;
+    uint32_t FormatVersion;
+    uint32_t Slots;
+    uint32_t MaxSequenceSize;
+    uint32_t Solutions; // Number of solutions stored
+    uint64_t TetrominoHash; // Hash of the tetromino tables, so that changes to tetromino.c discard solutions stacked with the old tetrominos
+} solution_cache_header;
+
+typedef struct // Stores the solution of one sequence. Slots are only written once, so a solution is never changed after it is stored
+{
+    uint64_t Key; // Hash of the sequence, rotation flag and grid width. The number of permutations isn't stored, as it follows from them
+    unsigned char Filled; // TRUE once the slot holds a solution
+    unsigned char Size;
+    unsigned char AllowRotation;
+    unsigned char GridWidth;
+    unsigned char StackHeight;
+    char Sequence[MAX_SEQUENCE_SIZE];
+    unsigned char PieceColumns[MAX_SEQUENCE_SIZE];
+    unsigned char PieceRotations[MAX_SEQUENCE_SIZE];
+} solution_cache_entry;
+
+
+#ifdef _WIN32 // Windows implementation (memory-mapped file)
+
+#include <windows.h>
+
+typedef HANDLE cache_file;
+typedef HANDLE cache_mapping;
+
+
+#elif defined __linux__ // Linux implementation (memory-mapped file)
+
+typedef int cache_file;
+typedef int cache_mapping; // Unused, the file is mapped directly
+
+
+#else // Standard implementation (file read into memory, not shared between processes)
+
+#include <stdio.h>
+
+typedef FILE *cache_file;
+typedef int cache_mapping; // Unused
+
+#endif
+
+typedef struct // Stores solutions in a file mapped into memory, shared by every process solving with the same cache file. Solutions are read under a shared file lock and written under an exclusive one
+{
+    cache_file File;
+    cache_mapping Mapping;
+    void *View; // The whole file, starting with the header
+    size_t Size;
+    solution_cache_header *Header;
+    solution_cache_entry *Entries;
+} solution_cache;
+
+// Open the file at 'path', creating it if it doesn't exist, and map 'size' bytes of it into the memory of 'solutionCache'. Return TRUE if it was mapped, FALSE otherwise
+int mapCacheFile(solution_cache *solutionCache, const char *path, size_t size);
+
+// Unmap and close the file of 'solutionCache'
+void unmapCacheFile(solution_cache *solutionCache);
+
+// Block until the file of 'solutionCache' is locked by the calling thread. Only one thread holds an 'exclusive' lock, any number of threads may hold a lock which isn't
+void lockCacheFile(solution_cache *solutionCache, int exclusive);
+
+// Release the lock held on the file of 'solutionCache'
+void unlockCacheFile(solution_cache *solutionCache);
+
+// Write the 'size' bytes at 'start', inside the mapped file of 'solutionCache', back to the file if the file isn't written to as its memory is
+void writeCacheRange(solution_cache *solutionCache, void *start, size_t size);
+
+// Return a hash of the rotations of every tetromino in tetromino.c
+uint64_t getTetrominoTableHash();
+
+// Return the key of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide
+uint64_t getSolutionCacheKey(sequence_params *sequenceParams, int gridWidth);
+
+// Open the cache file at 'path' into 'solutionCache', discarding its solutions if they were stored by a program with a different cache layout or tetrominos. Return TRUE if it was opened, FALSE otherwise
+int openSolutionCache(solution_cache *solutionCache, const char *path);
+
+// Close the cache file of 'solutionCache'. Its solutions are kept in the file
+void closeSolutionCache(solution_cache *solutionCache);
+
+// Copy the solution of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide from 'solutionCache' into 'solution'. Return TRUE if it was cached, FALSE otherwise
+int lookUpCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, int gridWidth, solution_cache_entry *solution);
+
+// Store the solution of the sequence in 'sequenceParams' solved in a grid 'gridWidth' columns wide, the column and rotation of each piece in 'pieceColumns' and 'pieceRotations' stacking to 'stackHeight', in 'solutionCache'.
+// The solution isn't stored if it is already cached, or the slots it may be stored in are full
+void storeCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, int gridWidth, int stackHeight, int pieceColumns[], int pieceRotations[]);
+
+#endif
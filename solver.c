@@ -1,311 +1,434 @@
 #include <stdio.h>
 #include <string.h>
-#include <windows.h>
+#include <time.h>
 
 #include "bool.h"
 #include "solver.h"
 #include "input_utils.h"
 #include "tetromino.h"
 #include "run_solvers.h"
+#include "thread_utils.h"
+#include "heuristic.h"
+#include "solution_cache.h"
+#include "telemetry.h"
 
-// Calculate and return the total number of permutations at which the sequence in 'sequenceParams' can be dropped to the grid. If a non-null 'overflow' is passed, and if the permutation counter cannot store all permutations, return TRUE in 'overflow'
-uint64_t getSequencePermutations(sequence_params *sequenceParams, int *overflow)
+// Calculate and return the total number of permutations at which the sequence in 'sequenceParams' can be dropped to the grid
+permutation_count getSequencePermutations(sequence_params *sequenceParams)
 {
-    uint64_t newSequencePermutations = sequenceParams->Size == 0 ? 0 : 1; // Stores permutations for entire sequence
-    uint64_t oldSequencePermutations = newSequencePermutations; // Used to check overflows
-    
-    int piecePermutations = 0; // Stores permutations for current piece
+    permutation_count sequencePermutations = sequenceParams->Size == 0 ? 0 : 1; // Stores permutations for entire sequence
+    int piecePermutations; // Stores permutations for current piece
     int pieceRotations;
 
     for (int piece = 0; piece < sequenceParams->Size; piece++)
     {
         pieceRotations = sequenceParams->AllowRotation ? getRotations(sequenceParams->Sequence[piece]) : 1;
+        piecePermutations = 0;
 
         for (int rotation = 0; rotation < pieceRotations; rotation++)
-            piecePermutations += GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], rotation)->Width;     
+            piecePermutations += sequenceParams->GridWidth + 1 - getTetromino(sequenceParams->Sequence[piece], rotation)->Width;     
 
-        newSequencePermutations *= piecePermutations;
-
-        if (newSequencePermutations / piecePermutations != oldSequencePermutations && overflow != NULL)
-        {
-            *overflow = TRUE;            
-            printf("OVERFLOW DETECTED:\nNumber of permutations do not fit inside 64-bit uint\nTry a shorter sequence, or a sequence containing tetrominos with less permutations e.g. O or I\n\n");
-            break;
-        }         
-
-        else 
-        {
-            oldSequencePermutations = newSequencePermutations;        
-            piecePermutations = 0;        
-        }; 
+        sequencePermutations *= piecePermutations;
     }       
 
-    return newSequencePermutations;
+    return sequencePermutations;
 }
 
-// Calculate the number of permutations which an increment in each piece's column counter represents
-void getColumnCounterPermutations(sequence_params *sequenceParams)
+// Calculate the number of permutations below a node reached by dropping each piece, i.e. which share the placements of all pieces up to and including it
+void getSubtreePermutations(sequence_params *sequenceParams)
 {        
-    char previousPiece;
-    int previousPieceRotations;
-
-    sequenceParams->ColumnCounterPermutations[sequenceParams->Size - 1] = 1;
+    if (sequenceParams->Size == 0) return;
+    sequenceParams->SubtreePermutations[sequenceParams->Size - 1] = 1;
 
     for (int piece = sequenceParams->Size - 2; piece >= 0; piece--)
-    {
-        sequenceParams->ColumnCounterPermutations[piece] = 0;
-        previousPiece = sequenceParams->Sequence[piece + 1];
-        previousPieceRotations = sequenceParams->AllowRotation ? getRotations(sequenceParams->Sequence[piece + 1]) : 1;
-             
-        for (int rotation = 0; rotation < previousPieceRotations; rotation++) 
-            sequenceParams->ColumnCounterPermutations[piece] += GRID_WIDTH + 1 - getTetromino(previousPiece, rotation)->Width;
-
-        sequenceParams->ColumnCounterPermutations[piece] *= sequenceParams->ColumnCounterPermutations[piece + 1];
-    }
+        sequenceParams->SubtreePermutations[piece] = sequenceParams->SubtreePermutations[piece + 1] * getPiecePlacementCount(&sequenceParams->PlacementTable, piece + 1);
 }
 
-// Update the counters of 'solver' to the next permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the last permutation
-int getNextPermutation(solver *solver, sequence_params *sequenceParams)
+// Build the placement table of the sequence in 'sequenceParams' with the placements of its greedy solution tried first, or of the rest of the previous window's solution if it stacks lower, storing that solution in 'greedyColumns' and 'greedyRotations'. Return its stack height
+int buildSeededPlacementTable(sequence_params *sequenceParams, int greedyColumns[MAX_SEQUENCE_SIZE], int greedyRotations[MAX_SEQUENCE_SIZE])
 {
-    for (int piece = sequenceParams->Size-1; piece >= 0; piece--)
+    sequence_root *root = &sequenceParams->Root;
+    int allowMirror = root->Streamed == TRUE ? FALSE : TRUE;
+    int greedyStackHeight;
+    int plannedColumns[MAX_SEQUENCE_SIZE] = {0};
+    int plannedRotations[MAX_SEQUENCE_SIZE] = {0};
+    int plannedStackHeight;
+
+    // The greedy solution seeds the incumbent so that pruning starts from a tight bound, and its placements are tried first
+    buildPlacementTable(&sequenceParams->PlacementTable, sequenceParams->Sequence, sequenceParams->Size, sequenceParams->AllowRotation, sequenceParams->GridWidth, allowMirror, NULL, NULL);
+    greedyStackHeight = getGreedyPermutation(&sequenceParams->PlacementTable, sequenceParams->Size, root->Skyline, 0, greedyColumns, greedyRotations);
+
+    // The rest of the previous window's solution usually stacks lower than the greedy solution, once the pieces it didn't hold are added greedily
+    if (root->PlannedPieces > 0)
     {
-        solver->ColumnCounters[piece]++;
-        
-        if (solver->ColumnCounters[piece] == solver->ColumnCounts[piece]) // Tried all columns in piece's current rotation, change to next rotation
+        memcpy(plannedColumns, root->PlannedColumns, sizeof(plannedColumns));
+        memcpy(plannedRotations, root->PlannedRotations, sizeof(plannedRotations));
+        plannedStackHeight = getGreedyPermutation(&sequenceParams->PlacementTable, sequenceParams->Size, root->Skyline, root->PlannedPieces, plannedColumns, plannedRotations);
+
+        if (plannedStackHeight < greedyStackHeight)
         {
-            solver->ColumnCounters[piece] = 0;
-            solver->RotationCounters[piece]++;
-                        
-            if (solver->RotationCounters[piece] == solver->RotationCounts[piece]) // Tried all rotations for piece, reset to first permutation of the piece
-            {
-                solver->RotationCounters[piece] = 0;
-                solver->ColumnCounts[piece] = GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], 0)->Width;                        
-            }            
-
-            else
-            {
-                solver->ColumnCounts[piece] = GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], solver->RotationCounters[piece])->Width;                        
-                return piece;
-            } 
+            greedyStackHeight = plannedStackHeight;
+            memcpy(greedyColumns, plannedColumns, sizeof(plannedColumns));
+            memcpy(greedyRotations, plannedRotations, sizeof(plannedRotations));
         }
+    }
 
-        // Don't change pieces earlier in the sequence
-        else return piece;
-    }   
+    buildPlacementTable(&sequenceParams->PlacementTable, sequenceParams->Sequence, sequenceParams->Size, sequenceParams->AllowRotation, sequenceParams->GridWidth, allowMirror, greedyColumns, greedyRotations);
 
-    return FALSE; 
+    return greedyStackHeight;
 }
 
-// In 'solver', update the column counter of the tetromino at index 'pieceIndex' to the next permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the permutation before the increment
-int incrementColumnCounter(solver *solver, sequence_params *sequenceParams, int pieceIndex)
+// Prepare the solvers for solving the sequence in 'sequenceParams' as set in 'solverSettings' and 'searchControl' (may be NULL), sharing 'incumbent', 'workQueue' and 'transpositionTable' between them
+void initialiseSolvers(solver solvers[], solver_settings *solverSettings, search_control *searchControl, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable, sequence_params *sequenceParams)
 {
-     for (int piece = pieceIndex; piece >= 0; piece--)
-    {
-        solver->ColumnCounters[piece]++;
+    permutation_count permutations = getSequencePermutations(sequenceParams);
+    sequence_root *root = &sequenceParams->Root;
+    int greedyColumns[MAX_SEQUENCE_SIZE] = {0};
+    int greedyRotations[MAX_SEQUENCE_SIZE] = {0};
+    int greedyStackHeight = buildSeededPlacementTable(sequenceParams, greedyColumns, greedyRotations);
 
-        // Tried all columns using piece's current rotation
-        if (solver->ColumnCounters[piece] == solver->ColumnCounts[piece])
-        {
-            solver->ColumnCounters[piece] = 0;
-            solver->RotationCounters[piece]++;
-            
-            // Tried all rotations for piece
-            if (solver->RotationCounters[piece] == solver->RotationCounts[piece]) 
-            {
-                solver->RotationCounters[piece] = 0;
-                solver->ColumnCounts[piece] = GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], 0)->Width;                        
-            }            
-
-            // Try next rotation for piece
-            else
-            {
-                solver->ColumnCounts[piece] = GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], solver->RotationCounters[piece])->Width;                        
-                return piece;
-            } 
-        }
+    incumbent->MinStackHeight = greedyStackHeight;
 
-        // Don't change other pieces
-        else return piece;
-    }    
+    getSubtreePermutations(sequenceParams);
+    initialiseWorkQueue(workQueue, sequenceParams, solverSettings->NumberOfSolvers);
 
-    return FALSE;
-}
+    // The bounds stored while solving the previous window of a stream are kept, as they still hold
+    if (root->Streamed == FALSE) clearTranspositionTable(transpositionTable);
 
-// Update the counters of 'solver' to the next 'n'th permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the permutation before calling this function
-int getNextNthPermutation(solver *solver, sequence_params *sequenceParams, uint64_t n)
-{
-    uint64_t permutationsUpdated = 0;
-    int lastChangedPiece;
+    // Solvers are given their parts of the search tree by 'workQueue' as they become idle
+    for (int solver = 0; solver < solverSettings->NumberOfSolvers; solver++)
+    {        
+        memset(&solvers[solver], 0, sizeof(solvers[solver]));
 
-    for (int piece = 0; piece < sequenceParams->Size; piece++)
-    {
-        while (permutationsUpdated + sequenceParams->ColumnCounterPermutations[piece] <= n)
-        {
-            lastChangedPiece = incrementColumnCounter(solver, sequenceParams, piece);                
-            permutationsUpdated += sequenceParams->ColumnCounterPermutations[piece];                    
-        }
+        solvers[solver].SolverID = solver;
+        solvers[solver].MinStackHeight = GRID_HEIGHT;
+        solvers[solver].Incumbent = incumbent;
+        solvers[solver].WorkQueue = workQueue;
+        solvers[solver].TranspositionTable = transpositionTable;
+        solvers[solver].SearchControl = searchControl;
+        solvers[solver].NodesUntilLimitCheck = LIMIT_CHECK_INTERVAL;
+        solvers[solver].Permutations = permutations;
+        solvers[solver].ProgressDisplayInterval = permutations / PROGRESS_DISPLAY_STEPS > PROGRESS_DISPLAY_INTERVAL ? permutations / PROGRESS_DISPLAY_STEPS : PROGRESS_DISPLAY_INTERVAL;
+        solvers[solver].ShowProgress = solverSettings->ShowProgress;
     }
 
-    return lastChangedPiece;
+    // The greedy solution is held by the first solver, and is the solution unless a solver finds a lower stack
+    solvers[0].MinStackHeight = greedyStackHeight;
+    memcpy(solvers[0].BestPieceColumns, greedyColumns, sizeof(greedyColumns));
+    memcpy(solvers[0].BestPieceRotations, greedyRotations, sizeof(greedyRotations));
+
+    if (searchControl != NULL) searchControl->SpentNodes = 0;
+    if (searchControl != NULL && searchControl->Checkpoint != NULL) initialiseCheckpoint(solvers, searchControl->Checkpoint, incumbent, workQueue, sequenceParams);
 }
 
-// Set 'solver' to the first permutation of the sequence in 'sequenceParams'
-void setToFirstPermutation(solver *solver, sequence_params *sequenceParams)
+// Prepare the solvers in 'solvers', sharing 'incumbent' and 'workQueue', to checkpoint their search of the sequence in 'sequenceParams' to 'checkpoint', resuming the work left in it if it was read from a checkpoint file
+void initialiseCheckpoint(solver solvers[], search_checkpoint *checkpoint, incumbent *incumbent, work_queue *workQueue, sequence_params *sequenceParams)
 {
-    for (int piece = 0; piece < sequenceParams->Size; piece++)
-    {
-        solver->ColumnCounts[piece] = GRID_WIDTH - getTetromino(sequenceParams->Sequence[piece], ROTATION_0)->Width + 1;
+    uint64_t placementTableHash = getPlacementTableHash(sequenceParams);
 
-        if (sequenceParams->AllowRotation) solver->RotationCounts[piece] = getRotations(sequenceParams->Sequence[piece]);
-        else solver->RotationCounts[piece] = 1;
-    }
-}
+    // Placement indices only stand for the same placements in a placement table built the same way, otherwise the search starts over
+    if (checkpoint->Resumed == TRUE && (checkpoint->PlacementTableHash != placementTableHash || \
+        resumeWorkQueue(workQueue, sequenceParams, checkpoint->PrefixLength, checkpoint->NextPrefix, checkpoint->ResumedItems, checkpoint->ResumedItemCount) == FALSE))
+        checkpoint->Resumed = FALSE;
 
-// Set each solver's starting permutation and the number of permutations assigned to it for solving the sequence in 'sequenceParams'. Return OVERFLOW_DETECTED if the permutation counter cannot store all permutations
-int initialiseSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams)
-{
-    solver mainSolver = {{ 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, 0, 0, GRID_HEIGHT, 0, 0};    
-    uint64_t solverPermutations;
-    uint64_t remainingPermutations;
-    int overflow = FALSE;
-
-    remainingPermutations = getSequencePermutations(sequenceParams, &overflow);
-    if (overflow == TRUE) return OVERFLOW_DETECTED;
-    
-    getColumnCounterPermutations(sequenceParams);
-    setToFirstPermutation(&mainSolver, sequenceParams);
-
-    for (int solver = 0; solver < NUMBER_OF_SOLVERS; solver++)
-    {        
-        solverPermutations = remainingPermutations / (NUMBER_OF_SOLVERS - solver); 
-
-        if (solverPermutations == 0) solvers[solver].Permutations = 0;            
-        else 
-        {            
-            memcpy(&solvers[solver], &mainSolver, sizeof(mainSolver)); // Set starting permutation of solver
-            getNextNthPermutation(&mainSolver, sequenceParams, solverPermutations);              
-            solvers[solver].Permutations = solverPermutations;
-            remainingPermutations -= solvers[solver].Permutations;                                    
-        }
-        
-        solvers[solver].SolverID = solver;
+    checkpoint->PlacementTableHash = placementTableHash;
+    checkpoint->NextCheckpointTime = getWallClockTime() + checkpoint->Interval;
+
+    // The lowest stack recorded is a solution of the sequence whichever order placements are tried in, so it is kept even if the search starts over
+    if (checkpoint->BestStackHeight < incumbent->MinStackHeight)
+    {
+        incumbent->MinStackHeight = checkpoint->BestStackHeight;
+        solvers[0].MinStackHeight = checkpoint->BestStackHeight;
+        memcpy(solvers[0].BestPieceColumns, checkpoint->BestPieceColumns, sizeof(checkpoint->BestPieceColumns));
+        memcpy(solvers[0].BestPieceRotations, checkpoint->BestPieceRotations, sizeof(checkpoint->BestPieceRotations));
     }
 
-    return TRUE;    
+    // The permutations not left in the queue were tried or pruned before the checkpoint was written
+    if (checkpoint->Resumed == TRUE) solvers[0].TriedPermutations = solvers[0].Permutations - getQueuedPermutations(workQueue, sequenceParams);
 }
 
-// Return the y coordinate at which tetromino 'tet' will land when dropped into column 'droppedColumn', given height of the grid's columns in 'columnHeights'
-int getLandingHeight(tetromino *tet, int droppedColumn, int columnHeights[GRID_WIDTH])
+// Return the y coordinate at which tetromino 'tet' will land when dropped into column 'droppedColumn', given the grid state in 'gridSkyline'
+int getLandingHeight(tetromino *tet, int droppedColumn, skyline gridSkyline)
 {
     int landingHeight = 0; // The y coordinate at which the bottom row of the tetromino will land
+    skyline tetSkyline = shiftSkylineRight(gridSkyline, 8 * droppedColumn); // The grid state under the tetromino, starting from its leftmost column
 
     for (int tetRow = 3; tetRow > 3-tet->Height; tetRow--) // Start scanning from the bottom row of the tetromino
     {
         for (int tetCol = 0; tetCol < tet->Width; tetCol++)
         {
             // If the cell at which the tetromino would land into is occupied, move the tetromino above that cell
-            if (tet->Pattern[tetRow][tetCol] != '_' && (columnHeights[droppedColumn + tetCol] + (tetRow - 3)) > landingHeight)
-                landingHeight = columnHeights[droppedColumn + tetCol] + (tetRow - 3);
+            if (tet->Pattern[tetRow][tetCol] != '_' && (getColumnHeight(tetSkyline, tetCol) + (tetRow - 3)) > landingHeight)
+                landingHeight = getColumnHeight(tetSkyline, tetCol) + (tetRow - 3);
         }
     }
 
     return landingHeight;
 }
 
-// Drop tetromino 'tet' into column 'droppedColumn', and update the heights of the grid's columns in 'columnHeights'.
-void dropTetromino(tetromino *tet, int droppedColumn, int columnHeights[GRID_WIDTH])
+// Return the height of the tetromino stack on the grid, given the grid state in 'gridSkyline'
+int getStackHeight(skyline gridSkyline)
+{    
+    return getSkylineHeight(gridSkyline);
+}
+
+// If 'stackHeight' is lower than the overall best, lower the incumbent shared by 'solver' to it and save the permutation on the path of 'solver' as its best permutation. Return TRUE if the permutation was saved, FALSE otherwise
+int saveIfBestPermutation(solver *solver, sequence_params *sequenceParams, int stackHeight)
 {
-    int landingHeight = getLandingHeight(tet, droppedColumn, columnHeights);    
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    placement *piecePlacement;
+
+    // Another solver may have found an equal or better permutation since 'stackHeight' was checked against the incumbent
+    if (atomicLowerInt(&solver->Incumbent->MinStackHeight, stackHeight) == FALSE) return FALSE;
 
-    for (int tetCol = 0; tetCol < tet->Width; tetCol++)
-        columnHeights[droppedColumn + tetCol] = landingHeight + tet->ColumnHeights[tetCol];
+    solver->MinStackHeight = stackHeight;
+    solver->Counters.Improvements++;
+    if (solver->SearchControl != NULL && solver->SearchControl->OnImprovedSolution != NULL) solver->SearchControl->OnImprovedSolution(solver->SearchControl->UserData, stackHeight);
+
+    // The path holds placements in the order they are tried, save the columns and rotations they stand for
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        piecePlacement = &placementTable->Placements[solver->PathPlacements[piece]];
+        solver->BestPieceColumns[piece] = piecePlacement->Column;
+        solver->BestPieceRotations[piece] = piecePlacement->Rotation;
+    }
+
+    return TRUE;
 }
 
-// Return the height of the tetromino stack on the grid, given the height of the grid's columns in 'columnHeights' 
-int getStackHeight(int columnHeights[GRID_WIDTH])
-{    
-    int stackHeight = 0;
+// Lower the bound of the node at depth 'depth' on the path of 'solver' to 'bound', the bound of one of its children, if it is lower
+void boundNode(solver *solver, int depth, int bound)
+{
+    if (bound < solver->NodeBounds[depth]) solver->NodeBounds[depth] = bound;
+}
 
-    for (int col = 0; col < GRID_WIDTH; col++)
+// Split off the untried children of the shallowest node on the path of 'solver' which has any, and donate half of them to an idle solver, if any are waiting in its work queue
+void splitWorkItem(solver *solver, sequence_params *sequenceParams)
+{
+    work_item donatedItem;
+    int remainingChildren;
+
+    // The shallowest node holds the largest subtrees. The children of the node before the last piece are tried at once, so it is never split
+    for (int depth = solver->RootDepth; depth <= solver->Depth && depth < sequenceParams->Size - 1; depth++)
+    {
+        remainingChildren = solver->EndPlacements[depth] - solver->NextPlacements[depth];
+        if (remainingChildren == 0) continue;
+
+        donatedItem.Depth = depth;
+        for (int piece = 0; piece < depth; piece++) donatedItem.Placements[piece] = (unsigned short) solver->PathPlacements[piece];
+        donatedItem.FirstChild = solver->NextPlacements[depth] + remainingChildren / 2;
+        donatedItem.EndChild = solver->EndPlacements[depth];
+
+        if (donateWorkItem(solver->WorkQueue, &donatedItem) == TRUE)
+        {
+            solver->EndPlacements[depth] = donatedItem.FirstChild;
+
+            // The donated children are searched by another solver, so the node and its ancestors no longer hold all of their children
+            for (int ancestor = solver->RootDepth; ancestor <= depth; ancestor++) solver->WholeNodes[ancestor] = FALSE;
+        }
+
+        return;
+    }
+}
+
+// Record the work left in the work item of 'solver' in the checkpoint being taken, starting one if the next checkpoint is due. Pass FALSE in 'hasWork' once the solver has finished its work item, in which case it is no longer busy. The solver recording its work last writes the checkpoint
+void checkpointSearch(solver *solver, sequence_params *sequenceParams, int hasWork)
+{
+    work_queue *workQueue = solver->WorkQueue;
+    search_checkpoint *checkpoint = solver->SearchControl->Checkpoint;
+    work_item leftItem;
+    int recordedWork = FALSE;
+
+    // A busy solver only takes the lock once a checkpoint is due, or is being taken and its work isn't recorded yet
+    if (hasWork == TRUE && (ATOMIC_LOAD_INT(&workQueue->Held) == TRUE ? solver->CheckpointGeneration == ATOMIC_LOAD_INT(&checkpoint->Generation) : \
+                            getWallClockTime() < checkpoint->NextCheckpointTime)) return;
+
+    acquireLock(&workQueue->Lock);
+
+    if (workQueue->Held == FALSE && workQueue->Stopped == FALSE && getWallClockTime() >= checkpoint->NextCheckpointTime)
     {
-        if (columnHeights[col] > stackHeight)
-            stackHeight = columnHeights[col];
+        holdWorkQueue(workQueue);
+        beginCheckpoint(checkpoint, workQueue);
     }
 
-    return stackHeight;
+    if (workQueue->Held == TRUE && solver->CheckpointGeneration != checkpoint->Generation)
+    {
+        // The untried children of each node on the path are left. The subtree of the placement being tried at each node is left in the nodes below it
+        for (int depth = solver->RootDepth; hasWork == TRUE && depth <= solver->Depth; depth++)
+        {
+            if (solver->NextPlacements[depth] == solver->EndPlacements[depth]) continue;
+
+            leftItem.Depth = depth;
+            for (int piece = 0; piece < depth; piece++) leftItem.Placements[piece] = (unsigned short) solver->PathPlacements[piece];
+            leftItem.FirstChild = solver->NextPlacements[depth];
+            leftItem.EndChild = solver->EndPlacements[depth];
+            recordCheckpointItem(checkpoint, &leftItem);
+        }
+
+        solver->CheckpointGeneration = checkpoint->Generation;
+        checkpoint->PendingSolvers--;
+        recordedWork = TRUE;
+    }
+
+    // The checkpoint is read while it is written, after the last busy solver has recorded its work
+    if (workQueue->Held == FALSE || recordedWork == TRUE)
+        recordCheckpointSolution(checkpoint, sequenceParams->Size, solver->MinStackHeight, solver->BestPieceColumns, solver->BestPieceRotations);
+
+    if (hasWork == FALSE && --workQueue->BusySolvers == 0) signalCondition(&workQueue->WorkChanged);
+
+    // The search goes on while the checkpoint is written, only the work in the queue is held
+    if (recordedWork == TRUE && checkpoint->PendingSolvers == 0)
+    {
+        releaseLock(&workQueue->Lock);
+
+        // A stopped search abandons work items without recording them
+        if (ATOMIC_LOAD_INT(&workQueue->Stopped) == FALSE && writeCheckpointFile(checkpoint) == FALSE && solver->ShowProgress == TRUE)
+            printf("Could not write checkpoint '%s'!\n", checkpoint->File);
+
+        acquireLock(&workQueue->Lock);
+        releaseWorkQueue(workQueue);
+        checkpoint->NextCheckpointTime = getWallClockTime() + checkpoint->Interval;
+    }
+
+    releaseLock(&workQueue->Lock);
 }
 
-// Skip the current permutation in 'solver' and all future permutations which are identical up to piece 'lastDeterminedPiece', as they were determined to be no better than the current best
-void getNextUndeterminedPermutation(solver *solver, sequence_params *sequenceParams, int lastDeterminedPiece)
+// Return TRUE if the search of 'solver' has been stopped, or should stop as it has reached its deadline or node budget or been cancelled, in which case stop it for all solvers and mark the solver's work item as abandoned. Otherwise record the work of 'solver' in the checkpoint if one is being taken, and return FALSE
+int pollSearchControl(solver *solver, sequence_params *sequenceParams)
 {
-    uint64_t skippedPermutations;
-    
-    // Increment the last determined piece
-    skippedPermutations = sequenceParams->ColumnCounterPermutations[lastDeterminedPiece];
+    search_control *searchControl = solver->SearchControl;
+
+    solver->NodesUntilLimitCheck = LIMIT_CHECK_INTERVAL;
 
-    // Reset the columns and rotations of the following pieces
-    for (int piece = lastDeterminedPiece + 1; piece < sequenceParams->Size; piece++)
+    if (ATOMIC_LOAD_INT(&solver->WorkQueue->Stopped) == TRUE)
     {
-        skippedPermutations -= sequenceParams->ColumnCounterPermutations[piece] * solver->ColumnCounters[piece];
+        solver->AbandonedItem = TRUE;
+        return TRUE;
+    }
+
+    if (searchControl->Checkpoint != NULL) checkpointSearch(solver, sequenceParams, TRUE);
 
-        for (int rotation = 0; rotation < solver->RotationCounters[piece]; rotation++)
-            skippedPermutations -= sequenceParams->ColumnCounterPermutations[piece] * (GRID_WIDTH + 1 - getTetromino(sequenceParams->Sequence[piece], rotation)->Width);                    
+    // Each solver adds the nodes it entered since its last check, so the budget is spent to within LIMIT_CHECK_INTERVAL nodes per solver
+    if ((searchControl->Deadline != 0 && getWallClockTime() >= searchControl->Deadline) || \
+        (searchControl->NodeBudget != 0 && ATOMIC_ADD_UINT64(&searchControl->SpentNodes, LIMIT_CHECK_INTERVAL) >= searchControl->NodeBudget) || \
+        (searchControl->ShouldCancel != NULL && searchControl->ShouldCancel(searchControl->UserData) == TRUE))
+    {
+        stopWorkQueue(solver->WorkQueue);
+        solver->AbandonedItem = TRUE;
+        return TRUE;
     }
-    
-    solver->LastChangedPiece = getNextNthPermutation(solver, sequenceParams, skippedPermutations);
-    solver->CurrentPermutation += skippedPermutations;
+
+    return FALSE;
+}
+
+// Define a search kernel for each grid width, e.g. searchWorkItemWidth6 for grids 6 columns wide
+#define KERNEL_NAME(name, width) name##Width##width
+#define KERNEL_WIDTH_NAME(name, width) KERNEL_NAME(name, width)
+#define KERNEL_FUNCTION(name) KERNEL_WIDTH_NAME(name, KERNEL_WIDTH)
+
+#define KERNEL_WIDTH 4
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 5
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 6
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 7
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+
+#define KERNEL_WIDTH 8
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 9
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 10
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 11
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+#define KERNEL_WIDTH 12
+#include "search_kernel.h"
+#undef KERNEL_WIDTH
+
+// Stores the search kernel for each grid width from MIN_GRID_WIDTH to MAX_GRID_WIDTH
+void (*searchKernels[MAX_GRID_WIDTH - MIN_GRID_WIDTH + 1])(solver *solver, sequence_params *sequenceParams, work_item *item) =
+{
+    searchWorkItemWidth4, searchWorkItemWidth5, searchWorkItemWidth6, searchWorkItemWidth7,
+    searchWorkItemWidth8, searchWorkItemWidth9, searchWorkItemWidth10, searchWorkItemWidth11, searchWorkItemWidth12
+};
+
+// Search the subtrees in the work item 'item' depth first, pruning each subtree which cannot hold a better permutation than the current best. The search kernel for the width of the grid is chosen once per work item, rather than at each node
+void searchWorkItem(solver *solver, sequence_params *sequenceParams, work_item *item)
+{
+    searchKernels[sequenceParams->GridWidth - MIN_GRID_WIDTH](solver, sequenceParams, item);
 }
 
-// Stack the sequence in the current permutation of 'solver' and return the height of the resulting stack.
-int tryPermutation(solver *solver, sequence_params *sequenceParams)
+// Search the work items handed out by the work queue of 'solver' until the whole search tree of the sequence in 'sequenceParams' has been searched
+void searchWorkItems(solver *solver, sequence_params *sequenceParams)
 {
-    tetromino *tet;
-    int stackHeight = 0;    
-
-    // Reload an intermediate grid state if the current permutation has an identical beginning with the previous one
-    if (solver->LastChangedPiece > 0) memcpy(solver->ColumnHeights, solver->SavedColumnHeights[solver->LastChangedPiece-1], sizeof(int)*GRID_WIDTH);                
-    // Clear grid state
-    else memset(solver->ColumnHeights, 0, sizeof(int)*GRID_WIDTH);        
-    
-    for (int piece = solver->LastChangedPiece; piece < sequenceParams->Size-1; piece++)
+    work_item item;
+    int finishedItem = FALSE;
+    int checkpointing = solver->SearchControl != NULL && solver->SearchControl->Checkpoint != NULL ? TRUE : FALSE;
+    double waitStartTime = getWallClockTime();
+
+    time(&solver->StartTime);        
+    solver->ProgressDisplayThreshold = solver->ShowProgress == TRUE ? solver->ProgressDisplayInterval : MAX_PERMUTATION_COUNT;
+
+    while (getWorkItem(solver->WorkQueue, sequenceParams, finishedItem, &item) == TRUE)
     {
-        tet = getTetromino(sequenceParams->Sequence[piece], solver->RotationCounters[piece]);            
-        dropTetromino(tet, solver->ColumnCounters[piece], solver->ColumnHeights);                    
+        solver->Counters.IdleTime += getWallClockTime() - waitStartTime;
+        solver->Counters.WorkItems++;
 
-        if (getStackHeight(solver->ColumnHeights) < solver->MinStackHeight) // Save intermediate grid state as it can be used again
-            memcpy(solver->SavedColumnHeights[piece], solver->ColumnHeights, sizeof(int)*GRID_WIDTH);
+        searchWorkItem(solver, sequenceParams, &item);
+        finishedItem = TRUE;
 
-        else // Skip current permutation (and all future permutations with an identical beginning) if it is determined to be no better than the current best permutation
+        // A solver checkpointing its search stops being busy while it records that its work item is finished, so that no checkpoint waits for it
+        if (checkpointing == TRUE)
         {
-            getNextUndeterminedPermutation(solver, sequenceParams, piece);
-            return SKIPPED_PERMUTATION;
-        }        
+            checkpointSearch(solver, sequenceParams, FALSE);
+            finishedItem = FALSE;
+        }
+
+        waitStartTime = getWallClockTime();
     }
-    tet = getTetromino(sequenceParams->Sequence[sequenceParams->Size-1], solver->RotationCounters[sequenceParams->Size-1]);            
-    dropTetromino(tet, solver->ColumnCounters[sequenceParams->Size-1], solver->ColumnHeights);            
 
-    return getStackHeight(solver->ColumnHeights);
+    // Waiting for the last work item to be searched by another solver is also idle time
+    solver->Counters.IdleTime += getWallClockTime() - waitStartTime;
+
+    if (solver->ShowProgress == TRUE) printSolverProgress(solver);
+}
+
+// Return the number of permutations tried or pruned by 'solver' so far
+permutation_count getTriedPermutations(solver *solver)
+{
+    return solver->TriedPermutations;
 }
 
 // Print the time elapsed and number/percentage of permutations tried for solver 'solver' 
-void printSolverProgress(solver *solver, time_t startTime)
+void printSolverProgress(solver *solver)
 {
     time_t currentTime;
+    char triedPermutations[MAX_PERMUTATION_COUNT_LENGTH];
+    char permutations[MAX_PERMUTATION_COUNT_LENGTH];
     time(&currentTime);
 
-    printf("Solver: %d Permutations tried: %llu / %llu (%.2f%%) %ds\n", \
-        solver->SolverID, solver->CurrentPermutation, solver->Permutations, \
-        100.0 * solver->CurrentPermutation / solver->Permutations, \
-        (long) (currentTime - startTime));  
+    printf("Solver: %d Permutations tried: %s / %s (%.2f%%) %lds\n", \
+        solver->SolverID, formatPermutationCount(getTriedPermutations(solver), triedPermutations), formatPermutationCount(solver->Permutations, permutations), \
+        100.0 * (double) getTriedPermutations(solver) / (double) solver->Permutations, \
+        (long) (currentTime - solver->StartTime));  
 }
 
-// Return the solver in 'solvers' which found the solution resulting in the lowest stack height 
-solver * getBestSolver(solver solvers[NUMBER_OF_SOLVERS])
+// Return the solver out of the 'numberOfSolvers' solvers in 'solvers' which found the solution resulting in the lowest stack height 
+solver * getBestSolver(solver solvers[], int numberOfSolvers)
 {
     int overallMinStackHeight = GRID_HEIGHT;
     solver *bestSolver = &solvers[0];
 
-    for (int solver = 0; solver < NUMBER_OF_SOLVERS; solver++)
+    for (int solver = 0; solver < numberOfSolvers; solver++)
     {
         if (solvers[solver].MinStackHeight < overallMinStackHeight)
         {   
@@ -317,46 +440,252 @@ solver * getBestSolver(solver solvers[NUMBER_OF_SOLVERS])
     return bestSolver;
 }
 
-// Print the stack of tetrominos produced when dropped to the best columns and in the best rotations
-void printSolution(solver *solver, sequence_params *sequenceParams, time_t startTime)
+// Print the stack of tetrominos produced when dropped to the best columns and in the best rotations, and 'lowerBound', the lowest stack height the search didn't rule out, if the best permutation isn't proven to be the lowest
+void printSolution(solver *solver, sequence_params *sequenceParams, time_t startTime, int lowerBound)
 {   
-    char grid[GRID_HEIGHT][GRID_WIDTH];
-    int gridColumnHeights[GRID_WIDTH];
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    skyline gridSkyline = EMPTY_SKYLINE;
     time_t endTime;
+    char permutations[MAX_PERMUTATION_COUNT_LENGTH];
 
     time(&endTime);    
     memset(grid, '_', sizeof(grid));
-    memset(gridColumnHeights, 0, sizeof(gridColumnHeights));    
 
     // Drop the sequence into the grid, using the best permutation
     for (int piece = 0; piece < sequenceParams->Size; piece++)
         dropTetrominoToGrid(getTetromino(sequenceParams->Sequence[piece], solver->BestPieceRotations[piece]), \
-                            solver->BestPieceColumns[piece], grid, gridColumnHeights);
-    printGrid(grid);    
+                            solver->BestPieceColumns[piece], grid, &gridSkyline);
+    printGrid(grid, sequenceParams->GridWidth);    
 
     printf("Best permutation: ");
     for (int piece = 0; piece < sequenceParams->Size; piece++)
         printf("%c:%d(%d) ", sequenceParams->Sequence[piece], solver->BestPieceColumns[piece], solver->BestPieceRotations[piece]*90);
     printf("\n\n");
 
-    printf("Sequence: %.*s\nTried all %llu permutations!\nMinimum stack height: %d\nElapsed time: %lds\n\n", \
-        sequenceParams->Size, sequenceParams->Sequence, getSequencePermutations(sequenceParams, NULL), solver->MinStackHeight, (long)(endTime-startTime));
+    if (lowerBound < solver->MinStackHeight)
+        printf("Sequence: %.*s\nStopped before trying all %s permutations!\nLowest stack height found: %d\nNo permutation stacks lower than: %d\nElapsed time: %lds\n\n", \
+            sequenceParams->Size, sequenceParams->Sequence, formatPermutationCount(getSequencePermutations(sequenceParams), permutations), solver->MinStackHeight, lowerBound, (long)(endTime-startTime));
+    else
+        printf("Sequence: %.*s\nTried all %s permutations!\nMinimum stack height: %d\nElapsed time: %lds\n\n", \
+            sequenceParams->Size, sequenceParams->Sequence, formatPermutationCount(getSequencePermutations(sequenceParams), permutations), solver->MinStackHeight, (long)(endTime-startTime));
+}
+
+// Return a lower bound on the stack height of every permutation in the work item 'item' of the sequence in 'sequenceParams', from the grid state after dropping each of its children. Return NO_NODE_BOUND if it has no children
+int getWorkItemBound(sequence_params *sequenceParams, work_item *item)
+{
+    placement_table *placementTable = &sequenceParams->PlacementTable;
+    skyline gridSkyline = sequenceParams->Root.Skyline;
+    int childBound;
+    int itemBound = NO_NODE_BOUND;
+
+    // Wide skylines hold a grid of any width, and the bound is only worked out once the search has stopped
+    for (int piece = 0; piece < item->Depth; piece++) gridSkyline = dropPlacement(&placementTable->Placements[item->Placements[piece]], gridSkyline);
+
+    for (int child = item->FirstChild; child < item->EndChild; child++)
+    {
+        childBound = getStackHeightBound(placementTable, item->Depth + 1, dropPlacement(&placementTable->Placements[child], gridSkyline), sequenceParams->GridWidth);
+        if (childBound < itemBound) itemBound = childBound;
+    }
+
+    return itemBound;
+}
+
+// Return the lowest stack height which the search of the sequence in 'sequenceParams' by 'solvers', sharing 'workQueue', hasn't ruled out. This is the lowest stack found if the whole search tree was searched. 
+// Otherwise it is the lowest bound on the work left in the queue or abandoned by the solvers when the search was stopped, if that is lower, but never lower than the bound on the grid state the sequence is dropped onto
+int getSearchLowerBound(solver solvers[], int numberOfSolvers, work_queue *workQueue, sequence_params *sequenceParams)
+{
+    int lowerBound = ATOMIC_LOAD_INT(&solvers[0].Incumbent->MinStackHeight);
+    int rootBound = getStackHeightBound(&sequenceParams->PlacementTable, 0, sequenceParams->Root.Skyline, sequenceParams->GridWidth);
+    work_item item;
+    int itemBound;
+
+    // Every part of the search tree which was searched or pruned holds no permutation lower than the lowest stack found
+    if (workQueue->Stopped == FALSE) return lowerBound;
+
+    for (int resumedItem = 0; resumedItem < workQueue->ResumedItemCount && lowerBound > rootBound; resumedItem++)
+    {
+        itemBound = getWorkItemBound(sequenceParams, &workQueue->ResumedItems[resumedItem]);
+        if (itemBound < lowerBound) lowerBound = itemBound;
+    }
+
+    for (int donatedItem = 0; donatedItem < workQueue->DonatedItemCount && lowerBound > rootBound; donatedItem++)
+    {
+        itemBound = getWorkItemBound(sequenceParams, &workQueue->DonatedItems[donatedItem]);
+        if (itemBound < lowerBound) lowerBound = itemBound;
+    }
+
+    for (uint64_t prefix = workQueue->NextPrefix; prefix < workQueue->Prefixes && lowerBound > rootBound; prefix++)
+    {
+        getPrefixWorkItem(sequenceParams, workQueue->PrefixLength, prefix, &item);
+        itemBound = getWorkItemBound(sequenceParams, &item);
+        if (itemBound < lowerBound) lowerBound = itemBound;
+    }
+
+    // The untried children of each node on the path of a solver which abandoned its work item are left, as when its work is checkpointed
+    for (int solver = 0; solver < numberOfSolvers; solver++)
+    {
+        for (int depth = solvers[solver].RootDepth; solvers[solver].AbandonedItem == TRUE && depth <= solvers[solver].Depth && lowerBound > rootBound; depth++)
+        {
+            item.Depth = depth;
+            for (int piece = 0; piece < depth; piece++) item.Placements[piece] = (unsigned short) solvers[solver].PathPlacements[piece];
+            item.FirstChild = solvers[solver].NextPlacements[depth];
+            item.EndChild = solvers[solver].EndPlacements[depth];
+
+            itemBound = getWorkItemBound(sequenceParams, &item);
+            if (itemBound < lowerBound) lowerBound = itemBound;
+        }
+    }
+
+    return lowerBound > rootBound ? lowerBound : rootBound;
 }
 
-// Solve the tetromino sequence in 'sequenceParams' and display the solution
-void solveSequence(sequence_params *sequenceParams)
+// Search the whole search tree of the sequence in 'sequenceParams' with the solvers in 'solvers', run as set in 'solverSettings' and 'searchControl' (may be NULL) and sharing 'incumbent', 'workQueue' and 'transpositionTable' between them, until it is searched or the search is stopped. Return the solver holding the best permutation, and the lower bound on the lowest stack in 'lowerBound' (may be NULL)
+solver *searchSequence(solver solvers[], solver_settings *solverSettings, search_control *searchControl, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable, sequence_params *sequenceParams, int *lowerBound)
+{
+    int reporting = searchControl != NULL && searchControl->Telemetry != NULL ? TRUE : FALSE;
+
+    initialiseSolvers(solvers, solverSettings, searchControl, incumbent, workQueue, transpositionTable, sequenceParams);
+
+    if (reporting == TRUE) beginTelemetrySearch(searchControl->Telemetry, sequenceParams);
+    runSolvers(solvers, solverSettings, sequenceParams);
+    if (reporting == TRUE) endTelemetrySearch(searchControl->Telemetry);
+
+    if (lowerBound != NULL) *lowerBound = getSearchLowerBound(solvers, solverSettings->NumberOfSolvers, workQueue, sequenceParams);
+    destroyWorkQueue(workQueue);
+
+    return getBestSolver(solvers, solverSettings->NumberOfSolvers);
+}
+
+// Display the solution of the sequence in 'sequenceParams' stored in 'solutionCache', if it is cached. Return TRUE if it was displayed, FALSE otherwise
+int printCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, time_t startTime)
+{
+    solution_cache_entry cachedSolution;
+    solver cachedSolver;
+
+    if (lookUpCachedSolution(solutionCache, sequenceParams, sequenceParams->GridWidth, &cachedSolution) == FALSE) return FALSE;
+
+    cachedSolver.MinStackHeight = cachedSolution.StackHeight;
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        cachedSolver.BestPieceColumns[piece] = cachedSolution.PieceColumns[piece];
+        cachedSolver.BestPieceRotations[piece] = cachedSolution.PieceRotations[piece];
+    }
+
+    printSolution(&cachedSolver, sequenceParams, startTime, cachedSolver.MinStackHeight);
+    printf("Solution read from the solution cache\n\n");
+    return TRUE;
+}
+
+// Solve the tetromino sequence in 'sequenceParams' using the solvers set in 'solverSettings', and display the solution
+void solveSequence(sequence_params *sequenceParams, solver_settings *solverSettings)
 {    
-    solver solvers[NUMBER_OF_SOLVERS];
+    solver *solvers;
     solver *bestSolver;
+    incumbent incumbent;
+    work_queue workQueue;
+    transposition_table transpositionTable;
+    solution_cache solutionCache;
+    int cacheOpened = FALSE;
+    search_control searchControl = {0};
+    search_checkpoint checkpoint;
+    telemetry_reporter telemetryReporter;
+    int lowerBound;
 
     time_t startTime;
     time(&startTime);
 
-    printf("Sequence: %.*s\nSolving...\n\n", sequenceParams->Size, sequenceParams->Sequence);
+    if (solverSettings->CacheFile != NULL)
+    {
+        cacheOpened = openSolutionCache(&solutionCache, solverSettings->CacheFile);
+        if (cacheOpened == FALSE) printf("Could not open solution cache '%s'! Solving without it...\n\n", solverSettings->CacheFile);
+    }
+
+    // A cached solution is displayed without allocating the solvers
+    if (cacheOpened == TRUE && printCachedSolution(&solutionCache, sequenceParams, startTime) == TRUE)
+    {
+        closeSolutionCache(&solutionCache);
+        return;
+    }
+
+    solvers = malloc(sizeof(solver) * solverSettings->NumberOfSolvers);
+
+    if (solvers == NULL)
+    {
+        printf("Could not allocate %d solvers!\n\n", solverSettings->NumberOfSolvers);
+        if (cacheOpened == TRUE) closeSolutionCache(&solutionCache);
+        return;
+    }
 
-    if (initialiseSolvers(solvers, sequenceParams) == OVERFLOW_DETECTED) return;
-    runSolvers(solvers, sequenceParams);
+    if (createTranspositionTable(&transpositionTable, solverSettings->TranspositionTableMegabytes) == FALSE)
+    {
+        printf("Could not allocate a %dMB transposition table!\n\n", solverSettings->TranspositionTableMegabytes);
+        if (cacheOpened == TRUE) closeSolutionCache(&solutionCache);
+        free(solvers);
+        return;
+    }
 
-    bestSolver = getBestSolver(solvers);
-    printSolution(bestSolver, sequenceParams, startTime);
-}
\ No newline at end of file
+    if (solverSettings->CheckpointFile != NULL)
+    {
+        if (createSearchCheckpoint(&checkpoint, solverSettings, sequenceParams) == FALSE)
+        {
+            printf("Could not %s checkpoint '%s'!\n\n", solverSettings->ResumeCheckpoint == TRUE ? "resume from" : "create", solverSettings->CheckpointFile);
+            if (cacheOpened == TRUE) closeSolutionCache(&solutionCache);
+            destroyTranspositionTable(&transpositionTable);
+            free(solvers);
+            return;
+        }
+
+        searchControl.Checkpoint = &checkpoint;
+    }
+
+    if (solverSettings->TelemetryFile != NULL)
+    {
+        if (startTelemetryReporter(&telemetryReporter, solverSettings, solvers, &incumbent) == TRUE) searchControl.Telemetry = &telemetryReporter;
+        else printf("Could not start publishing telemetry to '%s'! Solving without it...\n\n", solverSettings->TelemetryFile);
+    }
+
+    // The time limit counts from the start of the search, after the solvers and transposition table are allocated
+    searchControl.Deadline = solverSettings->TimeLimit > 0 ? getWallClockTime() + solverSettings->TimeLimit / 1000.0 : 0;
+    searchControl.NodeBudget = solverSettings->NodeBudget;
+
+    printf("Sequence: %.*s\n%s...\n\n", sequenceParams->Size, sequenceParams->Sequence, solverSettings->ResumeCheckpoint == TRUE ? "Resuming" : "Solving");
+
+    bestSolver = searchSequence(solvers, solverSettings, searchControl.Checkpoint != NULL || searchControl.Telemetry != NULL || searchControl.Deadline != 0 || searchControl.NodeBudget != 0 ? &searchControl : NULL, \
+                                &incumbent, &workQueue, &transpositionTable, sequenceParams, &lowerBound);
+
+    printSolution(bestSolver, sequenceParams, startTime, lowerBound);
+    if (searchControl.Telemetry != NULL) stopTelemetryReporter(&telemetryReporter);
+
+    if (solverSettings->ResumeCheckpoint == TRUE && checkpoint.Resumed == FALSE)
+        printf("Checkpoint '%s' was written by a build which tries placements in another order, so the search started over\n\n", solverSettings->CheckpointFile);
+
+    // Once the whole search tree has been searched the checkpoint is no longer needed. A search stopped at its limit can still be resumed from it
+    if (searchControl.Checkpoint != NULL)
+    {
+        if (workQueue.Stopped == FALSE) remove(solverSettings->CheckpointFile);
+        destroySearchCheckpoint(&checkpoint);
+    }
+
+    // Solutions of stopped searches may not be the lowest stack, so they aren't cached
+    if (cacheOpened == TRUE && lowerBound == bestSolver->MinStackHeight)
+        storeCachedSolution(&solutionCache, sequenceParams, sequenceParams->GridWidth, bestSolver->MinStackHeight, bestSolver->BestPieceColumns, bestSolver->BestPieceRotations);
+
+    if (cacheOpened == TRUE) closeSolutionCache(&solutionCache);
+    destroyTranspositionTable(&transpositionTable);
+    free(solvers);
+}
+
+// Resume solving the tetromino sequence whose search was checkpointed to the checkpoint file set in 'solverSettings', and display the solution. Return TRUE if it was resumed, FALSE if the checkpoint file couldn't be read
+int resumeSequence(solver_settings *solverSettings)
+{
+    sequence_params sequenceParams;
+
+    if (readCheckpointSequence(solverSettings->CheckpointFile, &sequenceParams) == FALSE)
+    {
+        printf("Could not read checkpoint '%s'!\n", solverSettings->CheckpointFile);
+        return FALSE;
+    }
+
+    solveSequence(&sequenceParams, solverSettings);
+    return TRUE;
+}
@@ -3,108 +3,184 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
+#include <time.h>
 
 #include "grid.h"
+#include "skyline.h"
 #include "tetromino.h"
 #include "input_utils.h"
+#include "scheduler.h"
+#include "transposition_table.h"
+#include "solution_cache.h"
+#include "checkpoint.h"
+#include "permutation_count.h"
+#include "thread_utils.h"
 
-#define PROGRESS_DISPLAY_INTERVAL ((uint64_t) 1e12)
-#define OVERFLOW_DETECTED -1
-#define SKIPPED_PERMUTATION -1
+#define PROGRESS_DISPLAY_INTERVAL ((uint64_t) 1e12) // Minimum number of permutations a solver tries between printing its progress
+#define PROGRESS_DISPLAY_STEPS 1000 // Maximum number of times a solver prints its progress in a search
+#define NO_NODE_BOUND INT_MAX
+#define LIMIT_CHECK_INTERVAL 4096 // Number of nodes a solver enters between checks of whether its search should stop
 
-// Use multi-threaded implementation if on Windows or Linux OS
-#if defined _WIN32 || defined linux
-#define NUMBER_OF_SOLVERS 16
+typedef struct telemetry_reporter telemetry_reporter;
 
-#else
-#define NUMBER_OF_SOLVERS 1
-#endif
-
-typedef struct
+typedef struct // Stores the best solution found so far by any solver. Shared by all solvers so that each one prunes against the overall best
 {
-    // Stores the number of columns each piece can be dropped in, given its current rotation
-    int ColumnCounts[MAX_SEQUENCE_SIZE]; 
-    // Stores the number of ways each piece can be rotated
-    int RotationCounts[MAX_SEQUENCE_SIZE]; 
+    // Stores the lowest stack height found so far. Read by every solver when pruning, and only ever lowered through atomicLowerInt
+    volatile int MinStackHeight;
+} incumbent;
 
-    // Stores the current column/rotation being tried for each piece
-    int ColumnCounters[MAX_SEQUENCE_SIZE];
-    int RotationCounters[MAX_SEQUENCE_SIZE];
+typedef struct // Stores the limits on a search and the callbacks reporting on it, set by the caller of the solver library. Shared by all solvers
+{
+    double Deadline; // Wall clock time, as returned by getWallClockTime, at which the search stops. 0 if the search has no time limit
+    uint64_t NodeBudget; // Search tree nodes the solvers may enter between them before the search stops. 0 if the search has no node budget
+    volatile uint64_t SpentNodes; // Nodes entered by the solvers so far, added LIMIT_CHECK_INTERVAL at a time as each solver checks its limits. Reset as the solvers are initialised
+    int (*ShouldCancel)(void *userData); // Polled by the solvers as often as the deadline. The search stops once it returns TRUE. May be NULL
+    void (*OnImprovedSolution)(void *userData, int stackHeight); // Called by whichever solver lowers the lowest stack height found, possibly by several solver threads at once. May be NULL
+    void *UserData; // Passed to the callbacks
+    search_checkpoint *Checkpoint; // Written to its checkpoint file periodically while searching. May be NULL
+    telemetry_reporter *Telemetry; // Publishes snapshots of the counters of the solvers while searching. May be NULL
+} search_control;
+
+typedef struct // Stores the counters of the search of a solver. Only written by the solver's own thread, and read by the telemetry reporter without locks, so a snapshot may lag behind the search by a few nodes
+{
+    uint64_t Nodes; // Search tree nodes entered
+    uint64_t PrunedSubtrees[MAX_SEQUENCE_SIZE]; // Subtrees pruned below a node reached by dropping each piece, as they can't hold a better permutation than the current best
+    uint64_t DuplicateSubtrees; // Subtrees skipped as they stack to the same heights as a subtree tried before them
+    uint64_t TableHits; // Transposition table probes which found a stored bound
+    uint64_t Improvements; // Times the solver lowered the lowest stack height found by any solver
+    uint64_t WorkItems; // Work items received from the work queue
+    double IdleTime; // Seconds spent waiting for a work item
+} solver_counters;
 
-    // Stores the state of the grid i.e. height of each column
-    int ColumnHeights[GRID_WIDTH];
-    // Stores the states of the grid after each tetromino is dropped
-    int SavedColumnHeights[MAX_SEQUENCE_SIZE-1][GRID_WIDTH];
+typedef struct
+{
+    // Stores the search path as an explicit stack of nodes, where the node at depth 'd' is the grid state after dropping the first 'd' pieces
+    // Stores the grid state of each node on the path i.e. height of each column. Only the skylines of the type used by the search kernel for the grid width are used
+    narrow_skyline NarrowSkylines[MAX_SEQUENCE_SIZE+1];
+    skyline Skylines[MAX_SEQUENCE_SIZE+1];
+    // Stores the placement (index into the placement table) of the piece dropped at each node to reach the next node on the path
+    int PathPlacements[MAX_SEQUENCE_SIZE];
+    // Stores the range [NextPlacements, EndPlacements) of placements still to be tried at each node on the path
+    int NextPlacements[MAX_SEQUENCE_SIZE];
+    int EndPlacements[MAX_SEQUENCE_SIZE];
+    // Stores the depth of the deepest node on the path, and of the root of the work item being searched
+    int Depth;
+    int RootDepth;
+
+    // Stores a lower bound on the final stack height below each node on the path. Lowered as the node's children are tried or pruned
+    int NodeBounds[MAX_SEQUENCE_SIZE];
+    // Stores whether all children of each node on the path are tried or pruned by this solver. Only the bounds of such nodes are stored in the transposition table
+    int WholeNodes[MAX_SEQUENCE_SIZE];
 
     // Stores the best column/rotation of each sequence piece in the best permutation
     int BestPieceColumns[MAX_SEQUENCE_SIZE];
     int BestPieceRotations[MAX_SEQUENCE_SIZE];
 
-    // Stores the index of the earliest piece in the sequence which has a new column or rotation from the last permutation
-    int LastChangedPiece; 
-
     int SolverID;
+    // Stores the lowest stack height found by this solver. Only set when this solver also lowers the shared incumbent, so the solver holding the overall best permutation has the lowest value
     int MinStackHeight;     
 
-    uint64_t CurrentPermutation;
-    uint64_t Permutations;    
+    incumbent *Incumbent;
+    work_queue *WorkQueue;
+    transposition_table *TranspositionTable;
+    search_control *SearchControl; // NULL if the search runs until the whole search tree has been searched
+    int NodesUntilLimitCheck; // Number of nodes to enter before next checking whether the search should stop
+    int AbandonedItem; // TRUE if the solver abandoned its work item as the search was stopped, leaving the untried children of the nodes on its path unsearched
+    int CheckpointGeneration; // Generation of the last checkpoint this solver recorded its work in
+
+    // Stores the number of permutations tried or pruned, and the counters of the search by the solver so far
+    permutation_count TriedPermutations;
+    solver_counters Counters;
+    // Stores the number of permutations of the whole sequence
+    permutation_count Permutations;    
+    // Stores the number of tried permutations at which the solver next prints its progress, the number it tries between printing it, and the time it started searching
+    permutation_count ProgressDisplayThreshold;
+    permutation_count ProgressDisplayInterval;
+    time_t StartTime;
+    int ShowProgress; // If FALSE, the solver doesn't print its progress
+
+    // Solvers are stored next to each other, so the fields written by this solver's thread are kept off the cache lines of the next solver
+    char Padding[CACHE_LINE_SIZE];
 } solver;
 
-// Calculate and return the total number of permutations at which the sequence in 'sequenceParams' can be dropped to the grid. If a non-null 'overflow' is passed, and if the permutation counter cannot store all permutations, return TRUE in 'overflow'
-uint64_t getSequencePermutations(sequence_params *sequenceParams, int *overflow);
+// Calculate and return the total number of permutations at which the sequence in 'sequenceParams' can be dropped to the grid
+permutation_count getSequencePermutations(sequence_params *sequenceParams);
 
-// Calculate the number of permutations which an increment in each piece's column counter represents
-void getColumnCounterPermutations(sequence_params *sequenceParams);
+// Calculate the number of permutations below a node reached by dropping each piece, i.e. which share the placements of all pieces up to and including it
+void getSubtreePermutations(sequence_params *sequenceParams);
 
-// Update the counters of 'solver' to the next permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the last permutation
-int getNextPermutation(solver *solver, sequence_params *sequenceParams);
+// Build the placement table of the sequence in 'sequenceParams' with the placements of its greedy solution tried first, or of the rest of the previous window's solution if it stacks lower, storing that solution in 'greedyColumns' and 'greedyRotations'. Return its stack height
+int buildSeededPlacementTable(sequence_params *sequenceParams, int greedyColumns[MAX_SEQUENCE_SIZE], int greedyRotations[MAX_SEQUENCE_SIZE]);
 
-// In 'solver', update the column counter of the tetromino at index 'pieceIndex' to the next permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the permutation before the increment
-int incrementColumnCounter(solver *solver, sequence_params *sequenceParams, int pieceIndex);
+// Prepare the solvers for solving the sequence in 'sequenceParams' as set in 'solverSettings' and 'searchControl' (may be NULL), sharing 'incumbent', 'workQueue' and 'transpositionTable' between them
+void initialiseSolvers(solver solvers[], solver_settings *solverSettings, search_control *searchControl, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable, sequence_params *sequenceParams);
 
-// Update the counters of 'solver' to the next 'n'th permutation. Return the index of the earliest piece in the sequence which has a new column or rotation from the permutation before calling this function
-int getNextNthPermutation(solver *solver, sequence_params *sequenceParams, uint64_t n);
+// Prepare the solvers in 'solvers', sharing 'incumbent' and 'workQueue', to checkpoint their search of the sequence in 'sequenceParams' to 'checkpoint', resuming the work left in it if it was read from a checkpoint file
+void initialiseCheckpoint(solver solvers[], search_checkpoint *checkpoint, incumbent *incumbent, work_queue *workQueue, sequence_params *sequenceParams);
 
-// Set the starting permutation for 'solver' to the permutation in the main solver
-void setSolverStartPermutation(int solver);
+// If 'stackHeight' is lower than the overall best, lower the incumbent shared by 'solver' to it and save the permutation on the path of 'solver' as its best permutation. Return TRUE if the permutation was saved, FALSE otherwise
+int saveIfBestPermutation(solver *solver, sequence_params *sequenceParams, int stackHeight);
 
-// Set 'solver' to the first permutation of the sequence in 'sequenceParams'
-void setToFirstPermutation(solver *solver, sequence_params *sequenceParams);
+// Return the y coordinate at which tetromino 'tet' will land when dropped into column 'droppedColumn', given the grid state in 'gridSkyline'
+int getLandingHeight(tetromino *tet, int droppedColumn, skyline gridSkyline);
 
-// Set each solver's starting permutation and the number of permutations assigned to it for solving the sequence in 'sequenceParams'. Return OVERFLOW_DETECTED if the permutation counter cannot store all permutations
-int initialiseSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams);
+// Return the height of the tetromino stack on the grid, given the grid state in 'gridSkyline'
+int getStackHeight(skyline gridSkyline);
 
-// Return the y coordinate at which tetromino 'tet' will land when dropped into column 'droppedColumn', given height of the grid's columns in 'columnHeights'
-int getLandingHeight(tetromino *tet, int droppedColumn, int columnHeights[GRID_WIDTH]);
+// Lower the bound of the node at depth 'depth' on the path of the current permutation of 'solver' to 'bound', the bound of one of its children, if it is lower
+void boundNode(solver *solver, int depth, int bound);
 
-// Return the height of the tetromino stack on the grid, given the height of the grid's columns in 'columnHeights' 
-int getStackHeight(int columnHeights[GRID_WIDTH]);
+// Split off the untried children of the shallowest node on the path of 'solver' which has any, and donate half of them to an idle solver, if any are waiting in its work queue
+void splitWorkItem(solver *solver, sequence_params *sequenceParams);
 
-// Skip the current permutation in 'solver' and all future permutations which are identical up to piece 'lastDeterminedPiece', as they were determined to be no better than the current best
-void getNextUndeterminedPermutation(solver *solver, sequence_params *sequenceParams, int lastDeterminedPiece);
+// Record the work left in the work item of 'solver' in the checkpoint being taken, starting one if the next checkpoint is due. Pass FALSE in 'hasWork' once the solver has finished its work item, in which case it is no longer busy. The solver recording its work last writes the checkpoint
+void checkpointSearch(solver *solver, sequence_params *sequenceParams, int hasWork);
 
-// Stack the sequence in the current permutation of 'solver' and return the height of the resulting stack. Reuse a saved intermediate grid state if current permutation has an identical beginning to the previous one
-int tryPermutation(solver *solver, sequence_params *sequenceParams);
+// Return TRUE if the search of 'solver' has been stopped, or should stop as it has reached its deadline or node budget or been cancelled, in which case stop it for all solvers and mark the solver's work item as abandoned. Otherwise record the work of 'solver' in the checkpoint if one is being taken, and return FALSE
+int pollSearchControl(solver *solver, sequence_params *sequenceParams);
 
-// Drop tetromino 'tet' into column 'droppedColumn', and update the heights of the grid's columns in 'columnHeights'.
-void dropTetromino(tetromino *tet, int droppedColumn, int columnHeights[GRID_WIDTH]);
+// Search the subtrees in the work item 'item' depth first, pruning each subtree which cannot hold a better permutation than the current best. The search kernel for the width of the grid is chosen once per work item, rather than at each node
+void searchWorkItem(solver *solver, sequence_params *sequenceParams, work_item *item);
+
+// Search the work items handed out by the work queue of 'solver' until the whole search tree of the sequence in 'sequenceParams' has been searched
+void searchWorkItems(solver *solver, sequence_params *sequenceParams);
+
+// Return the number of permutations tried or skipped by 'solver' so far
+permutation_count getTriedPermutations(solver *solver);
 
 // Print the time elapsed and number/percentage of permutations tried for solver 'solver' 
-void printSolverProgress(solver *solver, time_t startTime);
+void printSolverProgress(solver *solver);
 
-// Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers'
-void runSolvers(solver solvers[NUMBER_OF_SOLVERS], sequence_params *sequenceParams);
+// Try all column/rotation permutations and solve the sequence in 'sequenceParams' using the solvers in 'solvers', run as set in 'solverSettings'
+void runSolvers(solver solvers[], solver_settings *solverSettings, sequence_params *sequenceParams);
 
-// Return the solver in 'solvers' which found the solution resulting in the lowest stack height 
-solver * getBestSolver(solver solvers[NUMBER_OF_SOLVERS]);
+// Return the solver out of the 'numberOfSolvers' solvers in 'solvers' which found the solution resulting in the lowest stack height 
+solver * getBestSolver(solver solvers[], int numberOfSolvers);
 
-// Print the stack of tetrominos produced when dropped to the best columns and in the best rotations
-void printSolution(solver *solver, sequence_params *sequenceParams, time_t startTime);
+// Print the stack of tetrominos produced when dropped to the best columns and in the best rotations, and 'lowerBound', the lowest stack height the search didn't rule out, if the best permutation isn't proven to be the lowest
+void printSolution(solver *solver, sequence_params *sequenceParams, time_t startTime, int lowerBound);
 
 // Print the internal state and counters of 'solver'
 void printSolver(int solver, uint64_t remainingPermutations);
 
-// Solve the tetromino sequence in 'sequenceParams' and display the solution
-void solveSequence(sequence_params *sequenceParams);
+// Return a lower bound on the stack height of every permutation in the work item 'item' of the sequence in 'sequenceParams', from the grid state after dropping each of its children. Return NO_NODE_BOUND if it has no children
+int getWorkItemBound(sequence_params *sequenceParams, work_item *item);
+
+// Return the lowest stack height which the search of the sequence in 'sequenceParams' by 'solvers', sharing 'workQueue', hasn't ruled out. This is the lowest stack found if the whole search tree was searched. 
+// Otherwise it is the lowest bound on the work left in the queue or abandoned by the solvers when the search was stopped, if that is lower, but never lower than the bound on the grid state the sequence is dropped onto
+int getSearchLowerBound(solver solvers[], int numberOfSolvers, work_queue *workQueue, sequence_params *sequenceParams);
+
+// Search the whole search tree of the sequence in 'sequenceParams' with the solvers in 'solvers', run as set in 'solverSettings' and 'searchControl' (may be NULL) and sharing 'incumbent', 'workQueue' and 'transpositionTable' between them, until it is searched or the search is stopped. Return the solver holding the best permutation, and the lower bound on the lowest stack in 'lowerBound' (may be NULL)
+solver *searchSequence(solver solvers[], solver_settings *solverSettings, search_control *searchControl, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable, sequence_params *sequenceParams, int *lowerBound);
 
-#endif
\ No newline at end of file
+// Display the solution of the sequence in 'sequenceParams' stored in 'solutionCache', if it is cached. Return TRUE if it was displayed, FALSE otherwise
+int printCachedSolution(solution_cache *solutionCache, sequence_params *sequenceParams, time_t startTime);
+
+// Solve the tetromino sequence in 'sequenceParams' using the solvers set in 'solverSettings', and display the solution
+void solveSequence(sequence_params *sequenceParams, solver_settings *solverSettings);
+
+// Resume solving the tetromino sequence whose search was checkpointed to the checkpoint file set in 'solverSettings', and display the solution. Return TRUE if it was resumed, FALSE if the checkpoint file couldn't be read
+int resumeSequence(solver_settings *solverSettings);
+
+#endif
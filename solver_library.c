@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "bool.h"
+#include "solver_library.h"
+#include "input_utils.h"
+#include "solver.h"
+#include "scheduler.h"
+#include "run_solvers.h"
+#include "tetromino.h"
+#include "skyline.h"
+#include "grid.h"
+#include "solution_cache.h"
+#include "thread_utils.h"
+#include "telemetry.h"
+
+// Create a context solving requests with the solvers, solution cache and telemetry set in 'solverSettings', which only prints if its ShowProgress is TRUE. Return the context, or NULL if it couldn't be allocated or the cache couldn't be opened
+solve_context *createSolveContext(solver_settings *solverSettings)
+{
+    solve_context *solveContext = malloc(sizeof(solve_context));
+
+    if (solveContext == NULL) return NULL;
+
+    solveContext->SolverSettings = *solverSettings;
+    solveContext->Solvers = malloc(sizeof(solver) * solverSettings->NumberOfSolvers);
+
+    if (solveContext->Solvers == NULL || createTranspositionTable(&solveContext->TranspositionTable, solverSettings->TranspositionTableMegabytes) == FALSE)
+    {
+        free(solveContext->Solvers);
+        free(solveContext);
+        return NULL;
+    }
+
+    if (solverSettings->CacheFile != NULL && openSolutionCache(&solveContext->SolutionCache, solverSettings->CacheFile) == FALSE)
+    {
+        destroyTranspositionTable(&solveContext->TranspositionTable);
+        free(solveContext->Solvers);
+        free(solveContext);
+        return NULL;
+    }
+
+    if (solverSettings->TelemetryFile != NULL && startTelemetryReporter(&solveContext->TelemetryReporter, &solveContext->SolverSettings, solveContext->Solvers, &solveContext->Incumbent) == FALSE)
+    {
+        if (solverSettings->CacheFile != NULL) closeSolutionCache(&solveContext->SolutionCache);
+        destroyTranspositionTable(&solveContext->TranspositionTable);
+        free(solveContext->Solvers);
+        free(solveContext);
+        return NULL;
+    }
+
+    // The solver threads wait for requests between them, rather than being created for each one
+    if (startSolverPool(&solveContext->SolverPool, solveContext->Solvers, &solveContext->SolverSettings) == FALSE)
+    {
+        if (solverSettings->TelemetryFile != NULL) stopTelemetryReporter(&solveContext->TelemetryReporter);
+        if (solverSettings->CacheFile != NULL) closeSolutionCache(&solveContext->SolutionCache);
+        destroyTranspositionTable(&solveContext->TranspositionTable);
+        free(solveContext->Solvers);
+        free(solveContext);
+        return NULL;
+    }
+
+    initialiseLock(&solveContext->Lock);
+    return solveContext;
+}
+
+// Stop the solver threads of 'solveContext' and free it. No request may be being solved in it
+void destroySolveContext(solve_context *solveContext)
+{
+    stopSolverPool(&solveContext->SolverPool);
+    if (solveContext->SolverSettings.TelemetryFile != NULL) stopTelemetryReporter(&solveContext->TelemetryReporter);
+    if (solveContext->SolverSettings.CacheFile != NULL) closeSolutionCache(&solveContext->SolutionCache);
+    destroyTranspositionTable(&solveContext->TranspositionTable);
+    destroyLock(&solveContext->Lock);
+    free(solveContext->Solvers);
+    free(solveContext);
+}
+
+// Return TRUE if the sequence of 'request' can be solved, FALSE otherwise
+int isValidSolveRequest(solve_request *request)
+{
+    if (request->Sequence == NULL || request->Size < 1 || request->Size > MAX_SEQUENCE_SIZE || request->TimeLimit < 0) return FALSE;
+    if (request->GridWidth != 0 && (request->GridWidth < MIN_GRID_WIDTH || request->GridWidth > MAX_GRID_WIDTH)) return FALSE;
+
+    for (int piece = 0; piece < request->Size; piece++)
+        if (getTetromino(request->Sequence[piece], ROTATION_0) == FALSE) return FALSE;
+
+    return TRUE;
+}
+
+// Fill 'result' with the solution of the sequence held by 'solveContext' stored in its solution cache, if it is cached. Return TRUE if it was cached, FALSE otherwise
+int getCachedSolveResult(solve_context *solveContext, solve_result *result)
+{
+    solution_cache_entry cachedSolution;
+
+    if (lookUpCachedSolution(&solveContext->SolutionCache, &solveContext->SequenceParams, solveContext->SequenceParams.GridWidth, &cachedSolution) == FALSE) return FALSE;
+
+    result->Status = SOLVE_OK;
+    result->StackHeight = cachedSolution.StackHeight;
+    result->LowerBound = cachedSolution.StackHeight;
+    result->Optimal = TRUE;
+    result->Permutations = getSequencePermutations(&solveContext->SequenceParams);
+    result->Cached = TRUE;
+
+    for (int piece = 0; piece < solveContext->SequenceParams.Size; piece++)
+    {
+        result->PieceColumns[piece] = cachedSolution.PieceColumns[piece];
+        result->PieceRotations[piece] = cachedSolution.PieceRotations[piece];
+    }
+
+    return TRUE;
+}
+
+// Search the sequence held by 'solveContext' within the limits and with the callbacks of 'request', started at the wall clock time 'startTime', storing the solution in 'result'
+void searchSolveRequest(solve_context *solveContext, solve_request *request, solve_result *result, double startTime)
+{
+    sequence_params *sequenceParams = &solveContext->SequenceParams;
+    search_control *searchControl = &solveContext->SearchControl;
+    solver *bestSolver;
+
+    searchControl->Deadline = request->TimeLimit > 0 ? startTime + request->TimeLimit : 0;
+    searchControl->NodeBudget = request->NodeBudget;
+    searchControl->ShouldCancel = request->ShouldCancel;
+    searchControl->OnImprovedSolution = request->OnImprovedSolution;
+    searchControl->UserData = request->UserData;
+    searchControl->Checkpoint = NULL;
+    searchControl->Telemetry = solveContext->SolverSettings.TelemetryFile != NULL ? &solveContext->TelemetryReporter : NULL;
+
+    initialiseSolvers(solveContext->Solvers, &solveContext->SolverSettings, searchControl, &solveContext->Incumbent, &solveContext->WorkQueue, \
+                      &solveContext->TranspositionTable, sequenceParams);
+
+    if (searchControl->Telemetry != NULL) beginTelemetrySearch(searchControl->Telemetry, sequenceParams);
+    runSolverPool(&solveContext->SolverPool, sequenceParams);
+    if (searchControl->Telemetry != NULL) endTelemetrySearch(searchControl->Telemetry);
+
+    bestSolver = getBestSolver(solveContext->Solvers, solveContext->SolverSettings.NumberOfSolvers);
+    result->Status = solveContext->WorkQueue.Stopped == TRUE ? SOLVE_STOPPED : SOLVE_OK;
+    result->StackHeight = bestSolver->MinStackHeight;
+    result->LowerBound = getSearchLowerBound(solveContext->Solvers, solveContext->SolverSettings.NumberOfSolvers, &solveContext->WorkQueue, sequenceParams);
+    result->Optimal = result->LowerBound == result->StackHeight ? TRUE : FALSE;
+    result->Permutations = bestSolver->Permutations;
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        result->PieceColumns[piece] = bestSolver->BestPieceColumns[piece];
+        result->PieceRotations[piece] = bestSolver->BestPieceRotations[piece];
+    }
+
+    for (int solver = 0; solver < solveContext->SolverSettings.NumberOfSolvers; solver++)
+    {
+        result->TriedPermutations += getTriedPermutations(&solveContext->Solvers[solver]);
+        result->Nodes += solveContext->Solvers[solver].Counters.Nodes;
+    }
+
+    destroyWorkQueue(&solveContext->WorkQueue);
+}
+
+// Solve 'request' in 'solveContext', storing the solution in 'result'. Return the status of the result
+int solveSequenceRequest(solve_context *solveContext, solve_request *request, solve_result *result)
+{
+    sequence_params *sequenceParams = &solveContext->SequenceParams;
+    double startTime = getWallClockTime();
+
+    memset(result, 0, sizeof(solve_result));
+
+    if (isValidSolveRequest(request) == FALSE)
+    {
+        result->Status = SOLVE_INVALID_REQUEST;
+        return result->Status;
+    }
+
+    // The solvers, work queue and transposition table of the context are used by one request at a time
+    acquireLock(&solveContext->Lock);
+
+    memcpy(sequenceParams->Sequence, request->Sequence, request->Size);
+    sequenceParams->Size = request->Size;
+    sequenceParams->AllowRotation = request->AllowRotation == FALSE ? FALSE : TRUE;
+    sequenceParams->GridWidth = request->GridWidth == 0 ? solveContext->SolverSettings.GridWidth : request->GridWidth;
+    memset(&sequenceParams->Root, 0, sizeof(sequenceParams->Root));
+
+    if (solveContext->SolverSettings.CacheFile != NULL && getCachedSolveResult(solveContext, result) == TRUE)
+    {
+        releaseLock(&solveContext->Lock);
+        result->ElapsedTime = getWallClockTime() - startTime;
+        return result->Status;
+    }
+
+    searchSolveRequest(solveContext, request, result, startTime);
+
+    // Solutions of stopped searches may not be the lowest stack, so only proven ones are cached
+    if (solveContext->SolverSettings.CacheFile != NULL && result->Optimal == TRUE)
+        storeCachedSolution(&solveContext->SolutionCache, sequenceParams, sequenceParams->GridWidth, result->StackHeight, result->PieceColumns, result->PieceRotations);
+
+    releaseLock(&solveContext->Lock);
+
+    result->ElapsedTime = getWallClockTime() - startTime;
+    return result->Status;
+}
+
+// Start 'stream' solving pieces online in 'solveContext', in a grid 'gridWidth' columns wide whose columns are 'columnHeights' high. A width of 0 uses the width in the settings of the context, and NULL heights an empty grid. 
+// Return TRUE if it was started, FALSE if the grid width is out of range, a height is negative or a column is more than GRID_HEIGHT - STREAM_PIECE_ROWS rows above the lowest one
+int startSolveStream(solve_stream *stream, solve_context *solveContext, int gridWidth, int allowRotation, const int columnHeights[])
+{
+    int baseHeight = INT_MAX;
+
+    memset(stream, 0, sizeof(solve_stream));
+    stream->SolveContext = solveContext;
+    stream->GridWidth = gridWidth == 0 ? solveContext->SolverSettings.GridWidth : gridWidth;
+    stream->AllowRotation = allowRotation == FALSE ? FALSE : TRUE;
+    stream->Skyline = EMPTY_SKYLINE;
+
+    if (stream->GridWidth < MIN_GRID_WIDTH || stream->GridWidth > MAX_GRID_WIDTH) return FALSE;
+    if (columnHeights == NULL) return TRUE;
+
+    for (int column = 0; column < stream->GridWidth; column++)
+    {
+        if (columnHeights[column] < 0) return FALSE;
+        if (columnHeights[column] < baseHeight) baseHeight = columnHeights[column];
+    }
+
+    // Only the heights above the lowest column decide where pieces land
+    for (int column = 0; column < stream->GridWidth; column++)
+    {
+        if (columnHeights[column] - baseHeight > GRID_HEIGHT - STREAM_PIECE_ROWS) return FALSE;
+        stream->Skyline = raiseColumnHeight(stream->Skyline, column, columnHeights[column] - baseHeight);
+    }
+
+    stream->BaseHeight = baseHeight;
+    return TRUE;
+}
+
+// Return the height of the stack of 'stream', counted from the bottom of the grid
+int getStreamStackHeight(solve_stream *stream)
+{
+    return stream->BaseHeight + getSkylineHeight(stream->Skyline);
+}
+
+// Drop 'piece' onto the grid of 'stream' into column 'column' in rotation 'rotation', then lower the grid state so that its lowest column is at height 0
+void dropStreamPiece(solve_stream *stream, char piece, int column, int rotation)
+{
+    tetromino *tet = getTetromino(piece, rotation);
+    int landingHeight = getLandingHeight(tet, column, stream->Skyline);
+    int loweredHeight;
+
+    for (int tetCol = 0; tetCol < tet->Width; tetCol++)
+        stream->Skyline = raiseColumnHeight(stream->Skyline, column + tetCol, landingHeight + tet->ColumnHeights[tetCol]);
+
+    stream->Skyline = normaliseSkyline(stream->Skyline, stream->GridWidth, &loweredHeight);
+    stream->BaseHeight += loweredHeight;
+    stream->Pieces++;
+}
+
+// Solve the window in the sequence of 'request' for 'stream', i.e. the piece dropped next followed by the pieces known to come after it, within the limits and with the callbacks of 'request' but in the grid width and rotation of the stream. 
+// The window is cut short if its stack could rise more than GRID_HEIGHT rows above the lowest column, leaving the number of pieces solved in the WindowSize of 'stream'. Store the solution of the window in 'result', with its heights counted from the bottom of the grid, 
+// and drop the first piece at its placement in the solution, even if the search was stopped. Return the status of the result, which is SOLVE_INVALID_REQUEST if the window is invalid or the stack is too high above the lowest column for the piece, in which case no piece is dropped
+int solveStreamPiece(solve_stream *stream, solve_request *request, solve_result *result)
+{
+    solve_context *solveContext = stream->SolveContext;
+    sequence_params *sequenceParams = &solveContext->SequenceParams;
+    sequence_root *root = &sequenceParams->Root;
+    double startTime = getWallClockTime();
+    int size = request->Size;
+    int plannedPieces = 0;
+
+    memset(result, 0, sizeof(solve_result));
+
+    if (isValidSolveRequest(request) == FALSE || getSkylineHeight(stream->Skyline) + STREAM_PIECE_ROWS > GRID_HEIGHT)
+    {
+        result->Status = SOLVE_INVALID_REQUEST;
+        return result->Status;
+    }
+
+    while (getSkylineHeight(stream->Skyline) + size * STREAM_PIECE_ROWS > GRID_HEIGHT) size--;
+
+    // The solution of the previous window holds the pieces after its first one which this window starts with
+    while (plannedPieces < size && plannedPieces < stream->WindowSize - 1 && request->Sequence[plannedPieces] == stream->Window[plannedPieces + 1]) plannedPieces++;
+
+    acquireLock(&solveContext->Lock);
+
+    memcpy(sequenceParams->Sequence, request->Sequence, size);
+    sequenceParams->Size = size;
+    sequenceParams->AllowRotation = stream->AllowRotation;
+    sequenceParams->GridWidth = stream->GridWidth;
+
+    // If the window is the rest of the previous window, whose solution was proven to be the lowest stack, the rest of that solution is the lowest stack of the window
+    if (stream->PlanOptimal == TRUE && plannedPieces == size && size == stream->WindowSize - 1)
+    {
+        result->Status = SOLVE_OK;
+        result->StackHeight = result->LowerBound = stream->PlanStackHeight;
+        result->Optimal = TRUE;
+        result->Permutations = getSequencePermutations(sequenceParams);
+
+        for (int piece = 0; piece < size; piece++)
+        {
+            result->PieceColumns[piece] = stream->PlanColumns[piece + 1];
+            result->PieceRotations[piece] = stream->PlanRotations[piece + 1];
+        }
+    }
+    else
+    {
+        // The bounds stored for the previous window hold for this one if it holds every piece of the previous window after the first, and no other request has cleared the table since
+        if (stream->WindowSize == 0 || plannedPieces < stream->WindowSize - 1 || stream->TableGeneration != solveContext->TranspositionTable.Generation || stream->TableDepth + size > MAX_TRANSPOSITION_DEPTH)
+        {
+            clearTranspositionTable(&solveContext->TranspositionTable);
+            stream->TableGeneration = solveContext->TranspositionTable.Generation;
+            stream->TableDepth = 0;
+        }
+
+        root->Skyline = stream->Skyline;
+        root->NarrowSkyline = getNarrowSkyline(stream->Skyline);
+        root->Streamed = TRUE;
+        root->Depth = stream->TableDepth;
+        root->PlannedPieces = plannedPieces;
+
+        for (int piece = 0; piece < plannedPieces; piece++)
+        {
+            root->PlannedColumns[piece] = stream->PlanColumns[piece + 1];
+            root->PlannedRotations[piece] = stream->PlanRotations[piece + 1];
+        }
+
+        searchSolveRequest(solveContext, request, result, startTime);
+        result->StackHeight += stream->BaseHeight;
+        result->LowerBound += stream->BaseHeight;
+    }
+
+    memcpy(stream->Window, sequenceParams->Sequence, size);
+    stream->WindowSize = size;
+    memcpy(stream->PlanColumns, result->PieceColumns, sizeof(stream->PlanColumns));
+    memcpy(stream->PlanRotations, result->PieceRotations, sizeof(stream->PlanRotations));
+    stream->PlanStackHeight = result->StackHeight;
+    stream->PlanOptimal = result->Optimal;
+
+    releaseLock(&solveContext->Lock);
+
+    dropStreamPiece(stream, stream->Window[0], stream->PlanColumns[0], stream->PlanRotations[0]);
+    stream->TableDepth++;
+
+    result->ElapsedTime = getWallClockTime() - startTime;
+    return result->Status;
+}
@@ -0,0 +1,125 @@
+#ifndef SOLVER_LIBRARY_H
+#define SOLVER_LIBRARY_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "solver.h"
+#include "scheduler.h"
+#include "run_solvers.h"
+#include "transposition_table.h"
+#include "solution_cache.h"
+#include "thread_utils.h"
+#include "permutation_count.h"
+#include "telemetry.h"
+
+// Statuses of a solve request
+#define SOLVE_OK 0 // The whole search tree was searched, so the result is the lowest possible stack
+#define SOLVE_STOPPED 1 // The time limit or node budget was reached or the request was cancelled first, so the result is the lowest stack found so far, which may still be proven to be the lowest
+#define SOLVE_INVALID_REQUEST -1 // The sequence is empty, longer than MAX_SEQUENCE_SIZE or holds a character which is not a tetromino, or the grid width is out of range
+
+#define STREAM_PIECE_ROWS (GRID_HEIGHT / MAX_SEQUENCE_SIZE) // Most rows a piece can raise the stack by. A window of a stream is cut short if its stack could rise more than GRID_HEIGHT rows above the lowest column
+
+typedef struct // Stores a sequence to solve and the limits on solving it, set by the caller of the solver library
+{
+    const char *Sequence; // Pieces of the sequence, which need not be null-terminated
+    int Size;
+    int AllowRotation;
+    int GridWidth; // Number of columns in the grid, from MIN_GRID_WIDTH to MAX_GRID_WIDTH. 0 uses the width in the settings of the context
+    double TimeLimit; // Seconds after which the search stops. 0 if the search has no time limit
+    uint64_t NodeBudget; // Search tree nodes the solver threads may enter between them before the search stops. 0 if the search has no node budget
+    int (*ShouldCancel)(void *userData); // Polled while solving. The search stops once it returns TRUE. May be NULL
+    void (*OnImprovedSolution)(void *userData, int stackHeight); // Called each time a lower stack is found, possibly by several solver threads at once. May be NULL
+    void *UserData; // Passed to the callbacks
+} solve_request;
+
+typedef struct // Stores the solution of a solve request
+{
+    int Status;
+
+    // Stores the lowest stack found, and the column and rotation index of each piece which stack to it
+    int StackHeight;
+    int PieceColumns[MAX_SEQUENCE_SIZE];
+    int PieceRotations[MAX_SEQUENCE_SIZE];
+    // Stores the lowest stack height the search didn't rule out, and whether it is the stack height found, i.e. whether the solution is proven to be the lowest stack. Always proven unless the search was stopped
+    int LowerBound;
+    int Optimal;
+
+    // Stores the number of permutations of the sequence, how many of them were tried or pruned, and the number of search tree nodes entered
+    permutation_count Permutations;
+    permutation_count TriedPermutations;
+    uint64_t Nodes;
+    double ElapsedTime; // Seconds
+    int Cached; // TRUE if the solution was read from the solution cache, in which case no permutations were tried
+} solve_result;
+
+typedef struct // Stores the solvers, solver threads and transposition table kept between the requests solved in it. Requests solved in the same context are solved one at a time, requests solved in different contexts may be solved at the same time
+{
+    solver_settings SolverSettings;
+    solver *Solvers;
+    solver_pool SolverPool;
+    incumbent Incumbent;
+    work_queue WorkQueue;
+    transposition_table TranspositionTable;
+    search_control SearchControl;
+    sequence_params SequenceParams;
+    solution_cache SolutionCache; // Opened if the settings hold a cache file
+    telemetry_reporter TelemetryReporter; // Started if the settings hold a telemetry file, and kept between requests
+    solver_lock Lock;
+} solve_context;
+
+typedef struct // Stores a stream of pieces solved online in a solve context, one piece at a time, each dropped at its placement in the solution of a window of the pieces known to come next. Kept between pieces, so that each window's search starts from the work of the one before it
+{
+    solve_context *SolveContext;
+    int GridWidth;
+    int AllowRotation;
+    // Stores the grid state the next piece is dropped onto, lowered so that its lowest column is at height 0, and the height it was lowered by
+    skyline Skyline;
+    int BaseHeight;
+    int Pieces; // Pieces dropped so far
+    // Stores the last window solved and its solution, whose heights include the base height, and whether it is proven to be the lowest stack
+    char Window[MAX_SEQUENCE_SIZE];
+    int WindowSize; // 0 until the first window is solved
+    int PlanColumns[MAX_SEQUENCE_SIZE];
+    int PlanRotations[MAX_SEQUENCE_SIZE];
+    int PlanStackHeight;
+    int PlanOptimal;
+    // Stores the generation of the transposition table of the context holding the bounds stored for the stream's windows, and the depth of the next piece in their keys
+    uint64_t TableGeneration;
+    int TableDepth;
+} solve_stream;
+
+// Create a context solving requests with the solvers, solution cache and telemetry set in 'solverSettings', which only prints if its ShowProgress is TRUE. Return the context, or NULL if it couldn't be allocated or the cache couldn't be opened
+solve_context *createSolveContext(solver_settings *solverSettings);
+
+// Stop the solver threads of 'solveContext' and free it. No request may be being solved in it
+void destroySolveContext(solve_context *solveContext);
+
+// Return TRUE if the sequence of 'request' can be solved, FALSE otherwise
+int isValidSolveRequest(solve_request *request);
+
+// Fill 'result' with the solution of the sequence held by 'solveContext' stored in its solution cache, if it is cached. Return TRUE if it was cached, FALSE otherwise
+int getCachedSolveResult(solve_context *solveContext, solve_result *result);
+
+// Search the sequence held by 'solveContext' within the limits and with the callbacks of 'request', started at the wall clock time 'startTime', storing the solution in 'result'
+void searchSolveRequest(solve_context *solveContext, solve_request *request, solve_result *result, double startTime);
+
+// Solve 'request' in 'solveContext', storing the solution in 'result'. Return the status of the result
+int solveSequenceRequest(solve_context *solveContext, solve_request *request, solve_result *result);
+
+// Start 'stream' solving pieces online in 'solveContext', in a grid 'gridWidth' columns wide whose columns are 'columnHeights' high. A width of 0 uses the width in the settings of the context, and NULL heights an empty grid. 
+// Return TRUE if it was started, FALSE if the grid width is out of range, a height is negative or a column is more than GRID_HEIGHT - STREAM_PIECE_ROWS rows above the lowest one
+int startSolveStream(solve_stream *stream, solve_context *solveContext, int gridWidth, int allowRotation, const int columnHeights[]);
+
+// Return the height of the stack of 'stream', counted from the bottom of the grid
+int getStreamStackHeight(solve_stream *stream);
+
+// Drop 'piece' onto the grid of 'stream' into column 'column' in rotation 'rotation', then lower the grid state so that its lowest column is at height 0
+void dropStreamPiece(solve_stream *stream, char piece, int column, int rotation);
+
+// Solve the window in the sequence of 'request' for 'stream', i.e. the piece dropped next followed by the pieces known to come after it, within the limits and with the callbacks of 'request' but in the grid width and rotation of the stream. 
+// The window is cut short if its stack could rise more than GRID_HEIGHT rows above the lowest column, leaving the number of pieces solved in the WindowSize of 'stream'. Store the solution of the window in 'result', with its heights counted from the bottom of the grid, 
+// and drop the first piece at its placement in the solution, even if the search was stopped. Return the status of the result, which is SOLVE_INVALID_REQUEST if the window is invalid or the stack is too high above the lowest column for the piece, in which case no piece is dropped
+int solveStreamPiece(solve_stream *stream, solve_request *request, solve_result *result);
+
+#endif
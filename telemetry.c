@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "bool.h"
+#include "telemetry.h"
+#include "input_utils.h"
+#include "solver.h"
+#include "thread_utils.h"
+#include "checkpoint.h"
+#include "permutation_count.h"
+
+#ifdef _WIN32 // Windows implementation (reporter thread)
+
+#include <windows.h>
+
+// Runs the reporter in its own thread of execution, using the reporter 'threadParams' (must point to a telemetry_reporter)
+DWORD WINAPI runTelemetryThread(LPVOID threadParams)
+{
+    runTelemetryReporter((telemetry_reporter *) threadParams);
+    return 0;
+}
+
+// Create a reporter thread running 'telemetryReporter', storing its handle in 'telemetryReporter'. Return TRUE if the thread was created, FALSE otherwise
+int createTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    telemetryReporter->Thread = CreateThread(NULL, 0, runTelemetryThread, telemetryReporter, 0, NULL);
+    return telemetryReporter->Thread != NULL ? TRUE : FALSE;
+}
+
+// Block until the reporter thread of 'telemetryReporter' has exited, then free its handle
+void joinTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    WaitForSingleObject(telemetryReporter->Thread, INFINITE);
+    CloseHandle(telemetryReporter->Thread);
+}
+
+
+#elif defined __linux__ // Linux implementation (reporter thread)
+
+#include <pthread.h>
+
+// Runs the reporter in its own thread of execution, using the reporter 'threadParams' (must point to a telemetry_reporter)
+void* runTelemetryThread(void *threadParams)
+{
+    runTelemetryReporter((telemetry_reporter *) threadParams);
+    return 0;
+}
+
+// Create a reporter thread running 'telemetryReporter', storing its handle in 'telemetryReporter'. Return TRUE if the thread was created, FALSE otherwise
+int createTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    return pthread_create(&telemetryReporter->Thread, NULL, runTelemetryThread, telemetryReporter) == 0 ? TRUE : FALSE;
+}
+
+// Block until the reporter thread of 'telemetryReporter' has exited, then free its handle
+void joinTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    pthread_join(telemetryReporter->Thread, NULL);
+}
+
+
+#else // Standard implementation (no reporter thread, a snapshot is written as each search finishes)
+
+// Create a reporter thread running 'telemetryReporter', storing its handle in 'telemetryReporter'. Return TRUE if the thread was created, FALSE otherwise
+int createTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    // Without threads, the snapshot of each search is written once it finishes
+    (void) telemetryReporter;
+    return FALSE;
+}
+
+// Block until the reporter thread of 'telemetryReporter' has exited, then free its handle
+void joinTelemetryThread(telemetry_reporter *telemetryReporter)
+{
+    (void) telemetryReporter;
+}
+
+#endif
+
+// Start 'telemetryReporter' publishing snapshots of the counters of the solvers in 'solvers', which share 'incumbent', to the telemetry file set in 'solverSettings'. Return TRUE if it was started, FALSE if it couldn't be allocated
+int startTelemetryReporter(telemetry_reporter *telemetryReporter, solver_settings *solverSettings, solver solvers[], incumbent *incumbent)
+{
+    memset(telemetryReporter, 0, sizeof(telemetry_reporter));
+
+    telemetryReporter->File = solverSettings->TelemetryFile;
+    telemetryReporter->Interval = solverSettings->TelemetryInterval / 1000.0;
+    telemetryReporter->Solvers = solvers;
+    telemetryReporter->NumberOfSolvers = solverSettings->NumberOfSolvers;
+    telemetryReporter->Incumbent = incumbent;
+    telemetryReporter->Snapshots = calloc(solverSettings->NumberOfSolvers, sizeof(solver_snapshot));
+
+    if (telemetryReporter->Snapshots == NULL) return FALSE;
+
+    initialiseLock(&telemetryReporter->Lock);
+    initialiseCondition(&telemetryReporter->Wake);
+
+    // The file is written before the first search, so watchers can tell the reporter has started
+    writeTelemetryFile(telemetryReporter);
+    telemetryReporter->ThreadCreated = createTelemetryThread(telemetryReporter);
+
+    return TRUE;
+}
+
+// Tell the reporter thread of 'telemetryReporter' to exit, wait for it, write a last snapshot and free the reporter. No search may be running
+void stopTelemetryReporter(telemetry_reporter *telemetryReporter)
+{
+    acquireLock(&telemetryReporter->Lock);
+    telemetryReporter->Stopping = TRUE;
+    signalCondition(&telemetryReporter->Wake);
+    releaseLock(&telemetryReporter->Lock);
+
+    if (telemetryReporter->ThreadCreated == TRUE) joinTelemetryThread(telemetryReporter);
+
+    // The last search may have finished since the last snapshot was written
+    writeTelemetryFile(telemetryReporter);
+
+    destroyCondition(&telemetryReporter->Wake);
+    destroyLock(&telemetryReporter->Lock);
+    free(telemetryReporter->Snapshots);
+}
+
+// Report on the search of the sequence in 'sequenceParams' in 'telemetryReporter', once its solvers have been initialised and before they start searching
+void beginTelemetrySearch(telemetry_reporter *telemetryReporter, sequence_params *sequenceParams)
+{
+    acquireLock(&telemetryReporter->Lock);
+
+    memcpy(telemetryReporter->Sequence, sequenceParams->Sequence, sequenceParams->Size);
+    telemetryReporter->Size = sequenceParams->Size;
+    telemetryReporter->AllowRotation = sequenceParams->AllowRotation;
+    telemetryReporter->GridWidth = sequenceParams->GridWidth;
+    telemetryReporter->Permutations = getSequencePermutations(sequenceParams);
+
+    telemetryReporter->Searching = TRUE;
+    telemetryReporter->Searches++;
+    telemetryReporter->SearchStartTime = telemetryReporter->SnapshotTime = getWallClockTime();
+    telemetryReporter->SearchTime = 0;
+    telemetryReporter->MinStackHeight = ATOMIC_LOAD_INT(&telemetryReporter->Incumbent->MinStackHeight);
+    memset(telemetryReporter->Snapshots, 0, sizeof(solver_snapshot) * telemetryReporter->NumberOfSolvers);
+
+    releaseLock(&telemetryReporter->Lock);
+}
+
+// Take the last snapshot of the search being reported on in 'telemetryReporter', once all of its solvers have finished
+void endTelemetrySearch(telemetry_reporter *telemetryReporter)
+{
+    acquireLock(&telemetryReporter->Lock);
+
+    // The solvers are reset for the next search, so the snapshot holds the finished search until then
+    takeTelemetrySnapshot(telemetryReporter);
+    telemetryReporter->Searching = FALSE;
+    if (telemetryReporter->ThreadCreated == FALSE) writeTelemetryFile(telemetryReporter);
+
+    releaseLock(&telemetryReporter->Lock);
+}
+
+// Copy the counters of each solver of the search being reported on in 'telemetryReporter' into its snapshot. 'telemetryReporter' must be locked
+void takeTelemetrySnapshot(telemetry_reporter *telemetryReporter)
+{
+    solver_snapshot *snapshot;
+    double snapshotTime = getWallClockTime();
+    uint64_t previousNodes;
+
+    for (int solver = 0; solver < telemetryReporter->NumberOfSolvers; solver++)
+    {
+        snapshot = &telemetryReporter->Snapshots[solver];
+        previousNodes = snapshot->Counters.Nodes;
+
+        // The counters are read while the solver writes them, so each counter is current but the counters may be from slightly different moments
+        snapshot->Counters = telemetryReporter->Solvers[solver].Counters;
+        snapshot->TriedPermutations = getTriedPermutations(&telemetryReporter->Solvers[solver]);
+        if (snapshotTime > telemetryReporter->SnapshotTime)
+            snapshot->NodesPerSecond = (double) (snapshot->Counters.Nodes - previousNodes) / (snapshotTime - telemetryReporter->SnapshotTime);
+    }
+
+    telemetryReporter->SnapshotTime = snapshotTime;
+    telemetryReporter->SearchTime = snapshotTime - telemetryReporter->SearchStartTime;
+    telemetryReporter->MinStackHeight = ATOMIC_LOAD_INT(&telemetryReporter->Incumbent->MinStackHeight);
+}
+
+// Print the counters in 'counters', of a search of a sequence of 'size' pieces, to 'output' as the fields of a JSON object
+void printTelemetryCounters(FILE *output, solver_counters *counters, int size)
+{
+    fprintf(output, "\"nodes\":%" PRIu64 ",\"duplicates\":%" PRIu64 ",\"tableHits\":%" PRIu64 ",\"improvements\":%" PRIu64 ",\"workItems\":%" PRIu64 ",\"idleSeconds\":%.3f,\"pruned\":[", \
+        counters->Nodes, counters->DuplicateSubtrees, counters->TableHits, counters->Improvements, counters->WorkItems, counters->IdleTime);
+
+    // Subtrees are only pruned below the nodes reached by dropping each piece but the last
+    for (int piece = 0; piece < size - 1; piece++)
+        fprintf(output, piece == 0 ? "%" PRIu64 : ",%" PRIu64, counters->PrunedSubtrees[piece]);
+    fputc(']', output);
+}
+
+// Write the snapshot of 'telemetryReporter', which must be locked, to its telemetry file as one JSON object. Return TRUE if it was written, FALSE otherwise
+int writeTelemetryFile(telemetry_reporter *telemetryReporter)
+{
+    char *newPath = malloc(strlen(telemetryReporter->File) + sizeof(".new"));
+    FILE *output;
+    solver_snapshot *snapshot;
+    solver_counters totals = {0};
+    permutation_count triedPermutations = 0;
+    double nodesPerSecond = 0;
+    char triedCount[MAX_PERMUTATION_COUNT_LENGTH];
+    char permutationCount[MAX_PERMUTATION_COUNT_LENGTH];
+    int written;
+
+    if (newPath == NULL) return FALSE;
+    sprintf(newPath, "%s.new", telemetryReporter->File);
+
+    output = fopen(newPath, "w");
+    if (output == NULL)
+    {
+        free(newPath);
+        return FALSE;
+    }
+
+    for (int solver = 0; solver < telemetryReporter->NumberOfSolvers; solver++)
+    {
+        snapshot = &telemetryReporter->Snapshots[solver];
+        totals.Nodes += snapshot->Counters.Nodes;
+        totals.DuplicateSubtrees += snapshot->Counters.DuplicateSubtrees;
+        totals.TableHits += snapshot->Counters.TableHits;
+        totals.Improvements += snapshot->Counters.Improvements;
+        totals.WorkItems += snapshot->Counters.WorkItems;
+        totals.IdleTime += snapshot->Counters.IdleTime;
+        for (int piece = 0; piece < telemetryReporter->Size; piece++) totals.PrunedSubtrees[piece] += snapshot->Counters.PrunedSubtrees[piece];
+        triedPermutations += snapshot->TriedPermutations;
+        nodesPerSecond += snapshot->NodesPerSecond;
+    }
+
+    fprintf(output, "{\"searches\":%" PRIu64 ",\"searching\":%s", telemetryReporter->Searches, telemetryReporter->Searching == TRUE ? "true" : "false");
+
+    // The search being reported on, or the last one, followed by the totals of its solvers and the counters of each one
+    if (telemetryReporter->Searches > 0)
+    {
+        fprintf(output, ",\"sequence\":\"%.*s\",\"rotation\":%s,\"width\":%d,\"seconds\":%.3f,\"height\":%d,\"permutations\":%s,\"tried\":%s,\"progress\":%.4f,\"nodesPerSecond\":%.0f,", \
+            telemetryReporter->Size, telemetryReporter->Sequence, telemetryReporter->AllowRotation == TRUE ? "true" : "false", telemetryReporter->GridWidth, \
+            telemetryReporter->SearchTime, telemetryReporter->MinStackHeight, formatPermutationCount(telemetryReporter->Permutations, permutationCount), \
+            formatPermutationCount(triedPermutations, triedCount), 100.0 * (double) triedPermutations / (double) telemetryReporter->Permutations, nodesPerSecond);
+        printTelemetryCounters(output, &totals, telemetryReporter->Size);
+
+        fprintf(output, ",\"solvers\":[");
+        for (int solver = 0; solver < telemetryReporter->NumberOfSolvers; solver++)
+        {
+            snapshot = &telemetryReporter->Snapshots[solver];
+
+            fprintf(output, "%s{\"solver\":%d,\"tried\":%s,\"nodesPerSecond\":%.0f,", solver == 0 ? "" : ",", solver, \
+                formatPermutationCount(snapshot->TriedPermutations, triedCount), snapshot->NodesPerSecond);
+            printTelemetryCounters(output, &snapshot->Counters, telemetryReporter->Size);
+            fputc('}', output);
+        }
+        fputc(']', output);
+    }
+
+    fprintf(output, "}\n");
+
+    written = ferror(output) == 0 ? TRUE : FALSE;
+    if (fclose(output) != 0) written = FALSE;
+
+    // Readers never see a partly written snapshot
+    if (written == TRUE) written = replaceFile(newPath, telemetryReporter->File);
+    if (written == FALSE) remove(newPath);
+
+    free(newPath);
+    return written;
+}
+
+// Take and write a snapshot of the solvers of 'telemetryReporter' every interval, until it is stopped
+void runTelemetryReporter(telemetry_reporter *telemetryReporter)
+{
+    double nextSnapshotTime = getWallClockTime() + telemetryReporter->Interval;
+    double currentTime;
+    uint64_t writtenSearches = 0;
+    int writtenSearching = FALSE;
+
+    acquireLock(&telemetryReporter->Lock);
+
+    while (telemetryReporter->Stopping == FALSE)
+    {
+        currentTime = getWallClockTime();
+
+        if (currentTime < nextSnapshotTime)
+        {
+            waitConditionTimeout(&telemetryReporter->Wake, &telemetryReporter->Lock, nextSnapshotTime - currentTime);
+            continue;
+        }
+
+        nextSnapshotTime = currentTime + telemetryReporter->Interval;
+
+        // A running search is snapshotted each interval. Between searches, the file only changes once another search has finished
+        if (telemetryReporter->Searching == TRUE) takeTelemetrySnapshot(telemetryReporter);
+        else if (telemetryReporter->Searches == writtenSearches && writtenSearching == FALSE) continue;
+
+        writeTelemetryFile(telemetryReporter);
+        writtenSearches = telemetryReporter->Searches;
+        writtenSearching = telemetryReporter->Searching;
+    }
+
+    releaseLock(&telemetryReporter->Lock);
+}
@@ -0,0 +1,100 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#include "input_utils.h"
+#include "solver.h"
+#include "thread_utils.h"
+#include "permutation_count.h"
+
+#define DEFAULT_TELEMETRY_INTERVAL 1000 // Milliseconds
+
+typedef struct // Stores the counters and progress of one solver when a telemetry snapshot was taken
+{
+    solver_counters Counters;
+    permutation_count TriedPermutations;
+    double NodesPerSecond; // Nodes entered per second since the previous snapshot
+} solver_snapshot;
+
+
+#ifdef _WIN32 // Windows implementation (reporter thread)
+
+#include <windows.h>
+
+typedef HANDLE telemetry_thread;
+
+
+#elif defined __linux__ // Linux implementation (reporter thread)
+
+#include <pthread.h>
+
+typedef pthread_t telemetry_thread;
+
+
+#else // Standard implementation (no reporter thread, a snapshot is written as each search finishes)
+
+typedef int telemetry_thread;
+
+#endif
+
+struct telemetry_reporter // Publishes snapshots of the counters of a set of solvers to a file from its own thread, so that long searches can be watched from outside the process without the solvers printing
+{
+    const char *File; // Replaced by each snapshot, which is written in full to a temporary file first. Placing it in shared memory (e.g. /dev/shm) avoids any disk writes
+    double Interval; // Seconds between snapshots
+
+    solver *Solvers;
+    int NumberOfSolvers;
+    incumbent *Incumbent;
+
+    // Stores the sequence being searched, or searched last, and the grid width and number of permutations of its search
+    char Sequence[MAX_SEQUENCE_SIZE];
+    int Size;
+    int AllowRotation;
+    int GridWidth;
+    permutation_count Permutations;
+
+    // Stores whether a search is running, the number of searches started, and the wall clock time, as returned by getWallClockTime, at which the current search started and the last snapshot was taken
+    int Searching;
+    uint64_t Searches;
+    double SearchStartTime;
+    double SnapshotTime;
+    int MinStackHeight; // Lowest stack height found by any solver when the snapshot was taken
+    double SearchTime; // Seconds the search had run when the snapshot was taken
+    solver_snapshot *Snapshots; // Stores the last snapshot of each solver. Kept once the search finishes, until the next one starts
+
+    int Stopping; // TRUE once the reporter thread is told to exit
+    solver_lock Lock; // Held while the snapshot or the search being reported on changes
+    solver_condition Wake;
+    telemetry_thread Thread;
+    int ThreadCreated;
+};
+
+// Create a reporter thread running 'telemetryReporter', storing its handle in 'telemetryReporter'. Return TRUE if the thread was created, FALSE otherwise
+int createTelemetryThread(telemetry_reporter *telemetryReporter);
+
+// Block until the reporter thread of 'telemetryReporter' has exited, then free its handle
+void joinTelemetryThread(telemetry_reporter *telemetryReporter);
+
+// Start 'telemetryReporter' publishing snapshots of the counters of the solvers in 'solvers', which share 'incumbent', to the telemetry file set in 'solverSettings'. Return TRUE if it was started, FALSE if it couldn't be allocated
+int startTelemetryReporter(telemetry_reporter *telemetryReporter, solver_settings *solverSettings, solver solvers[], incumbent *incumbent);
+
+// Tell the reporter thread of 'telemetryReporter' to exit, wait for it, write a last snapshot and free the reporter. No search may be running
+void stopTelemetryReporter(telemetry_reporter *telemetryReporter);
+
+// Report on the search of the sequence in 'sequenceParams' in 'telemetryReporter', once its solvers have been initialised and before they start searching
+void beginTelemetrySearch(telemetry_reporter *telemetryReporter, sequence_params *sequenceParams);
+
+// Take the last snapshot of the search being reported on in 'telemetryReporter', once all of its solvers have finished
+void endTelemetrySearch(telemetry_reporter *telemetryReporter);
+
+// Copy the counters of each solver of the search being reported on in 'telemetryReporter' into its snapshot. 'telemetryReporter' must be locked
+void takeTelemetrySnapshot(telemetry_reporter *telemetryReporter);
+
+// Write the snapshot of 'telemetryReporter', which must be locked, to its telemetry file as one JSON object. Return TRUE if it was written, FALSE otherwise
+int writeTelemetryFile(telemetry_reporter *telemetryReporter);
+
+// Take and write a snapshot of the solvers of 'telemetryReporter' every interval, until it is stopped
+void runTelemetryReporter(telemetry_reporter *telemetryReporter);
+
+#endif
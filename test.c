@@ -1,5 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "bool.h"
 #include "test.h"
@@ -12,9 +14,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 {
     {
         {
-            "ZOZS",
-            4,
-            FALSE
+            .Sequence = "ZOZS",
+            .Size = 4,
+            .AllowRotation = FALSE,
+            .GridWidth = 6
         },
             {0, 0, 2, 2},
             {0, 0, 0, 0}
@@ -22,9 +25,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "ZISS",
-            4,
-            TRUE
+            .Sequence = "ZISS",
+            .Size = 4,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
             {4, 0, 2, 0},
             {1, 1, 0, 0}
@@ -32,9 +36,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "SISS",
-            4,
-            FALSE
+            .Sequence = "SISS",
+            .Size = 4,
+            .AllowRotation = FALSE,
+            .GridWidth = 6
         },
             {0, 5, 2, 0},
             {0, 0, 0, 0}
@@ -42,9 +47,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "LLLL",
-            4,
-            TRUE
+            .Sequence = "LLLL",
+            .Size = 4,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
             {0, 3, 1, 4},
             {0, 0, 2, 2}        
@@ -52,9 +58,10 @@ testcase testCases[NUMBER_OF_TESTS] =
     
     {
         {
-            "IIIIII",
-            6,
-            FALSE
+            .Sequence = "IIIIII",
+            .Size = 6,
+            .AllowRotation = FALSE,
+            .GridWidth = 6
         },
             {0, 1, 2, 3, 4, 5},
             {0, 0, 0, 0, 0, 0}        
@@ -62,9 +69,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "JSLITTLL",
-            8,
-            FALSE
+            .Sequence = "JSLITTLL",
+            .Size = 8,
+            .AllowRotation = FALSE,
+            .GridWidth = 6
         },
             {3, 1, 0, 5, 0, 0, 3, 4},
             {0, 0, 0, 0, 0, 0, 0, 0}        
@@ -72,9 +80,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "IOTSLJZI",
-            8,
-            TRUE
+            .Sequence = "IOTSLJZI",
+            .Size = 8,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
             {0, 1, 0, 3, 3, 4, 3, 0},
             {0, 0, 0, 0, 3, 0, 1, 1}        
@@ -82,9 +91,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "TTTTTTTT",
-            8,
-            TRUE
+            .Sequence = "TTTTTTTT",
+            .Size = 8,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
             {0, 0, 0, 3, 3, 2, 4, 3},
             {0, 2, 1, 2, 1, 1, 3, 0}        
@@ -92,9 +102,10 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "IOTIOTIO",
-            8,
-            TRUE
+            .Sequence = "IOTIOTIO",
+            .Size = 8,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
             {0, 1, 0, 5, 3, 3, 0, 4},
             {0, 0, 0, 0, 0, 1, 1, 0}        
@@ -102,64 +113,124 @@ testcase testCases[NUMBER_OF_TESTS] =
 
     {
         {
-            "LLLLLLLL",
-            8,
-            TRUE
+            .Sequence = "LLLLLLLL",
+            .Size = 8,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
         },
 	        {0, 0, 2, 3, 4, 2, 4, 1},
  	        {0, 0, 0, 0, 2, 3, 2, 3}  
+    },
+
+    {
+        {
+            .Sequence = "LJTIZSO",
+            .Size = 7,
+            .AllowRotation = TRUE,
+            .GridWidth = 4
+        },
+            {2, 0, 2, 0, 1, 2, 0},
+            {0, 0, 3, 0, 1, 1, 0}
+    },
+
+    {
+        {
+            .Sequence = "SZSZTIL",
+            .Size = 7,
+            .AllowRotation = TRUE,
+            .GridWidth = 10
+        },
+            {0, 3, 6, 4, 1, 9, 6},
+            {0, 0, 0, 0, 2, 0, 1}
+    },
+
+    {
+        {
+            .Sequence = "SSISLZTZSTITJOJISST",
+            .Size = 19,
+            .AllowRotation = TRUE,
+            .GridWidth = 6
+        },
+            {3, 0, 2, 0, 3, 2, 0, 0, 3, 0, 5, 4, 2, 2, 2, 5, 3, 0, 1},
+            {0, 1, 0, 1, 3, 0, 3, 1, 1, 1, 0, 1, 2, 0, 1, 0, 0, 1, 0}
     }
 };
 
 // Solve the sequence in 'testSequenceParams', display the solution, and return the solver holding the solution
-solver *solveTestCaseSequence(sequence_params *testSequenceParams, solver solvers[NUMBER_OF_SOLVERS])
+solver *solveTestCaseSequence(sequence_params *testSequenceParams, solver solvers[], solver_settings *solverSettings, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable)
 {
     solver *bestSolver;
 
     time_t startTime;
     time(&startTime);
 
-    if (initialiseSolvers(solvers, testSequenceParams) == OVERFLOW_DETECTED) return NULL;
-    runSolvers(solvers, testSequenceParams);                
+    bestSolver = searchSequence(solvers, solverSettings, NULL, incumbent, workQueue, transpositionTable, testSequenceParams, NULL);
 
-    bestSolver = getBestSolver(solvers);
-    printSolution(bestSolver, testSequenceParams, startTime);
+    printSolution(bestSolver, testSequenceParams, startTime, bestSolver->MinStackHeight);
 
     return bestSolver;
 }
 
-// Validate the solving routines of the program by comparing its solutions for the test cases to the known solutions in test.h
-void runTests()
+// Drop the sequence in 'sequenceParams' into an empty grid using 'pieceColumns' and 'pieceRotations', and return the height of the resulting stack. Return -1 if a piece is dropped outside of the grid
+int getTestPermutationStackHeight(sequence_params *sequenceParams, int pieceColumns[], int pieceRotations[])
 {
-    if (GRID_WIDTH != TEST_GRID_WIDTH) 
-        printf("GRID_WIDTH is different from TEST_GRID_WIDTH i.e. the width of the grid used when computing the test cases. Can't run tests!\n\n");
+    char grid[GRID_HEIGHT][MAX_GRID_WIDTH];
+    skyline gridSkyline = EMPTY_SKYLINE;
+    tetromino *tet;
+
+    memset(grid, '_', sizeof(grid));
+
+    for (int piece = 0; piece < sequenceParams->Size; piece++)
+    {
+        if (pieceRotations[piece] < 0 || pieceRotations[piece] >= getRotations(sequenceParams->Sequence[piece])) return -1;
+        tet = getTetromino(sequenceParams->Sequence[piece], pieceRotations[piece]);
 
-    else if (MAX_SEQUENCE_SIZE < MAX_TEST_SEQUENCE_LENGTH)
+        if (pieceColumns[piece] < 0 || pieceColumns[piece] > sequenceParams->GridWidth - tet->Width) return -1;
+        if (dropTetrominoToGrid(tet, pieceColumns[piece], grid, &gridSkyline) == FALSE) return -1;
+    }
+
+    return getStackHeight(gridSkyline);
+}
+
+// Validate the solving routines of the program by comparing its solutions for the test cases to the known solutions in test.h, using the solvers set in 'solverSettings'
+void runTests(solver_settings *solverSettings)
+{
+    if (MAX_SEQUENCE_SIZE < MAX_TEST_SEQUENCE_LENGTH)
         printf("MAX_SEQUENCE_SIZE is less than some test sequences (MAX_TEST_SEQUENCE_SIZE), can't run tests!\n\n");
 
     else 
     {
-        solver solvers[NUMBER_OF_SOLVERS];
+        solver *solvers = malloc(sizeof(solver) * solverSettings->NumberOfSolvers);
         solver *bestSolver;
+        incumbent incumbent;
+        work_queue workQueue;
+        transposition_table transpositionTable; // Shared by all test cases, as each one starts a new generation of entries
+        int expectedStackHeight;
 
         int passedTests = 0;
         int failedTests = 0;
 
+        if (solvers == NULL || createTranspositionTable(&transpositionTable, solverSettings->TranspositionTableMegabytes) == FALSE)
+        {
+            printf("Could not allocate the solvers and transposition table, can't run tests!\n\n");
+            free(solvers);
+            return;
+        }
+
         printf("Running tests...\n");
 
         for (int test = 0; test < NUMBER_OF_TESTS; test++)
         {        
-            printf("Test: %d\nSequence: %.*s\nRotation: %s\nSolving...\n\n", \
-            test, testCases[test].SequenceParams.Size, testCases[test].SequenceParams.Sequence, testCases[test].SequenceParams.AllowRotation == TRUE ? "Y" : "N");
-
-            bestSolver = solveTestCaseSequence(&testCases[test].SequenceParams, solvers);
+            printf("Test: %d\nSequence: %.*s\nRotation: %s\nGrid width: %d\nSolving...\n\n", \
+            test, testCases[test].SequenceParams.Size, testCases[test].SequenceParams.Sequence, testCases[test].SequenceParams.AllowRotation == TRUE ? "Y" : "N", testCases[test].SequenceParams.GridWidth);
 
-            // Test failed due to overflow
-            if (bestSolver == NULL) failedTests++; 
+            bestSolver = solveTestCaseSequence(&testCases[test].SequenceParams, solvers, solverSettings, &incumbent, &workQueue, &transpositionTable);
+            expectedStackHeight = getTestPermutationStackHeight(&testCases[test].SequenceParams, testCases[test].PieceColumns, testCases[test].PieceRotations);
 
-            // Test passed
-            else if (memcmp(testCases[test].PieceColumns, bestSolver->BestPieceColumns, sizeof(testCases[test].PieceColumns)) == 0 && \
-                memcmp(testCases[test].PieceRotations, bestSolver->BestPieceRotations, sizeof(testCases[test].PieceRotations)) == 0)
+            // Test passed. Solvers share their best stack height, so whichever solver first finds a minimal stack prunes the others' equally good permutations. 
+            // The solution may therefore be a different permutation from the testcase solution, but it must stack to the same height
+            if (bestSolver->MinStackHeight == expectedStackHeight && \
+                getTestPermutationStackHeight(&testCases[test].SequenceParams, bestSolver->BestPieceColumns, bestSolver->BestPieceRotations) == expectedStackHeight)
             {
                 printf("Test %d: PASSED\n\n", test);
                 passedTests++;
@@ -168,7 +239,7 @@ void runTests()
             // Test failed due to incorrect solution
             else 
             {
-                printf("Expected permutation: ");
+                printf("Expected stack height: %d\nExpected permutation: ", expectedStackHeight);
                 for (int piece = 0; piece < testCases[test].SequenceParams.Size; piece++)
                     printf("%c:%d(%d) ", testCases[test].SequenceParams.Sequence[piece], testCases[test].PieceColumns[piece], testCases[test].PieceRotations[piece]*90);
                 printf("\n\n");              
@@ -179,5 +250,7 @@ void runTests()
         }
 
         printf("PASSED %d test(s), FAILED %d test(s)\n\n", passedTests, failedTests);   
+        destroyTranspositionTable(&transpositionTable);
+        free(solvers);
     }
 }
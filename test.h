@@ -3,10 +3,9 @@
 
 #include "solver.h"
 
-#define NUMBER_OF_TESTS 10
+#define NUMBER_OF_TESTS 13
 
-#define TEST_GRID_WIDTH 6 // The grid width for which the test solutions were generated
-#define MAX_TEST_SEQUENCE_LENGTH 8 // Maximum length of the sequences used in the test cases
+#define MAX_TEST_SEQUENCE_LENGTH 19 // Maximum length of the sequences used in the test cases
 
 typedef struct
 {
@@ -16,9 +15,12 @@ typedef struct
 } testcase;
 
 // Solve the sequence in 'testSequenceParams', display the solution, and return the solver holding the solution
-solver *solveTestCaseSequence(sequence_params *testSequenceParams, solver solvers[NUMBER_OF_SOLVERS]);
+solver *solveTestCaseSequence(sequence_params *testSequenceParams, solver solvers[], solver_settings *solverSettings, incumbent *incumbent, work_queue *workQueue, transposition_table *transpositionTable);
 
-// Validate the solving routines of the program by comparing its solutions of the test cases to the known solutions in test.h
-void runTests();
+// Drop the sequence in 'sequenceParams' into an empty grid using 'pieceColumns' and 'pieceRotations', and return the height of the resulting stack. Return -1 if a piece is dropped outside of the grid
+int getTestPermutationStackHeight(sequence_params *sequenceParams, int pieceColumns[], int pieceRotations[]);
+
+// Validate the solving routines of the program by comparing its solutions of the test cases to the known solutions in test.h, using the solvers set in 'solverSettings'
+void runTests(solver_settings *solverSettings);
 
 #endif
\ No newline at end of file
@@ -164,3 +164,50 @@ int getRotations(char tet)
     }
     return FALSE;
 }
+
+// Return the tetromino whose rotations are the mirror images of the rotations of 'tet' i.e. L and J, S and Z. I, O and T are their own mirror images
+char getMirrorTetromino(char tet)
+{
+    switch (tet)
+    {
+        case 'J':
+            return 'L';
+        case 'L':
+            return 'J';
+        case 'S':
+            return 'Z';
+        case 'Z':
+            return 'S';
+    }
+    return tet;
+}
+
+// Return the index of the rotation of the mirror tetromino of 'tet' which is the mirror image of rotation 'rotation' of 'tet'. Return NO_MIRROR_ROTATION if there is none
+int getMirrorRotation(char tet, int rotation)
+{
+    char mirrorTet = getMirrorTetromino(tet);
+    tetromino *rotatedTet = getTetromino(tet, rotation);
+    tetromino *mirrorRotatedTet;
+    int isMirrorImage;
+
+    for (int mirrorRotation = 0; mirrorRotation < getRotations(mirrorTet); mirrorRotation++)
+    {
+        mirrorRotatedTet = getTetromino(mirrorTet, mirrorRotation);
+        if (mirrorRotatedTet->Width != rotatedTet->Width || mirrorRotatedTet->Height != rotatedTet->Height) continue;
+
+        // Patterns are aligned to their bottom left corner, so column 'tetCol' is reflected onto column Width - 1 - 'tetCol'
+        isMirrorImage = TRUE;
+        for (int tetRow = 0; tetRow < 4; tetRow++)
+        {
+            for (int tetCol = 0; tetCol < rotatedTet->Width; tetCol++)
+            {
+                if ((rotatedTet->Pattern[tetRow][tetCol] == '_') != (mirrorRotatedTet->Pattern[tetRow][rotatedTet->Width - 1 - tetCol] == '_'))
+                    isMirrorImage = FALSE;
+            }
+        }
+
+        if (isMirrorImage == TRUE) return mirrorRotation;
+    }
+
+    return NO_MIRROR_ROTATION;
+}
@@ -8,6 +8,8 @@
 #define ROTATION_180_ACW 2
 #define ROTATION_270_ACW 3
 
+#define NO_MIRROR_ROTATION -1
+
 typedef struct
 {
     char Pattern[4][4];
@@ -16,13 +18,13 @@ typedef struct
     int Height;
 } tetromino;
 
-tetromino tet_I[2];
-tetromino tet_O[1];
-tetromino tet_T[4];
-tetromino tet_J[4];
-tetromino tet_L[4];
-tetromino tet_S[2];
-tetromino tet_Z[2];
+extern tetromino tet_I[2];
+extern tetromino tet_O[1];
+extern tetromino tet_T[4];
+extern tetromino tet_J[4];
+extern tetromino tet_L[4];
+extern tetromino tet_S[2];
+extern tetromino tet_Z[2];
 
 // Return 'rotation' orientation of the tetromino struct for 'tet'. Return FALSE if 'tet' is not a valid tetromino
 tetromino *getTetromino(char tet, int rotation);
@@ -30,4 +32,10 @@ tetromino *getTetromino(char tet, int rotation);
 // Return the number ways the tetromino for 'tet' can be rotated. Return FALSE if 'tet' is not a valid tetromino
 int getRotations(char tet);
 
+// Return the tetromino whose rotations are the mirror images of the rotations of 'tet' i.e. L and J, S and Z. I, O and T are their own mirror images
+char getMirrorTetromino(char tet);
+
+// Return the index of the rotation of the mirror tetromino of 'tet' which is the mirror image of rotation 'rotation' of 'tet'. Return NO_MIRROR_ROTATION if there is none
+int getMirrorRotation(char tet, int rotation);
+
 #endif
\ No newline at end of file
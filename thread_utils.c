@@ -0,0 +1,355 @@
+#ifdef __linux__
+#define _GNU_SOURCE // Required for the CPU affinity routines
+#endif
+
+#include "bool.h"
+#include "thread_utils.h"
+
+// Atomically lower the int at 'value' to 'newValue' if 'newValue' is less than it. Return TRUE if 'value' was lowered, FALSE otherwise
+int atomicLowerInt(volatile int *value, int newValue)
+{
+    int currentValue = ATOMIC_LOAD_INT(value);
+    int previousValue;
+
+    while (newValue < currentValue)
+    {
+        previousValue = ATOMIC_COMPARE_EXCHANGE_INT(value, currentValue, newValue);
+
+        if (previousValue == currentValue) return TRUE;
+        currentValue = previousValue; // Another thread changed 'value' since it was read, try again against its new value
+    }
+
+    return FALSE;
+}
+
+
+#ifdef _WIN32 // Windows implementation (multi-threaded)
+
+// Initialise 'lock' before it is first acquired
+void initialiseLock(solver_lock *lock)
+{
+    InitializeCriticalSection(lock);
+}
+
+// Block until 'lock' is acquired by the calling thread
+void acquireLock(solver_lock *lock)
+{
+    EnterCriticalSection(lock);
+}
+
+// Release 'lock', which must be held by the calling thread
+void releaseLock(solver_lock *lock)
+{
+    LeaveCriticalSection(lock);
+}
+
+// Free the resources held by 'lock'. 'lock' must not be held by any thread
+void destroyLock(solver_lock *lock)
+{
+    DeleteCriticalSection(lock);
+}
+
+// Initialise 'condition' before it is first waited on
+void initialiseCondition(solver_condition *condition)
+{
+    InitializeConditionVariable(condition);
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled, then acquire 'lock' again. May return without a signal, so the caller must check what it is waiting for again
+void waitCondition(solver_condition *condition, solver_lock *lock)
+{
+    SleepConditionVariableCS(condition, lock, INFINITE);
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled or 'seconds' seconds have passed, then acquire 'lock' again. May return early, so the caller must check what it is waiting for again
+void waitConditionTimeout(solver_condition *condition, solver_lock *lock, double seconds)
+{
+    SleepConditionVariableCS(condition, lock, (DWORD) (seconds * 1000));
+}
+
+// Wake all threads waiting on 'condition'
+void signalCondition(solver_condition *condition)
+{
+    WakeAllConditionVariable(condition);
+}
+
+// Free the resources held by 'condition'. No thread may be waiting on 'condition'
+void destroyCondition(solver_condition *condition)
+{
+    // Windows condition variables hold no resources
+    (void) condition;
+}
+
+// Give up the rest of the calling thread's time slice to other threads
+void yieldThread()
+{
+    SwitchToThread();
+}
+
+// Return the number of CPUs the process is allowed to run on, e.g. inside a container or under taskset
+int getAllowedCpuCount()
+{
+    DWORD_PTR processAffinityMask;
+    DWORD_PTR systemAffinityMask;
+    int allowedCpus = 0;
+
+    // An unrestricted process may run on every processor group, which its affinity mask doesn't cover
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processAffinityMask, &systemAffinityMask) == FALSE || processAffinityMask == systemAffinityMask)
+        return (int) GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+
+    for (int bit = 0; bit < (int) sizeof(DWORD_PTR) * 8; bit++)
+        if (processAffinityMask & ((DWORD_PTR) 1 << bit)) allowedCpus++;
+
+    return allowedCpus < 1 ? 1 : allowedCpus;
+}
+
+// Pin the calling thread to the 'cpu'th CPU the process is allowed to run on, wrapping around if there are fewer CPUs. Return TRUE if the thread was pinned, FALSE otherwise
+int pinCurrentThread(int cpu)
+{
+    DWORD_PTR processAffinityMask;
+    DWORD_PTR systemAffinityMask;
+    int allowedCpus = 0;
+
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processAffinityMask, &systemAffinityMask) == FALSE) return FALSE;
+
+    for (int bit = 0; bit < (int) sizeof(DWORD_PTR) * 8; bit++)
+        if (processAffinityMask & ((DWORD_PTR) 1 << bit)) allowedCpus++;
+    if (allowedCpus == 0) return FALSE;
+
+    cpu %= allowedCpus;
+
+    for (int bit = 0; bit < (int) sizeof(DWORD_PTR) * 8; bit++)
+    {
+        if ((processAffinityMask & ((DWORD_PTR) 1 << bit)) && cpu-- == 0)
+            return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << bit) != 0;
+    }
+
+    return FALSE;
+}
+
+
+// Return the time in seconds since an arbitrary point, from a clock which is not affected by changes to the system time
+double getWallClockTime()
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+
+#elif defined __linux__ // Linux implementation (multi-threaded)
+
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+
+// Initialise 'lock' before it is first acquired
+void initialiseLock(solver_lock *lock)
+{
+    pthread_mutex_init(lock, NULL);
+}
+
+// Block until 'lock' is acquired by the calling thread
+void acquireLock(solver_lock *lock)
+{
+    pthread_mutex_lock(lock);
+}
+
+// Release 'lock', which must be held by the calling thread
+void releaseLock(solver_lock *lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
+// Free the resources held by 'lock'. 'lock' must not be held by any thread
+void destroyLock(solver_lock *lock)
+{
+    pthread_mutex_destroy(lock);
+}
+
+// Initialise 'condition' before it is first waited on
+void initialiseCondition(solver_condition *condition)
+{
+    pthread_cond_init(condition, NULL);
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled, then acquire 'lock' again. May return without a signal, so the caller must check what it is waiting for again
+void waitCondition(solver_condition *condition, solver_lock *lock)
+{
+    pthread_cond_wait(condition, lock);
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled or 'seconds' seconds have passed, then acquire 'lock' again. May return early, so the caller must check what it is waiting for again
+void waitConditionTimeout(solver_condition *condition, solver_lock *lock, double seconds)
+{
+    struct timespec deadline;
+
+    // Condition variables time out against the system clock by default
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t) seconds;
+    deadline.tv_nsec += (long) ((seconds - (double) (time_t) seconds) * 1e9);
+
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_cond_timedwait(condition, lock, &deadline);
+}
+
+// Wake all threads waiting on 'condition'
+void signalCondition(solver_condition *condition)
+{
+    pthread_cond_broadcast(condition);
+}
+
+// Free the resources held by 'condition'. No thread may be waiting on 'condition'
+void destroyCondition(solver_condition *condition)
+{
+    pthread_cond_destroy(condition);
+}
+
+// Give up the rest of the calling thread's time slice to other threads
+void yieldThread()
+{
+    sched_yield();
+}
+
+// Return the number of CPUs the process is allowed to run on, e.g. inside a container or under taskset
+int getAllowedCpuCount()
+{
+    cpu_set_t allowedCpus;
+    long onlineCpus;
+
+    // The same CPUs solver threads are pinned to, so that no two threads are pinned to one CPU by default
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) == 0 && CPU_COUNT(&allowedCpus) > 0) return CPU_COUNT(&allowedCpus);
+
+    onlineCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return onlineCpus < 1 ? 1 : (int) onlineCpus;
+}
+
+// Pin the calling thread to the 'cpu'th CPU the process is allowed to run on, wrapping around if there are fewer CPUs. Return TRUE if the thread was pinned, FALSE otherwise
+int pinCurrentThread(int cpu)
+{
+    cpu_set_t allowedCpus;
+    cpu_set_t pinnedCpu;
+
+    // Only use the CPUs the process may run on, e.g. inside a container or under taskset
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0 || CPU_COUNT(&allowedCpus) == 0) return FALSE;
+
+    cpu %= CPU_COUNT(&allowedCpus);
+
+    for (int allowedCpu = 0; allowedCpu < CPU_SETSIZE; allowedCpu++)
+    {
+        if (CPU_ISSET(allowedCpu, &allowedCpus) && cpu-- == 0)
+        {
+            CPU_ZERO(&pinnedCpu);
+            CPU_SET(allowedCpu, &pinnedCpu);
+            return pthread_setaffinity_np(pthread_self(), sizeof(pinnedCpu), &pinnedCpu) == 0;
+        }
+    }
+
+    return FALSE;
+}
+
+
+// Return the time in seconds since an arbitrary point, from a clock which is not affected by changes to the system time
+double getWallClockTime()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+#else // Standard implementation (single-threaded)
+
+#include <time.h>
+
+// Initialise 'lock' before it is first acquired
+void initialiseLock(solver_lock *lock)
+{
+    *lock = FALSE;
+}
+
+// Block until 'lock' is acquired by the calling thread
+void acquireLock(solver_lock *lock)
+{
+    *lock = TRUE;
+}
+
+// Release 'lock', which must be held by the calling thread
+void releaseLock(solver_lock *lock)
+{
+    *lock = FALSE;
+}
+
+// Free the resources held by 'lock'. 'lock' must not be held by any thread
+void destroyLock(solver_lock *lock)
+{
+    *lock = FALSE;
+}
+
+// Initialise 'condition' before it is first waited on
+void initialiseCondition(solver_condition *condition)
+{
+    *condition = FALSE;
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled, then acquire 'lock' again. May return without a signal, so the caller must check what it is waiting for again
+void waitCondition(solver_condition *condition, solver_lock *lock)
+{
+    // Only one thread runs, so there is never another thread to wait for
+    (void) condition;
+    (void) lock;
+}
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled or 'seconds' seconds have passed, then acquire 'lock' again. May return early, so the caller must check what it is waiting for again
+void waitConditionTimeout(solver_condition *condition, solver_lock *lock, double seconds)
+{
+    // Only one thread runs, so there is never another thread to wait for
+    (void) condition;
+    (void) lock;
+    (void) seconds;
+}
+
+// Wake all threads waiting on 'condition'
+void signalCondition(solver_condition *condition)
+{
+    (void) condition;
+}
+
+// Free the resources held by 'condition'. No thread may be waiting on 'condition'
+void destroyCondition(solver_condition *condition)
+{
+    *condition = FALSE;
+}
+
+// Give up the rest of the calling thread's time slice to other threads
+void yieldThread()
+{
+}
+
+// Return the number of CPUs the process is allowed to run on, e.g. inside a container or under taskset
+int getAllowedCpuCount()
+{
+    return 1;
+}
+
+// Pin the calling thread to the 'cpu'th CPU the process is allowed to run on, wrapping around if there are fewer CPUs. Return TRUE if the thread was pinned, FALSE otherwise
+int pinCurrentThread(int cpu)
+{
+    (void) cpu;
+    return FALSE;
+}
+
+// Return the time in seconds since an arbitrary point. Only the main thread runs, so its processor time stands in for the elapsed time
+double getWallClockTime()
+{
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef THREAD_UTILS_H
+#define THREAD_UTILS_H
+
+#include <stdint.h>
+
+#ifdef _WIN32 // Windows implementation (multi-threaded)
+
+#include <windows.h>
+
+typedef CRITICAL_SECTION solver_lock;
+typedef CONDITION_VARIABLE solver_condition;
+
+// Atomically read the int at 'value'. Aligned 32-bit reads are atomic on Windows targets
+#define ATOMIC_LOAD_INT(value) (*(volatile LONG *) (value))
+
+// Atomically set the int at 'value' to 'newValue' if it equals 'expectedValue'. Evaluate to the value held before the exchange
+#define ATOMIC_COMPARE_EXCHANGE_INT(value, expectedValue, newValue) \
+    ((int) InterlockedCompareExchange((volatile LONG *) (value), (LONG) (newValue), (LONG) (expectedValue)))
+
+// Atomically add 'amount' to the 64-bit unsigned int at 'value'. Evaluate to the sum
+#define ATOMIC_ADD_UINT64(value, amount) \
+    ((uint64_t) InterlockedExchangeAdd64((volatile LONG64 *) (value), (LONG64) (amount)) + (uint64_t) (amount))
+
+
+#elif defined __linux__ // Linux implementation (multi-threaded)
+
+#include <pthread.h>
+
+typedef pthread_mutex_t solver_lock;
+typedef pthread_cond_t solver_condition;
+
+#define ATOMIC_LOAD_INT(value) __atomic_load_n((value), __ATOMIC_RELAXED)
+
+#define ATOMIC_COMPARE_EXCHANGE_INT(value, expectedValue, newValue) \
+    __sync_val_compare_and_swap((value), (expectedValue), (newValue))
+
+#define ATOMIC_ADD_UINT64(value, amount) __atomic_add_fetch((value), (uint64_t) (amount), __ATOMIC_RELAXED)
+
+
+#else // Standard implementation (single-threaded)
+
+typedef int solver_lock;
+typedef int solver_condition;
+
+#define ATOMIC_LOAD_INT(value) (*(value))
+
+#define ATOMIC_COMPARE_EXCHANGE_INT(value, expectedValue, newValue) \
+    (*(value) == (expectedValue) ? (*(value) = (newValue), (expectedValue)) : *(value))
+
+#define ATOMIC_ADD_UINT64(value, amount) (*(value) += (uint64_t) (amount))
+
+#endif
+
+#define CACHE_LINE_SIZE 64 // Bytes in a cache line on the targeted CPUs. Data written by different threads is kept this far apart, so that one thread's writes don't evict the cache lines another is using
+
+// Atomically lower the int at 'value' to 'newValue' if 'newValue' is less than it. Return TRUE if 'value' was lowered, FALSE otherwise
+int atomicLowerInt(volatile int *value, int newValue);
+
+// Initialise 'lock' before it is first acquired
+void initialiseLock(solver_lock *lock);
+
+// Block until 'lock' is acquired by the calling thread
+void acquireLock(solver_lock *lock);
+
+// Release 'lock', which must be held by the calling thread
+void releaseLock(solver_lock *lock);
+
+// Free the resources held by 'lock'. 'lock' must not be held by any thread
+void destroyLock(solver_lock *lock);
+
+// Initialise 'condition' before it is first waited on
+void initialiseCondition(solver_condition *condition);
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled, then acquire 'lock' again. May return without a signal, so the caller must check what it is waiting for again
+void waitCondition(solver_condition *condition, solver_lock *lock);
+
+// Release 'lock', which must be held by the calling thread, and block until 'condition' is signalled or 'seconds' seconds have passed, then acquire 'lock' again. May return early, so the caller must check what it is waiting for again
+void waitConditionTimeout(solver_condition *condition, solver_lock *lock, double seconds);
+
+// Wake all threads waiting on 'condition'
+void signalCondition(solver_condition *condition);
+
+// Free the resources held by 'condition'. No thread may be waiting on 'condition'
+void destroyCondition(solver_condition *condition);
+
+// Give up the rest of the calling thread's time slice to other threads
+void yieldThread();
+
+// Return the number of CPUs the process is allowed to run on, e.g. inside a container or under taskset
+int getAllowedCpuCount();
+
+// Pin the calling thread to the 'cpu'th CPU the process is allowed to run on, wrapping around if there are fewer CPUs. Return TRUE if the thread was pinned, FALSE otherwise
+int pinCurrentThread(int cpu);
+
+// Return the time in seconds since an arbitrary point, from a clock which is not affected by changes to the system time
+double getWallClockTime();
+
+#endif
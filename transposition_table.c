@@ -0,0 +1,125 @@
+#include <stdlib.h>
+
+#include "bool.h"
+#include "transposition_table.h"
+#include "skyline.h"
+
+// Allocate the entries of 'transpositionTable' in at most 'megabytes' megabytes. A size of 0 disables the table. Return TRUE if the table was allocated or disabled, FALSE if it could not be allocated
+int createTranspositionTable(transposition_table *transpositionTable, int megabytes)
+{
+    uint64_t buckets = 1;
+    uint64_t maxBuckets = ((uint64_t) megabytes << 20) / (sizeof(transposition_entry) * TRANSPOSITION_BUCKET_SIZE);
+
+    transpositionTable->Entries = NULL;
+    transpositionTable->BucketMask = 0;
+    transpositionTable->Generation = 0;
+
+    if (maxBuckets == 0) return TRUE;
+    while (buckets * 2 <= maxBuckets) buckets *= 2;
+
+    // Zeroed entries belong to generation 0, which is never current
+    transpositionTable->Entries = calloc(buckets * TRANSPOSITION_BUCKET_SIZE, sizeof(transposition_entry));
+    if (transpositionTable->Entries == NULL) return FALSE;
+
+    transpositionTable->BucketMask = buckets - 1;
+    return TRUE;
+}
+
+// Free the entries of 'transpositionTable'
+void destroyTranspositionTable(transposition_table *transpositionTable)
+{
+    free(transpositionTable->Entries);
+    transpositionTable->Entries = NULL;
+}
+
+// Invalidate every entry of 'transpositionTable' before solving a new sequence
+void clearTranspositionTable(transposition_table *transpositionTable)
+{
+    transpositionTable->Generation++;
+}
+
+// Return 'bits' mixed so that every bit of the result depends on every bit of 'bits'. A bijection which maps 0 to 0
+uint64_t mixTranspositionKey(uint64_t bits)
+{
+    bits *= 0xD6E8FEB86659FD93;
+    return bits ^ bits >> 32;
+}
+
+// Return the first entry of the bucket holding the node at depth 'depth' with the normalised skyline 'normalisedSkyline'
+transposition_entry *getTranspositionBucket(transposition_table *transpositionTable, int depth, skyline normalisedSkyline)
+{
+    uint64_t hash = (getLowSkylineBits(normalisedSkyline) ^ (getHighSkylineBits(normalisedSkyline) * 0x94D049BB133111EB) ^ ((uint64_t) depth * 0x9E3779B97F4A7C15)) * 0xBF58476D1CE4E5B9;
+
+    hash ^= hash >> 31;
+    return &transpositionTable->Entries[(hash & transpositionTable->BucketMask) * TRANSPOSITION_BUCKET_SIZE];
+}
+
+// Return the bound stored in 'transpositionTable' for the node at depth 'depth' with the normalised skyline 'normalisedSkyline', or NO_TRANSPOSITION_BOUND if none is stored
+int probeTranspositionTable(transposition_table *transpositionTable, int depth, skyline normalisedSkyline)
+{
+    transposition_entry *bucket;
+    uint64_t data;
+    uint64_t entryData = (uint64_t) depth << 8 | transpositionTable->Generation << 32;
+    uint64_t highBits = getHighSkylineBits(normalisedSkyline);
+    // Each check word holds one half of the skyline mixed with the other half, so that check words of entries stored for different skylines don't combine into the key of a third skyline
+    uint64_t keyCheck = getLowSkylineBits(normalisedSkyline) ^ mixTranspositionKey(highBits);
+    uint64_t keyCheckHigh = highBits ^ mixTranspositionKey(getLowSkylineBits(normalisedSkyline));
+
+    if (transpositionTable->Entries == NULL) return NO_TRANSPOSITION_BOUND;
+    bucket = getTranspositionBucket(transpositionTable, depth, normalisedSkyline);
+
+    for (int entry = 0; entry < TRANSPOSITION_BUCKET_SIZE; entry++)
+    {
+        data = bucket[entry].Data;
+
+        // Only the bound may differ between the entry and the node, and the key check fails if the entry was torn. A torn entry combining check words of stores of two other skylines with the same depth, generation and bound only passes if both
+        // their mixed halves collide with those of the node's skyline, which for distinct skylines is a 64-bit hash collision in each word
+        if ((data & ~(uint64_t) 0xFF) == entryData && (bucket[entry].KeyCheck ^ data) == keyCheck && (bucket[entry].KeyCheckHigh ^ data) == keyCheckHigh)
+            return (int) (data & 0xFF);
+    }
+
+    return NO_TRANSPOSITION_BOUND;
+}
+
+// Store 'bound' in 'transpositionTable' for the node at depth 'depth' with the normalised skyline 'normalisedSkyline'
+void storeTranspositionBound(transposition_table *transpositionTable, int depth, skyline normalisedSkyline, int bound)
+{
+    transposition_entry *bucket;
+    transposition_entry *replacedEntry;
+    uint64_t data;
+    uint64_t entryData = (uint64_t) depth << 8 | transpositionTable->Generation << 32;
+    uint64_t highBits = getHighSkylineBits(normalisedSkyline);
+    // Each check word holds one half of the skyline mixed with the other half, so that check words of entries stored for different skylines don't combine into the key of a third skyline
+    uint64_t keyCheck = getLowSkylineBits(normalisedSkyline) ^ mixTranspositionKey(highBits);
+    uint64_t keyCheckHigh = highBits ^ mixTranspositionKey(getLowSkylineBits(normalisedSkyline));
+
+    if (transpositionTable->Entries == NULL) return;
+    if (bound > 0xFF) bound = 0xFF;
+    bucket = getTranspositionBucket(transpositionTable, depth, normalisedSkyline);
+
+    // Keep the shallowest node in the first entry as it prunes the largest subtree. Any other node replaces the second entry
+    replacedEntry = &bucket[TRANSPOSITION_BUCKET_SIZE - 1];
+    for (int entry = 0; entry < TRANSPOSITION_BUCKET_SIZE; entry++)
+    {
+        data = bucket[entry].Data;
+
+        if ((data & ~(uint64_t) 0xFF) == entryData && (bucket[entry].KeyCheck ^ data) == keyCheck && (bucket[entry].KeyCheckHigh ^ data) == keyCheckHigh)
+        {
+            // Both bounds hold, keep the tighter one
+            if ((int) (data & 0xFF) >= bound) return;
+            replacedEntry = &bucket[entry];
+            break;
+        }
+
+        if (entry == 0 && ((data >> 32) != transpositionTable->Generation || (int) ((data >> 8) & MAX_TRANSPOSITION_DEPTH) >= depth))
+        {
+            replacedEntry = &bucket[entry];
+            break;
+        }
+    }
+
+    data = entryData | (uint64_t) bound;
+    replacedEntry->Data = data;
+    replacedEntry->KeyCheck = keyCheck ^ data;
+    replacedEntry->KeyCheckHigh = keyCheckHigh ^ data;
+}
@@ -0,0 +1,47 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <stdint.h>
+
+#include "skyline.h"
+
+#define DEFAULT_TRANSPOSITION_TABLE_MEGABYTES 64
+#define MAX_TRANSPOSITION_TABLE_MEGABYTES 65536
+#define TRANSPOSITION_BUCKET_SIZE 2 // Entries per bucket. The first entry keeps the shallowest node stored in the bucket, the second is always replaced
+#define TRANSPOSITION_MIN_REMAINING_PIECES 2 // Nodes with fewer pieces left to drop are cheaper to search than to look up
+#define NO_TRANSPOSITION_BOUND -1
+#define MAX_TRANSPOSITION_DEPTH 0xFFFFFF // Deepest node an entry can be stored for. Depths of nodes in a stream of pieces count every piece dropped since the table was cleared
+
+typedef struct // Stores the bound of one search tree node. Written and read by all solvers without locks: 'KeyCheck' and 'KeyCheckHigh' hold the low and high 64 bits of the node's normalised skyline, each XORed with a mix of the other half and with 'Data', so an entry torn by two solvers writing at once fails the key check and is ignored
+{
+    volatile uint64_t KeyCheck;
+    volatile uint64_t KeyCheckHigh; // Only skylines of grids wider than MAX_NARROW_SKYLINE_COLUMNS have high bits
+    // Bits 0-7: lower bound on the height the stack can reach above the node's lowest column once the rest of the sequence is dropped
+    // Bits 8-31: depth of the node, i.e. the number of pieces dropped to reach it. Bits 32-63: generation the entry was stored in
+    volatile uint64_t Data;
+} transposition_entry;
+
+typedef struct // Stores lower bounds on the final stack height below search tree nodes, keyed by the node's normalised skyline and depth. Shared by all solvers, so a subtree searched by one solver prunes the same subtree reached through a different prefix by any solver
+{
+    transposition_entry *Entries; // NULL if the table is disabled
+    uint64_t BucketMask; // Number of buckets - 1. The number of buckets is a power of 2
+    // Entries stored while solving an earlier sequence belong to an older generation and are ignored, so the table is not cleared between sequences. The windows of a stream of pieces share a generation, as the bounds stored for one window still hold for the next
+    uint64_t Generation;
+} transposition_table;
+
+// Allocate the entries of 'transpositionTable' in at most 'megabytes' megabytes. A size of 0 disables the table. Return TRUE if the table was allocated or disabled, FALSE if it could not be allocated
+int createTranspositionTable(transposition_table *transpositionTable, int megabytes);
+
+// Free the entries of 'transpositionTable'
+void destroyTranspositionTable(transposition_table *transpositionTable);
+
+// Invalidate every entry of 'transpositionTable' before solving a new sequence
+void clearTranspositionTable(transposition_table *transpositionTable);
+
+// Return the bound stored in 'transpositionTable' for the node at depth 'depth' with the normalised skyline 'normalisedSkyline', or NO_TRANSPOSITION_BOUND if none is stored
+int probeTranspositionTable(transposition_table *transpositionTable, int depth, skyline normalisedSkyline);
+
+// Store 'bound' in 'transpositionTable' for the node at depth 'depth' with the normalised skyline 'normalisedSkyline'
+void storeTranspositionBound(transposition_table *transpositionTable, int depth, skyline normalisedSkyline, int bound);
+
+#endif